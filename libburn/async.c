@@ -132,8 +132,14 @@ static struct w_list *find_worker(struct burn_drive *d)
 	return NULL;
 }
 
-static void add_worker(int w_type, struct burn_drive *d,
-			WorkerFunc f, void *data)
+/* @param flag bit0= create the thread joinable and store its id in
+                     *joinable. The caller has to pthread_join() it and
+                     has to prevent that the thread ends and removes its
+                     worker item before this function returns.
+   @return 1= thread created, -1= failure
+*/
+static int add_worker_x(int w_type, struct burn_drive *d,
+			WorkerFunc f, void *data, pthread_t *joinable, int flag)
 {
 	struct w_list *a;
 	struct w_list *tmp;
@@ -144,6 +150,8 @@ static void add_worker(int w_type, struct burn_drive *d,
 #endif
 
 	a = calloc(1, sizeof(struct w_list));
+	if (a == NULL)
+		return -1;
 	a->w_type = w_type;
 	a->drive = d;
 	a->u = *(union w_list_data *)data;
@@ -162,7 +170,8 @@ static void add_worker(int w_type, struct burn_drive *d,
 	   which do neither react on pthread_join() nor on pthread_detach().
 	*/
 	pthread_attr_init(&attr);
-	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	pthread_attr_setdetachstate(&attr, (flag & 1) ?
+			PTHREAD_CREATE_JOINABLE : PTHREAD_CREATE_DETACHED);
 	attr_pt= &attr;
 /*
 	libdax_msgs_submit(libdax_messenger, -1, 0x00020158,
@@ -174,8 +183,18 @@ static void add_worker(int w_type, struct burn_drive *d,
 	if (pthread_create(&a->thread, attr_pt, f, a)) {
 		free(a);
 		workers = tmp;
-		return;
+		return -1;
 	}
+	if (flag & 1)
+		*joinable = a->thread;
+	return 1;
+}
+
+
+static void add_worker(int w_type, struct burn_drive *d,
+			WorkerFunc f, void *data)
+{
+	add_worker_x(w_type, d, f, data, NULL, 0);
 }
 
 
@@ -732,6 +751,7 @@ static void *fifo_worker_func(struct w_list *w)
 
 int burn_fifo_start(struct burn_source *source, int flag)
 {
+	int ret;
 	struct fifo_opts o;
 	struct burn_source_fifo *fs = source->data;
 
@@ -747,8 +767,20 @@ int burn_fifo_start(struct burn_source *source, int flag)
 
 	o.source = source;
 	o.flag = flag;
-	add_worker(Burnworker_type_fifO, NULL,
-			(WorkerFunc) fifo_worker_func, &o);
+
+	/* The shoveller cannot end without obtaining fs->mutex */
+	pthread_mutex_lock(&fs->mutex);
+	ret = add_worker_x(Burnworker_type_fifO, NULL,
+			(WorkerFunc) fifo_worker_func, &o, &fs->thread_id, 1);
+	if (ret > 0)
+		fs->thread_is_joinable = 1;
+	pthread_mutex_unlock(&fs->mutex);
+	if (ret <= 0) {
+		burn_os_free_buffer(fs->buf,
+			((size_t) fs->chunksize) * (size_t) fs->chunks, 0);
+		fs->buf = NULL;
+		return -1;
+	}
 	fs->is_started = 1;
 
 	return 1;
@@ -769,7 +801,10 @@ int burn_fifo_abort(struct burn_source_fifo *fs, int flag)
 			"Aborting running burn_source_fifo thread", 0, 0);
 #endif /* NIX */
 
-	pt= *((pthread_t *) fs->thread_handle);
+	if (fs->thread_is_joinable)
+		pt = fs->thread_id;
+	else
+		pt= *((pthread_t *) fs->thread_handle);
 	remove_worker(pt);
 	ret = pthread_cancel(pt);
 	return (ret == 0);
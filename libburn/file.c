@@ -20,6 +20,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <time.h>
+#include <sys/time.h>
 #include <pthread.h>
 
 #include "source.h"
@@ -210,21 +211,96 @@ struct burn_source *burn_fd_source_new(int datafd, int subfd, off_t size)
    and a synchronous shoveller which is here.
 */
 
-static int fifo_sleep(int flag)
+/* The longest time to wait for a notification by the other thread.
+   Normally each change gets signaled. This is just a safety net.
+*/
+#define Libburn_fifo_wait_usecS 50000
+
+
+static int fifo_get(struct burn_source_fifo *fs, volatile int *value)
 {
-	static unsigned long sleeptime = 50000; /* 50 ms */
+	int ret;
 
-	usleep(sleeptime);
-	return 0;
+	pthread_mutex_lock(&fs->mutex);
+	ret = *value;
+	pthread_mutex_unlock(&fs->mutex);
+	return ret;
 }
 
 
-static int fifo_read(struct burn_source *source,
-		     unsigned char *buffer,
-		     int size)
+/* Change a position or state and wake up the other thread */
+static void fifo_set(struct burn_source_fifo *fs, volatile int *value,
+			int new_value)
+{
+	pthread_mutex_lock(&fs->mutex);
+	*value = new_value;
+	pthread_cond_broadcast(&fs->cond);
+	pthread_mutex_unlock(&fs->mutex);
+}
+
+
+static int fifo_free_bytes(struct burn_source_fifo *fs)
+{
+	int bufsize, diff;
+
+	bufsize = fs->chunksize * fs->chunks;
+	diff = fs->buf_readpos - fs->buf_writepos;
+	if (diff == 0)
+		return bufsize - 1;
+	if (diff > 0)
+		return diff - 1;
+	return (bufsize - fs->buf_writepos) + fs->buf_readpos - 1;
+}
+
+
+static void fifo_unlock(void *mutex)
+{
+	pthread_mutex_unlock((pthread_mutex_t *) mutex);
+}
+
+
+/* Wait until the other thread changes the state of the fifo.
+   The condition for waiting gets evaluated under protection of the mutex,
+   so that no notification can get lost.
+   @param flag bit0= shoveller: wait for free space of fs->inp_read_size
+               bit1= shoveller: wait for end of reading by the consumer
+                     else consumer: wait for data or end of input
+*/
+static int fifo_wait(struct burn_source_fifo *fs, int flag)
+{
+	int must_wait;
+	struct timeval now;
+	struct timespec limit;
+
+	pthread_mutex_lock(&fs->mutex);
+	/* The shoveller thread may get cancelled while waiting */
+	pthread_cleanup_push(fifo_unlock, &fs->mutex);
+	if (flag & 1)
+		must_wait = (fifo_free_bytes(fs) < fs->inp_read_size);
+	else if (flag & 2)
+		must_wait = (fs->buf_readpos != fs->buf_writepos &&
+			     !fs->end_of_consumption);
+	else
+		must_wait = (fs->buf_readpos == fs->buf_writepos &&
+			     !fs->end_of_input && !fs->input_error);
+	if (must_wait) {
+		gettimeofday(&now, NULL);
+		now.tv_usec += Libburn_fifo_wait_usecS;
+		limit.tv_sec = now.tv_sec + now.tv_usec / 1000000;
+		limit.tv_nsec = (now.tv_usec % 1000000) * 1000;
+		pthread_cond_timedwait(&fs->cond, &fs->mutex, &limit);
+	}
+	pthread_cleanup_pop(1);
+	return must_wait;
+}
+
+
+/* @return 1= fifo is running, 0= reading has ended, -1= failure
+*/
+static int fifo_start_reading(struct burn_source *source)
 {
 	struct burn_source_fifo *fs = source->data;
-	int ret, todo, rpos, bufsize, diff, counted = 0;
+	int ret;
 
 	if (fs->end_of_consumption) {
 		/* ??? msg: reading has been ended already */;
@@ -236,33 +312,47 @@ static int fifo_read(struct burn_source *source,
 			libdax_msgs_submit(libdax_messenger, -1, 0x00020152,
 				 LIBDAX_MSGS_SEV_FATAL, LIBDAX_MSGS_PRIO_HIGH,
 				"Cannot start fifo thread", 0, 0);
-			fs->end_of_consumption = 1;
+			fifo_set(fs, &fs->end_of_consumption, 1);
 			return -1;
 		}
 		fs->is_started = 1;
 	}
+	return 1;
+}
+
+
+static int fifo_read(struct burn_source *source,
+		     unsigned char *buffer,
+		     int size)
+{
+	struct burn_source_fifo *fs = source->data;
+	int ret, todo, rpos, bufsize, diff, counted = 0;
+
+	ret = fifo_start_reading(source);
+	if (ret <= 0)
+		return ret;
 	if (size == 0)
 		return 0;
 
 	/* Reading from the ring buffer */
 
-	/* This needs no mutex because each volatile variable has one thread
-	   which may write and the other which only reads and is aware of
-	   volatility.
+	/* Only the consumer changes buf_readpos and only the shoveller
+	   changes buf_writepos. Both get changed under protection of
+	   fs->mutex and with notification of the other thread.
 	   The feeder of the ringbuffer is in burn_fifo_source_shoveller().
 	*/
 	todo = size;
 	bufsize = fs->chunksize * fs->chunks;
 	while (todo > 0) {
-		/* readpos is not volatile here , writepos is volatile */
+		/* readpos is owned by this thread, writepos is volatile */
 		rpos = fs->buf_readpos;
-		while (rpos == fs->buf_writepos) {
+		while (rpos == fifo_get(fs, &fs->buf_writepos)) {
 			if (fs->end_of_input)
 		break;
 			if (fs->input_error) {
 				if (todo < size) /* deliver partial buffer */
 		break;
-				fs->end_of_consumption = 1;
+				fifo_set(fs, &fs->end_of_consumption, 1);
 				libdax_msgs_submit(libdax_messenger, -1,
 				   0x00020154,
 				   LIBDAX_MSGS_SEV_NOTE, LIBDAX_MSGS_PRIO_HIGH,
@@ -272,9 +362,10 @@ static int fifo_read(struct burn_source *source,
 			if (!counted)
 				fs->empty_counter++;
 			counted = 1;
-			fifo_sleep(0);
+			fifo_wait(fs, 0);
 		}
-		diff = fs->buf_writepos - rpos; /* read volatile only once */
+		/* read volatile only once */
+		diff = fifo_get(fs, &fs->buf_writepos) - rpos;
 		if (diff == 0)
 	break;
 		if (diff > 0)
@@ -284,14 +375,15 @@ static int fifo_read(struct burn_source *source,
 			diff =  bufsize - rpos;
 		if (diff > todo)
 			diff = todo;
-		memcpy(buffer, fs->buf+(size-todo)+rpos, diff);
-		fs->buf_readpos += diff;
-		if (fs->buf_readpos >= bufsize)
-			fs->buf_readpos = 0;
+		memcpy(buffer + (size - todo), fs->buf + rpos, diff);
+		rpos += diff;
+		if (rpos >= bufsize)
+			rpos = 0;
+		fifo_set(fs, &fs->buf_readpos, rpos);
 		todo -= diff;
 	}
 	if (size - todo <= 0)
-		fs->end_of_consumption = 1;
+		fifo_set(fs, &fs->end_of_consumption, 1);
 	else
 		fs->out_counter += size - todo;
 
@@ -306,6 +398,72 @@ static int fifo_read(struct burn_source *source,
 }
 
 
+/* Lend the consumer the next contiguous bytes of the ring buffer.
+   They stay untouched by the shoveller until fifo_release() moves
+   fs->buf_readpos.
+*/
+static int fifo_lend(struct burn_source *source, unsigned char **buffer,
+		     int size)
+{
+	struct burn_source_fifo *fs = source->data;
+	int ret, rpos, bufsize, diff, counted = 0;
+
+	ret = fifo_start_reading(source);
+	if (ret <= 0)
+		return ret;
+	if (size <= 0)
+		return 0;
+
+	bufsize = fs->chunksize * fs->chunks;
+	rpos = fs->buf_readpos;
+	while (rpos == fifo_get(fs, &fs->buf_writepos)) {
+		if (fs->end_of_input)
+	break;
+		if (fs->input_error) {
+			fifo_set(fs, &fs->end_of_consumption, 1);
+			libdax_msgs_submit(libdax_messenger, -1, 0x00020154,
+				   LIBDAX_MSGS_SEV_NOTE, LIBDAX_MSGS_PRIO_HIGH,
+				   "Forwarded input error ends output", 0, 0);
+			return -1;
+		}
+		if (!counted)
+			fs->empty_counter++;
+		counted = 1;
+		fifo_wait(fs, 0);
+	}
+	/* read volatile only once */
+	diff = fifo_get(fs, &fs->buf_writepos) - rpos;
+	if (diff == 0) {
+		fifo_set(fs, &fs->end_of_consumption, 1);
+		return 0;
+	}
+	if (diff < 0)
+		diff =  bufsize - rpos;
+	if (diff > size)
+		diff = size;
+	*buffer = (unsigned char *) fs->buf + rpos;
+	return diff;
+}
+
+
+static int fifo_release(struct burn_source *source, int size)
+{
+	struct burn_source_fifo *fs = source->data;
+	int bufsize, rpos;
+
+	if (size <= 0)
+		return 1;
+	bufsize = fs->chunksize * fs->chunks;
+	rpos = fs->buf_readpos + size;
+	if (rpos >= bufsize)
+		rpos = 0;
+	fifo_set(fs, &fs->buf_readpos, rpos);
+	fs->out_counter += size;
+	fs->get_counter++;
+	return 1;
+}
+
+
 static off_t fifo_get_size(struct burn_source *source)
 {
 	struct burn_source_fifo *fs = source->data;
@@ -326,13 +484,24 @@ static void fifo_free(struct burn_source *source)
 {
 	struct burn_source_fifo *fs = source->data;
 
-	burn_fifo_abort(fs, 0);
+	/* Wake up a waiting shoveller, cancel one which reads input, and
+	   wait for its end. Even a cancelled shoveller still unlocks fs->mutex
+	   in its cleanup handler.
+	*/
+	if (fs->thread_is_joinable) {
+		fifo_set(fs, &fs->end_of_consumption, 1);
+		burn_fifo_abort(fs, 0);
+		pthread_join(fs->thread_id, NULL);
+		fs->thread_is_joinable = 0;
+	}
 	if (fs->inp != NULL)
 		burn_source_free(fs->inp);
 
 	if (fs->buf != NULL)
 		burn_os_free_buffer(fs->buf,
 			((size_t) fs->chunksize) * (size_t) fs->chunks, 0);
+	pthread_mutex_destroy(&fs->mutex);
+	pthread_cond_destroy(&fs->cond);
 	free((char *) fs);
 }
 
@@ -341,7 +510,7 @@ int burn_fifo_source_shoveller(struct burn_source *source, int flag)
 {
 	struct burn_source_fifo *fs = source->data;
 	int ret, bufsize, diff, wpos, rpos, trans_end, free_bytes, fill;
-	int counted;
+	int counted, old_type;
 	char *bufpt;
 	pthread_t thread_handle_storage;
 
@@ -350,6 +519,13 @@ int burn_fifo_source_shoveller(struct burn_source *source, int flag)
 	fs->thread_pid = getpid();
 	fs->thread_is_valid = 1;
 
+	/* burn_fifo_abort() may cancel this thread. Only deferred cancelling
+	   is allowed. It ends the thread at cancellation points like read(2)
+	   or pthread_cond_wait() and not amid the locking or memory
+	   management of the input source.
+	*/
+	pthread_setcanceltype(PTHREAD_CANCEL_DEFERRED, &old_type);
+
 	bufsize = fs->chunksize * fs->chunks;
 	while (!fs->end_of_consumption) {
 
@@ -357,7 +533,7 @@ int burn_fifo_source_shoveller(struct burn_source *source, int flag)
 		wpos = fs->buf_writepos;
 		counted = 0;
 		while (1) {
-			rpos = fs->buf_readpos;
+			rpos = fifo_get(fs, &fs->buf_readpos);
 			diff = rpos - wpos;
 			trans_end = 0;
 			if (diff == 0)
@@ -374,7 +550,7 @@ int burn_fifo_source_shoveller(struct burn_source *source, int flag)
 			if (!counted)
 				fs->full_counter++;
 			counted = 1;
-			fifo_sleep(0);
+			fifo_wait(fs, 1);
 		}
 
 		fill = bufsize - free_bytes - 1;
@@ -393,7 +569,7 @@ int burn_fifo_source_shoveller(struct burn_source *source, int flag)
 				  0x00000003,
 				  LIBDAX_MSGS_SEV_FATAL, LIBDAX_MSGS_PRIO_HIGH,
 				  "Out of virtual memory", 0, 0);
-				fs->input_error = ENOMEM;
+				fifo_set(fs, &fs->input_error, ENOMEM);
 	break;
 			}
 		}
@@ -415,9 +591,7 @@ int burn_fifo_source_shoveller(struct burn_source *source, int flag)
 			libdax_msgs_submit(libdax_messenger, -1, 0x00020153,
 				 LIBDAX_MSGS_SEV_SORRY, LIBDAX_MSGS_PRIO_HIGH,
 				"Read error on fifo input", errno, 0);
-			fs->input_error = errno;
-			if(errno == 0)
-				fs->input_error = EIO;
+			fifo_set(fs, &fs->input_error, errno != 0 ? errno : EIO);
 	break;
 		}
 		fs->in_counter += ret;
@@ -436,13 +610,14 @@ int burn_fifo_source_shoveller(struct burn_source *source, int flag)
 			burn_os_free_buffer(bufpt, (size_t) fs->inp_read_size,
 						0);
 			if (ret >= bufsize - wpos)
-				fs->buf_writepos = ret - (bufsize - wpos);
+				wpos = ret - (bufsize - wpos);
 			else
-				fs->buf_writepos += ret;
-		} else if (fs->buf_writepos + ret == bufsize)
-			fs->buf_writepos = 0;
+				wpos += ret;
+		} else if (wpos + ret == bufsize)
+			wpos = 0;
 		else
-			fs->buf_writepos += ret;
+			wpos += ret;
+		fifo_set(fs, &fs->buf_writepos, wpos);
 
 /*
 		fprintf(stderr, "[%2.2d%%] ",
@@ -454,15 +629,17 @@ int burn_fifo_source_shoveller(struct burn_source *source, int flag)
 */
 	}
 	if (!fs->end_of_consumption)
-		fs->end_of_input = 1;
+		fifo_set(fs, &fs->end_of_input, 1);
 
 	/* wait for end of reading by consumer */;
-	while (fs->buf_readpos != fs->buf_writepos && !fs->end_of_consumption)
-			fifo_sleep(0);
+	while (fifo_get(fs, &fs->buf_readpos) != fs->buf_writepos &&
+	       !fifo_get(fs, &fs->end_of_consumption))
+			fifo_wait(fs, 2);
 
 	/* destroy ring buffer */;
 	if (!fs->end_of_consumption)
-		fs->end_of_consumption = 2; /* Claim stop of consumption */
+		/* Claim stop of consumption */
+		fifo_set(fs, &fs->end_of_consumption, 2);
 
 	/* This is not prone to race conditions because either the consumer
 	   indicated hangup by fs->end_of_consumption = 1 or the consumer set
@@ -477,6 +654,7 @@ int burn_fifo_source_shoveller(struct burn_source *source, int flag)
 
 	fs->thread_handle= NULL;
 	fs->thread_is_valid = 0;
+	pthread_setcanceltype(old_type, NULL);
 	return (fs->input_error == 0);
 }
 
@@ -518,6 +696,7 @@ struct burn_source *burn_fifo_source_new(struct burn_source *inp,
 	fs->thread_handle = NULL;
 	fs->thread_pid = 0;
 	fs->thread_is_valid = 0;
+	fs->thread_is_joinable = 0;
 	fs->inp = NULL; /* set later */
 	if (flag & 1)
 		fs->inp_read_size = 32 * 1024;
@@ -534,9 +713,13 @@ struct burn_source *burn_fifo_source_new(struct burn_source *inp,
 	fs->total_min_fill = fs->interval_min_fill = 0;
 	fs->put_counter = fs->get_counter = 0;
 	fs->empty_counter = fs->full_counter = 0;
+	pthread_mutex_init(&fs->mutex, NULL);
+	pthread_cond_init(&fs->cond, NULL);
 
 	src = burn_source_new();
 	if (src == NULL) {
+		pthread_mutex_destroy(&fs->mutex);
+		pthread_cond_destroy(&fs->cond);
 		free((char *) fs);
 		return NULL;
 	}
@@ -546,9 +729,11 @@ struct burn_source *burn_fifo_source_new(struct burn_source *inp,
 	src->set_size = fifo_set_size;
 	src->free_data = fifo_free;
 	src->data = fs;
-	src->version= 1;
+	src->version= 2;
 	src->read_xt = fifo_read;
 	src->cancel= burn_fifo_cancel;
+	src->lend = fifo_lend;
+	src->release = fifo_release;
 	fs->inp = inp;
 	inp->refcount++; /* make sure inp lives longer than src */
 
@@ -919,3 +1104,19 @@ struct burn_source *burn_offst_source_new(
         return src;
 }
 
+
+
+/* Whether each read call of the source delivers the full requested amount
+   unless the input has ended, so that it may be asked for many sectors at
+   once. True for the file, fd and fifo sources of libburn and for sources
+   of version 2 or higher which offer (*lend)() and (*release)().
+   Other application sources are promised to be read sector by sector.
+*/
+int burn_source_reads_full(struct burn_source *src)
+{
+	if (src->read == file_read)
+		return 1;
+	if (src->read == NULL && src->read_xt == fifo_read)
+		return 1;
+	return burn_source_can_lend(src);
+}
@@ -8,6 +8,8 @@
 #ifndef BURN__FILE_H
 #define BURN__FILE_H
 
+#include <pthread.h>
+
 struct burn_source_file
 {
 	char magic[4];
@@ -38,6 +40,12 @@ struct burn_source_fifo {
 	int thread_pid;
 	int thread_is_valid;
 
+	/* The shoveller thread is created joinable. fifo_free() joins it
+	   before it destroys the mutex and frees the fifo.
+	*/
+	pthread_t thread_id;
+	int thread_is_joinable;
+
 	/* the burn_source for which this fifo is acting as proxy */
 	struct burn_source *inp;
 	int inp_read_size;
@@ -55,6 +63,12 @@ struct burn_source_fifo {
 	volatile int input_error;
 	volatile int end_of_consumption;
 
+	/* Protect the above positions and states when they get changed and
+	   let the consumer and the shoveller wait for each other.
+	*/
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+
 	off_t in_counter;
 	off_t out_counter;
 
@@ -73,6 +87,10 @@ struct burn_source_fifo {
 */
 int burn_fifo_source_shoveller(struct burn_source *source, int flag);
 
+/** Whether the source may be read by calls which ask for many sectors.
+*/
+int burn_source_reads_full(struct burn_source *src);
+
 
 /* ts B00922 */
 struct burn_source_offst {
@@ -564,6 +564,7 @@ struct burn_source {
 	    Versions:
 	     0  has .(*read)() != NULL, not even .version is present.
              1  has .version, .(*read_xt)(), .(*cancel)()
+             2  has .(*lend)(), .(*release)()
 	*/
 	int version;
 
@@ -575,6 +576,31 @@ struct burn_source {
 	    before (*free_data)() is called.
 	*/
 	int (*cancel)(struct burn_source *source);
+
+
+	/* @since 1.3.2 */
+	/** Valid only if .version is 2 or higher.
+	    Lend the consumer a pointer to the next data of the source instead
+	    of copying them into a buffer of the consumer. This saves a memory
+	    copy pass if the consumer can use the data where they are.
+	    The number of bytes lent may be smaller than size. It will not be
+	    larger. The data stay valid until (*release)() gets called.
+	    Only one lending may be active at a time. Between (*lend)() and
+	    (*release)() no (*read_xt)() shall be called.
+	    May be NULL if the source cannot lend. Then use (*read_xt)().
+	    @return  > 0 number of bytes lent at *buffer,
+	               0 end of data, -1 failure
+	*/
+	int (*lend)(struct burn_source *source, unsigned char **buffer,
+	            int size);
+
+	/** Valid only if .version is 2 or higher and (*lend)() is not NULL.
+	    End the most recent lending. The first size bytes of the lent data
+	    count as consumed. Any remaining lent bytes will be lent or read
+	    again by the next call.
+	    @return  1 success, <= 0 failure
+	*/
+	int (*release)(struct burn_source *source, int size);
 };
 
 
@@ -3125,6 +3151,20 @@ void burn_write_opts_set_obs_pad(struct burn_write_opts *opts, int pad);
 void burn_write_opts_set_stdio_fsync(struct burn_write_opts *opts, int rythm);
 
 
+/** Sets whether stdio pseudo drives shall write data with O_DIRECT, which
+    bypasses the page cache of the operating system. This avoids to evict
+    other data from the cache when large images get written to local disks.
+    It is only used where the operating system offers it and the file system
+    accepts it. Else normal write(2) is done. Data which do not fit the
+    alignment of 4 KiB get written without O_DIRECT, too.
+    @param opts   The write opts to change
+    @param value  0= write via page cache (default), 1= try O_DIRECT
+    @since 1.3.2
+*/
+void burn_write_opts_set_stdio_o_direct(struct burn_write_opts *opts,
+					 int value);
+
+
 /** Sets whether to read in raw mode or not
     @param opts The read opts to change
     @param raw_mode If non-zero, reading will be done in raw mode, so that everything in the data tracks on the
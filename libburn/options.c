@@ -59,6 +59,7 @@ struct burn_write_opts *burn_write_opts_new(struct burn_drive *drive)
 	opts->do_stream_recording = 0;
 	opts->dvd_obs_override = 0;
 	opts->stdio_fsync_size = Libburn_stdio_fsync_limiT;
+	opts->stdio_o_direct = 0;
 	opts->text_packs = NULL;
 	opts->num_text_packs = 0;
 	opts->no_text_pack_crc_check = 0;
@@ -506,6 +507,14 @@ void burn_write_opts_set_stdio_fsync(struct burn_write_opts *opts, int rythm)
 }
 
 
+/* API */
+void burn_write_opts_set_stdio_o_direct(struct burn_write_opts *opts,
+					 int value)
+{
+	opts->stdio_o_direct = !!value;
+}
+
+
 /* ts A70901: API */
 struct burn_drive *burn_write_opts_get_drive(struct burn_write_opts *opts)
 {
@@ -71,6 +71,9 @@ struct burn_write_opts
 	   Values 0 or >= 32 counted in 2 KB blocks. */
 	int stdio_fsync_size;
 
+	/* Whether to write to stdio pseudo-drives with O_DIRECT if possible */
+	int stdio_o_direct;
+
 	/* ts B11203 : CD-TEXT */
 	unsigned char *text_packs;
 	int num_text_packs;
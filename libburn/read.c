@@ -355,6 +355,9 @@ int burn_read_data(struct burn_drive *d, off_t byte_address,
 		fprintf(log_fp, "%d\n", (int) (byte_address / 2048));
 #endif /* Libburn_read_data_logginG */
 
+	/* Serialize with concurrent readers, e.g. a read-ahead thread */
+	pthread_mutex_lock(&d->access_lock);
+
 	BURN_ALLOC_MEM(buf, struct buffer, 1);
 	*data_count = 0;
 	sose_mem = d->silent_on_scsi_error;
@@ -536,6 +539,7 @@ ex:;
 	BURN_FREE_MEM(buf);
 	d->buffer = buffer_mem;
 	d->busy = BURN_DRIVE_IDLE;
+	pthread_mutex_unlock(&d->access_lock);
 	return ret;
 }
 
@@ -751,6 +751,32 @@ int sector_data(struct burn_write_opts *o, struct burn_track *t, int psub)
 	return 1;
 }
 
+/* Whether the next sectors of the track would be copied unaltered from the
+   track source by sector_data(). In this case a writer may transfer them
+   in larger amounts without using sector_data().
+*/
+int sector_data_is_plain(struct burn_write_opts *o, struct burn_track *t)
+{
+	int outmode;
+
+	outmode = get_outmode(o);
+	if (outmode == 0)
+		outmode = t->mode;
+	if ((outmode & BURN_MODE_BITS) != (t->mode & BURN_MODE_BITS))
+		return 0;
+	if (burn_sector_length(outmode) != 2048 ||
+	    burn_sector_length(t->mode) != 2048 ||
+	    burn_subcode_length(outmode) != 0)
+		return 0;
+	if (sector_headers_is_ok(o, t->mode) == 2)
+		return 0;
+	if (t->cdxa_conversion == 1 || t->swap_source_bytes == 1)
+		return 0;
+	if (t->offsetcount < t->offset || t->eos)
+		return 0;
+	return 1;
+}
+
 int burn_msf_to_lba(int m, int s, int f)
 {
 	if (m < 90)
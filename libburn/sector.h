@@ -31,6 +31,8 @@ int sector_write_buffer(struct burn_drive *d,
 /* ts A61009 */
 int sector_headers_is_ok(struct burn_write_opts *o, int mode);
 
+int sector_data_is_plain(struct burn_write_opts *o, struct burn_track *t);
+
 int sector_headers(struct burn_write_opts *, unsigned char *,
 		    int mode, int leadin);
 void subcode_user(struct burn_write_opts *, unsigned char *s,
@@ -112,11 +112,12 @@ Hint: You should also look into sg-freebsd-port.c, which is a younger and
 /** PORTING : ------- OS dependent headers and definitions ------ */
 
 
-#ifdef Libburn_read_o_direcT
-# ifndef _GNU_SOURCE
-#  define _GNU_SOURCE
-# endif
-#endif /* Libburn_read_o_direcT */
+/* O_DIRECT is needed by Libburn_read_o_direcT and by
+   burn_os_stdio_o_direct()
+*/
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
 
 #include <errno.h>
 #include <unistd.h>
@@ -2317,3 +2318,25 @@ int burn_os_free_buffer(void *buffer, size_t amount, int flag)
 	return (ret == 0);
 }
 
+
+/* An interface to switch O_DIRECT or similar OS tricks on stdio output. */
+int burn_os_stdio_o_direct(int fd, int enable, int flag)
+{
+#ifdef O_DIRECT
+	int flags;
+
+	flags = fcntl(fd, F_GETFL);
+	if (flags == -1)
+		return 0;
+	if (enable)
+		flags |= O_DIRECT;
+	else
+		flags &= ~O_DIRECT;
+	if (fcntl(fd, F_SETFL, flags) == -1)
+		return 0;
+	return 1;
+#else
+	return 0;
+#endif
+}
+
@@ -885,3 +885,11 @@ int burn_os_free_buffer(void *buffer, size_t amount, int flag)
 	return 1;
 }
 
+
+/* An interface to switch O_DIRECT or similar OS tricks on stdio output. */
+int burn_os_stdio_o_direct(int fd, int enable, int flag)
+{
+	/* No O_DIRECT-like precautions are implemented here */
+	return 0;
+}
+
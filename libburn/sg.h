@@ -38,6 +38,14 @@ int burn_os_is_2k_seekrw(char *path, int flag);
 
 int burn_os_stdio_capacity(char *path, off_t *bytes);
 
+/** Switch O_DIRECT or a similar OS trick on or off for a file descriptor
+    of a stdio pseudo-drive. The OS may demand aligned memory, file offsets,
+    and sizes with such writing.
+    @param enable  1= switch on, 0= switch off
+    @return        1 = done, 0 = not possible with this OS or file
+*/
+int burn_os_stdio_o_direct(int fd, int enable, int flag);
+
 /* ts A91227 */
 /** Returns the id string of the SCSI transport adapter and eventually
     needed operating system facilities.
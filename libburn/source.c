@@ -74,3 +74,12 @@ int burn_source_read(struct burn_source *src, unsigned char *buffer, int size)
 		 ret = src->read_xt(src, buffer, size);
 	return ret;
 }
+
+
+/* Whether the source offers (*lend)() and (*release)() */
+int burn_source_can_lend(struct burn_source *src)
+{
+	if (src->read != NULL || src->version < 2)
+		return 0;
+	return (src->lend != NULL && src->release != NULL);
+}
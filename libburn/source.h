@@ -9,4 +9,6 @@ int burn_source_cancel(struct burn_source *src);
 
 int burn_source_read(struct burn_source *src, unsigned char *buffer, int size);
 
+int burn_source_can_lend(struct burn_source *src);
+
 #endif /*__SOURCE*/
@@ -52,6 +52,7 @@
 #include "options.h"
 #include "structure.h"
 #include "source.h"
+#include "file.h"
 #include "mmc.h"
 #include "spc.h"
 
@@ -2724,6 +2725,215 @@ int burn_stdio_slowdown(struct burn_drive *d, struct timeval *prev_time,
 }
 
 
+/* The maximum number of bytes which burn_stdio_write_bulk() transfers
+   by one call. Must be a multiple of 4096.
+*/
+#define Libburn_stdio_bulk_sizE (1024 * 1024)
+
+/* The alignment of memory, file offset, and size for O_DIRECT */
+#define Libburn_stdio_direct_aligN 4096
+
+
+/* Write a range of a bulk buffer. The middle part which fulfills the
+   alignment rules gets written with O_DIRECT if *direct is not 0.
+   The memory at buf has to be aligned like the file offset pos.
+   If O_DIRECT gets refused, then *direct is set to 0.
+   @return <= 0 failure, 1 success
+*/
+static int burn_stdio_write_direct(struct burn_drive *d, char *buf,
+				   int count, off_t pos, int *direct)
+{
+	int ret, head, middle;
+
+	if (!*direct)
+		return burn_stdio_write(d->stdio_fd, buf, count, d, 0);
+
+	head = (Libburn_stdio_direct_aligN -
+		(int) (pos % Libburn_stdio_direct_aligN)) %
+		Libburn_stdio_direct_aligN;
+	if (head > count)
+		head = count;
+	middle = count - head;
+	middle -= middle % Libburn_stdio_direct_aligN;
+	if (head > 0) {
+		burn_os_stdio_o_direct(d->stdio_fd, 0, 0);
+		ret = burn_stdio_write(d->stdio_fd, buf, head, d, 0);
+		if (ret <= 0)
+			return ret;
+	}
+	if (middle > 0) {
+		if (burn_os_stdio_o_direct(d->stdio_fd, 1, 0)) {
+			ret = write(d->stdio_fd, buf + head, middle);
+			if (ret == -1 && errno == EINVAL) {
+				/* Not usable with this file */
+				burn_os_stdio_o_direct(d->stdio_fd, 0, 0);
+				*direct = 0;
+				libdax_msgs_submit(libdax_messenger,
+					d->global_index, 0x00000002,
+					LIBDAX_MSGS_SEV_DEBUG,
+					LIBDAX_MSGS_PRIO_HIGH,
+					"O_DIRECT refused by stdio pseudo-drive",
+					0, 0);
+				ret = burn_stdio_write(d->stdio_fd,
+						buf + head, middle, d, 0);
+			} else if (ret != middle) {
+				burn_os_stdio_o_direct(d->stdio_fd, 0, 0);
+				ret = burn_stdio_write(d->stdio_fd,
+						buf + head + (ret > 0 ? ret : 0),
+						middle - (ret > 0 ? ret : 0),
+						d, 0);
+			}
+		} else {
+			*direct = 0;
+			ret = burn_stdio_write(d->stdio_fd, buf + head,
+						middle, d, 0);
+		}
+		if (ret <= 0)
+			return ret;
+	}
+	if (head + middle < count) {
+		burn_os_stdio_o_direct(d->stdio_fd, 0, 0);
+		ret = burn_stdio_write(d->stdio_fd, buf + head + middle,
+					count - head - middle, d, 0);
+		if (ret <= 0)
+			return ret;
+	}
+	return 1;
+}
+
+
+/* Transfer many sectors from the track source to the stdio pseudo-drive
+   by a single write(2), without passing them through sector_data() and
+   the drive buffer. Only for tracks which fulfill sector_data_is_plain().
+   If the source can lend its memory then the data get written from there.
+   Else they get read into bulk_buf, which has to offer
+   Libburn_stdio_bulk_sizE + Libburn_stdio_direct_aligN bytes, aligned to
+   Libburn_stdio_direct_aligN.
+   @param todo    maximum number of sectors, -1 = open ended
+   @param direct  see burn_stdio_write_direct()
+   @return >0 = number of sectors written,
+            0 = no complete sector available, use sector_data()
+           -1 = write failure
+*/
+static int burn_stdio_write_bulk(struct burn_write_opts *o,
+				 struct burn_track *t, int todo,
+				 char *bulk_buf, int *direct,
+				 int *prev_sync_sector,
+				 struct timeval *prev_time)
+{
+	struct burn_drive *d = o->drive;
+	struct burn_source *src = t->source;
+	unsigned char *data;
+	int ret, size, sectors, bytes, old_sector, lent, rest, tail;
+	off_t pos, remaining;
+
+	size = Libburn_stdio_bulk_sizE;
+	if (todo >= 0 && todo < size / 2048)
+		size = todo * 2048;
+	if (size < 2048)
+		return 0;
+	pos = ((off_t) d->nwa) * (off_t) 2048;
+	lent = (bulk_buf == NULL);
+	if (!lent) {
+		/* Some sources lose data if asked for more than they have */
+		remaining = src->get_size(src) - t->sourcecount;
+		if (remaining > 0 && remaining < size)
+			size = remaining;
+		else if (remaining <= 0 && src->get_size(src) > 0)
+			return 0;
+	}
+	if (lent) {
+		ret = src->lend(src, &data, size);
+	} else {
+		/* Let memory have the same alignment as the file offset */
+		data = (unsigned char *) bulk_buf +
+			(int) (pos % Libburn_stdio_direct_aligN);
+		ret = burn_source_read(src, data, size);
+	}
+	if (ret <= 0) {
+		/* End of input. sector_data() will do the rest. */
+		t->eos = 1;
+		return 0;
+	}
+	if (ret > size)
+		ret = size; /* beware of ill custom burn_source */
+	if (lent) {
+		sectors = ret / 2048;
+		if (sectors <= 0) {
+			/* Incomplete sector at the end of the lendable memory */
+			src->release(src, 0);
+			return 0;
+		}
+	} else {
+		t->sourcecount += ret;
+		if (ret < size) {
+			/* A short read announces the end of input.
+			   burn_source_reads_full() sources guarantee this. */
+			t->eos = 1;
+		}
+		if (ret % 2048) {
+			/* Pad up like get_bytes() does */
+			rest = 2048 - ret % 2048;
+			memset(data + ret, 0, rest);
+			tail = t->tail - t->tailcount;
+			if (tail > rest)
+				tail = rest;
+			t->tailcount += tail;
+			ret += rest;
+		}
+		sectors = ret / 2048;
+	}
+	bytes = sectors * 2048;
+
+	/* Sectors of sector_data() have to go first */
+	ret = burn_write_flush_buffer(o, t);
+	if (ret <= 0 || d->cancel) {
+		if (lent)
+			src->release(src, 0);
+		return -1;
+	}
+	if (!o->simulate) {
+		if (lent)
+			ret = burn_stdio_write(d->stdio_fd, (char *) data,
+						bytes, d, 0);
+		else
+			ret = burn_stdio_write_direct(d, (char *) data, bytes,
+							pos, direct);
+		if (ret <= 0) {
+			if (lent)
+				src->release(src, 0);
+			return -1;
+		}
+	}
+	if (lent) {
+		src->release(src, bytes);
+		t->sourcecount += bytes;
+	}
+
+	t->writecount += bytes;
+	t->written_sectors += sectors;
+	d->progress.buffered_bytes += bytes;
+	d->nwa += sectors;
+	d->alba += sectors;
+	d->rlba += sectors;
+	old_sector = d->progress.sector;
+	d->progress.sector += sectors;
+
+	/* Flush to disk from time to time */
+	if (d->progress.sector - *prev_sync_sector >=
+	    o->stdio_fsync_size && o->stdio_fsync_size > 0) {
+		*prev_sync_sector = d->progress.sector;
+		if (!o->simulate)
+			burn_stdio_sync_cache(d->stdio_fd, d, 1);
+	}
+	if (d->progress.sector / 512 > old_sector / 512)
+		burn_stdio_slowdown(d, prev_time,
+			(d->progress.sector / 512 - old_sector / 512) * 512 * 2,
+			0);
+	return sectors;
+}
+
+
 /* ts A70904 */
 int burn_stdio_write_track(struct burn_write_opts *o, struct burn_session *s,
 				int tnum, int flag)
@@ -2731,8 +2941,8 @@ int burn_stdio_write_track(struct burn_write_opts *o, struct burn_session *s,
 	int open_ended, bufsize = 16 * 2048, ret, sectors;
 	struct burn_track *t = s->track[tnum];
 	struct burn_drive *d = o->drive;
-	char *buf = NULL;
-	int i, prev_sync_sector = 0;
+	char *buf = NULL, *bulk_buf = NULL;
+	int i, prev_sync_sector = 0, bulk, direct = 0;
 	struct buffer *out = d->buffer;
 	struct timeval prev_time;
 
@@ -2751,8 +2961,41 @@ int burn_stdio_write_track(struct burn_write_opts *o, struct burn_session *s,
 		d->write = burn_stdio_mmc_write;
 	d->sync_cache = burn_stdio_mmc_sync_cache;
 
+	/* With padding to o->obs the sectors have to pass the drive buffer.
+	   A chain of sources needs get_bytes(). Application sources which
+	   expect to be read sector by sector have to go through sector_data().
+	*/
+	bulk = (!o->obs_pad && t->source->next == NULL &&
+		burn_source_reads_full(t->source));
+	direct = (o->stdio_o_direct && !o->simulate);
+	if (bulk && (direct || !burn_source_can_lend(t->source))) {
+		/* O_DIRECT needs aligned memory, so it cannot use lent data */
+		bulk_buf = burn_os_alloc_buffer((size_t)
+			(Libburn_stdio_bulk_sizE + Libburn_stdio_direct_aligN),
+			0);
+		if (bulk_buf == NULL)
+			bulk = 0;
+		else if (((size_t) bulk_buf) % Libburn_stdio_direct_aligN)
+			direct = 0;
+	}
+
 	burn_stdio_slowdown(d, &prev_time, 0, 1); /* initialize */
 	for (i = 0; open_ended || i < sectors; i++) {
+		if (bulk && sector_data_is_plain(o, t)) {
+			ret = burn_stdio_write_bulk(o, t,
+					open_ended ? -1 : sectors - i,
+					bulk_buf, &direct,
+					&prev_sync_sector, &prev_time);
+			if (ret < 0)
+				{ret= 0; goto ex;}
+			if (ret > 0) {
+				if (open_ended)
+					d->progress.sectors = sectors =
+							d->progress.sector;
+				i += ret - 1;
+	continue;
+			}
+		}
 		/* transact a (CD sized) sector */
 		if (!sector_data(o, t, 0))
 			{ret= 0; goto ex;}
@@ -2783,10 +3026,16 @@ int burn_stdio_write_track(struct burn_write_opts *o, struct burn_session *s,
 	ret = burn_write_flush(o, t);
 	ret= 1;
 ex:;
+	if (direct)
+		burn_os_stdio_o_direct(d->stdio_fd, 0, 0);
 	if (d->cancel)
 		burn_source_cancel(t->source);
 	if (t->end_on_premature_eoi == 2)
 		d->cancel = 1;
+	if (bulk_buf != NULL)
+		burn_os_free_buffer(bulk_buf, (size_t)
+			(Libburn_stdio_bulk_sizE + Libburn_stdio_direct_aligN),
+			0);
 	BURN_FREE_MEM(buf);
 	return ret;
 }
@@ -14,6 +14,7 @@
 #include <string.h>
 
 #include <stdio.h>
+#include <pthread.h>
 
 
 #ifndef Xorriso_standalonE
@@ -48,6 +49,9 @@ struct isoburn_cache_tile {
  uint32_t last_aligned_error_lba;
  int cache_hits;
  int age;
+
+ int hash_next;   /* Index of next tile in the same hash chain, -1 = none */
+ int loading;     /* 1= cache_data is being read from the drive */
 };
 
 struct isoburn_cached_drive {
@@ -70,21 +74,262 @@ struct isoburn_cached_drive {
  uint32_t displacement;
  int      displacement_sign;
 
+ /* Tiles by cache_lba / tile_blocks. hash_size is a power of 2. */
+ int *hash;
+ int hash_size;
+
+ /* Protects tiles, hash and read-ahead state against the read-ahead thread
+    and against concurrent readers.
+ */
+ pthread_mutex_t lock;
+ pthread_cond_t cond;
+ int lock_initialized;
+
+ /* Read-ahead:
+    If tiles get accessed in ascending sequence, then a thread loads the
+    next tiles while the reader still works on the current one. The
+    number of tiles to load ahead doubles with each tile of the sequence
+    up to max_ahead. Any jump in the sequence ends read-ahead.
+    Read-ahead happens only while ahead_window is 1. Closing the window
+    ends the thread, so that the drive may then be used otherwise.
+ */
+ int max_ahead;
+ int ahead_window;
+ uint32_t last_aligned_lba;
+ int seq_count;
+ uint32_t ahead_lba;   /* Next tile address to be loaded ahead */
+ int ahead_todo;       /* Number of tiles yet to be loaded ahead */
+ int thread_state;     /* 0= no thread, 1= running, 2= shall end, 3= ended */
+ pthread_t thread;
 };
 
 #define Libisoburn_max_agE 2000000000
 
+/* Minimum number of tiles which enable read-ahead */
+#define Libisoburn_min_ahead_tileS 4
+
 static int ds_inc_age(struct isoburn_cached_drive *icd, int idx, int flag);
 
 
+static int ds_hash_slot(struct isoburn_cached_drive *icd, uint32_t aligned_lba)
+{
+ return((aligned_lba / icd->tile_blocks) & (icd->hash_size - 1));
+}
+
+
+/* @return index of tile with the given aligned_lba or -1
+*/
+static int ds_hash_find(struct isoburn_cached_drive *icd, uint32_t aligned_lba)
+{
+ int idx;
+
+ for(idx= icd->hash[ds_hash_slot(icd, aligned_lba)]; idx >= 0;
+     idx= icd->tiles[idx]->hash_next)
+   if(icd->tiles[idx]->cache_lba == aligned_lba)
+     return(idx);
+ return(-1);
+}
+
+
+static void ds_hash_insert(struct isoburn_cached_drive *icd, int idx,
+                           uint32_t aligned_lba)
+{
+ int slot;
+
+ slot= ds_hash_slot(icd, aligned_lba);
+ icd->tiles[idx]->cache_lba= aligned_lba;
+ icd->tiles[idx]->hash_next= icd->hash[slot];
+ icd->hash[slot]= idx;
+}
+
+
+/* Remove the tile from its hash chain and invalidate it
+*/
+static void ds_hash_remove(struct isoburn_cached_drive *icd, int idx)
+{
+ int *pt;
+
+ if(icd->tiles[idx]->cache_lba == 0xffffffff)
+   return;
+ for(pt= &(icd->hash[ds_hash_slot(icd, icd->tiles[idx]->cache_lba)]);
+     *pt >= 0; pt= &(icd->tiles[*pt]->hash_next))
+   if(*pt == idx) {
+     *pt= icd->tiles[idx]->hash_next;
+ break;
+   }
+ icd->tiles[idx]->hash_next= -1;
+ icd->tiles[idx]->cache_lba= 0xffffffff;
+}
+
+
+/* Find an unused tile or the oldest one which is not being loaded.
+   @return index of tile or -1 if all tiles are being loaded
+*/
+static int ds_pick_tile(struct isoburn_cached_drive *icd)
+{
+ int i, oldest= -1, oldest_age= Libisoburn_max_agE;
+
+ for(i = 0; i < icd->num_tiles; i++) {
+   if(icd->tiles[i]->loading)
+ continue;
+   if(icd->tiles[i]->cache_lba == 0xffffffff)
+     return(i);
+   if(oldest < 0 || icd->tiles[i]->age < oldest_age) {
+     oldest_age= icd->tiles[i]->age;
+     oldest= i;
+   }
+ }
+ return(oldest);
+}
+
+
+static void *ds_ahead_thread(void *arg)
+{
+ struct isoburn_cached_drive *icd;
+ struct isoburn_cache_tile *tile;
+ struct burn_drive *d;
+ uint32_t lba;
+ int idx, ret;
+ off_t count;
+
+ icd= (struct isoburn_cached_drive *) arg;
+ pthread_mutex_lock(&icd->lock);
+ while(1) {
+   while(icd->thread_state == 1 &&
+         (icd->ahead_todo <= 0 || icd->drive == NULL))
+     pthread_cond_wait(&icd->cond, &icd->lock);
+   if(icd->thread_state != 1)
+ break;
+   lba= icd->ahead_lba;
+   icd->ahead_lba+= icd->tile_blocks;
+   icd->ahead_todo--;
+   if(ds_hash_find(icd, lba) >= 0)
+ continue;
+   idx= ds_pick_tile(icd);
+   if(idx < 0) {
+     icd->ahead_todo= 0;
+ continue;
+   }
+   tile= icd->tiles[idx];
+   ds_hash_remove(icd, idx);
+   ds_hash_insert(icd, idx, lba);
+   tile->loading= 1;
+   d= icd->drive;
+   pthread_mutex_unlock(&icd->lock);
+
+   ret= burn_read_data(d, (off_t) lba * (off_t) 2048, tile->cache_data,
+                       icd->tile_blocks * 2048, &count, 2);
+
+   pthread_mutex_lock(&icd->lock);
+   tile->loading= 0;
+
+#ifdef Libisoburn_read_cache_reporT
+   fprintf(stderr, "Tile %2.2d : Read-ahead load from %8x , count= %d\n",
+           idx, lba, ret > 0 ? (int) count : -1);
+#endif
+
+   if(ret <= 0) {
+     /* Leave the error handling to the reader */
+     ds_hash_remove(icd, idx);
+     icd->ahead_todo= 0;
+   } else {
+     tile->cache_hits= 0;
+     ds_inc_age(icd, idx, 0);
+   }
+   pthread_cond_broadcast(&icd->cond);
+ }
+ icd->thread_state= 3;
+ pthread_cond_broadcast(&icd->cond);
+ pthread_mutex_unlock(&icd->lock);
+ return(NULL);
+}
+
+
+/* Register the access to a tile and eventually order read-ahead.
+   To be called with icd->lock held.
+*/
+static void ds_note_access(struct isoburn_cached_drive *icd,
+                           uint32_t aligned_lba)
+{
+ int depth, ret;
+ uint32_t end_lba;
+
+ if(icd->max_ahead <= 0 || !icd->ahead_window ||
+    aligned_lba == icd->last_aligned_lba)
+   return;
+ if(icd->last_aligned_lba != 0xffffffff &&
+    aligned_lba == icd->last_aligned_lba + icd->tile_blocks) {
+   icd->seq_count++;
+ } else {
+   icd->seq_count= 0;
+   icd->ahead_todo= 0;
+ }
+ icd->last_aligned_lba= aligned_lba;
+ if(icd->seq_count < 2)
+   return;
+
+ if(icd->seq_count - 2 >= 30)
+   depth= icd->max_ahead;
+ else
+   depth= 1 << (icd->seq_count - 2);
+ if(depth > icd->max_ahead)
+   depth= icd->max_ahead;
+ if(aligned_lba > 0xffffffff - (uint32_t) (depth + 1) * icd->tile_blocks)
+   return;
+ end_lba= aligned_lba + (uint32_t) (depth + 1) * icd->tile_blocks;
+ if(icd->ahead_lba <= aligned_lba || icd->ahead_lba > end_lba)
+   icd->ahead_lba= aligned_lba + icd->tile_blocks;
+ icd->ahead_todo= (end_lba - icd->ahead_lba) / icd->tile_blocks;
+ if(icd->ahead_todo <= 0)
+   return;
+
+ if(icd->thread_state == 0) {
+   ret= pthread_create(&icd->thread, NULL, ds_ahead_thread, icd);
+   if(ret != 0) {
+     icd->max_ahead= 0;
+     icd->ahead_todo= 0;
+     return;
+   }
+   icd->thread_state= 1;
+ }
+ pthread_cond_broadcast(&icd->cond);
+}
+
+
+/* End read-ahead and wait until no tile is being loaded any more.
+   To be called with icd->lock held.
+*/
+static void ds_stop_ahead(struct isoburn_cached_drive *icd)
+{
+ int was_running;
+
+ icd->ahead_todo= 0;
+ icd->seq_count= 0;
+ icd->last_aligned_lba= 0xffffffff;
+ was_running= (icd->thread_state == 1);
+ if(was_running) {
+   icd->thread_state= 2;
+   pthread_cond_broadcast(&icd->cond);
+   while(icd->thread_state != 3)
+     pthread_cond_wait(&icd->cond, &icd->lock);
+ }
+ if(icd->thread_state == 3) {
+   pthread_mutex_unlock(&icd->lock);
+   pthread_join(icd->thread, NULL);
+   pthread_mutex_lock(&icd->lock);
+   icd->thread_state= 0;
+ }
+}
+
+
 int ds_read_block(IsoDataSource *src, uint32_t lba, uint8_t *buffer)
 {
- int ret, i, oldest, oldest_age;
+ int ret, idx;
  struct burn_drive *d;
  off_t count;
  uint32_t aligned_lba;
  char msg[80];
- struct isoburn_cache_tile **tiles;
+ struct isoburn_cache_tile **tiles, *tile;
  struct isoburn_cached_drive *icd;
 
  if(src == NULL || buffer == NULL)
@@ -126,51 +371,66 @@ address_rollover:;
 
  aligned_lba= lba & ~(icd->tile_blocks - 1);
 
- for (i = 0; i < icd->num_tiles; i++) {
-   if(aligned_lba == tiles[i]->cache_lba &&
-      tiles[i]->cache_lba != 0xffffffff) {
-     (tiles[i]->cache_hits)++;
-     memcpy(buffer, tiles[i]->cache_data + (lba - aligned_lba) * 2048, 2048);
-     count= 2048;
-     ds_inc_age(icd, i, 0);
+ pthread_mutex_lock(&icd->lock);
+ while(1) {
+   idx= ds_hash_find(icd, aligned_lba);
+   if(idx < 0)
+ break;
+   if(!tiles[idx]->loading) {
+     (tiles[idx]->cache_hits)++;
+     memcpy(buffer, tiles[idx]->cache_data + (lba - aligned_lba) * 2048, 2048);
+     ds_inc_age(icd, idx, 0);
+     ds_note_access(icd, aligned_lba);
+     pthread_mutex_unlock(&icd->lock);
      return 1;
    }
+   /* Wait for the read-ahead thread to deliver the tile */
+   pthread_cond_wait(&icd->cond, &icd->lock);
  }
 
- /* find oldest tile */
- oldest_age= Libisoburn_max_agE;
- oldest= 0;
- for(i = 0; i < icd->num_tiles; i++) {
-   if(tiles[i]->cache_lba == 0xffffffff) {
-     oldest= i;
+ /* find unused or oldest tile */
+ while(1) {
+   idx= ds_pick_tile(icd);
+   if(idx >= 0)
  break;
-   }
-   if(tiles[i]->age < oldest_age) {
-     oldest_age= tiles[i]->age;
-     oldest= i;
-   }
+   pthread_cond_wait(&icd->cond, &icd->lock);
  }
-
- tiles[oldest]->cache_lba= 0xffffffff; /* invalidate cache */
- if(tiles[oldest]->last_aligned_error_lba == aligned_lba) {
+ tile= tiles[idx];
+ ds_hash_remove(icd, idx); /* invalidate cache */
+ if(tile->last_aligned_error_lba == aligned_lba) {
    ret = 0;
  } else {
+   ds_hash_insert(icd, idx, aligned_lba);
+   tile->loading= 1;
+   pthread_mutex_unlock(&icd->lock);
    ret = burn_read_data(d, (off_t) aligned_lba * (off_t) 2048,
-                        (char *) tiles[oldest]->cache_data,
+                        (char *) tile->cache_data,
                         icd->tile_blocks * 2048, &count, 2);
+   pthread_mutex_lock(&icd->lock);
+   tile->loading= 0;
+   pthread_cond_broadcast(&icd->cond);
+   if(ret <= 0)
+     ds_hash_remove(icd, idx);
  }
  if (ret <= 0 ) {
-   tiles[oldest]->last_aligned_error_lba = aligned_lba;
+   tile->last_aligned_error_lba = aligned_lba;
+   icd->ahead_todo= 0;
 
    /* Read-ahead failure ? Try to read 2048 directly. */
-   if(tiles[oldest]->last_error_lba == lba)
+   if(tile->last_error_lba == lba)
      ret = 0;
-   else
+   else {
+     pthread_mutex_unlock(&icd->lock);
      ret = burn_read_data(d, (off_t) lba * (off_t) 2048, (char *) buffer,
                         2048, &count, 0);
-   if (ret > 0)
+     pthread_mutex_lock(&icd->lock);
+   }
+   if (ret > 0) {
+     pthread_mutex_unlock(&icd->lock);
      return 1;
-   tiles[oldest]->last_error_lba = lba;
+   }
+   tile->last_error_lba = lba;
+   pthread_mutex_unlock(&icd->lock);
    sprintf(msg, "ds_read_block(%lu) returns %lX",
            (unsigned long) lba, (unsigned long) ret);
    isoburn_msgs_submit(NULL, 0x00060000, msg, 0, "DEBUG", 0);
@@ -179,16 +439,58 @@ address_rollover:;
 
 #ifdef Libisoburn_read_cache_reporT
  fprintf(stderr, "Tile %2.2d : After %3d hits, new load from %8x , count= %d\n",
-         oldest, tiles[oldest]->cache_hits, aligned_lba, (int) count);
+         idx, tile->cache_hits, aligned_lba, (int) count);
 #endif
 
- tiles[oldest]->cache_lba= aligned_lba;
- tiles[oldest]->cache_hits= 1;
- ds_inc_age(icd, oldest, 0);
+ tile->cache_hits= 1;
+ ds_inc_age(icd, idx, 0);
+
+ memcpy(buffer, tile->cache_data + (lba - aligned_lba) * 2048, 2048);
+ ds_note_access(icd, aligned_lba);
+ pthread_mutex_unlock(&icd->lock);
+ return 1;
+}
+
 
- memcpy(buffer, tiles[oldest]->cache_data + (lba - aligned_lba) * 2048, 2048);
- count= 2048;
+/* Sequences of at least one tile size get read directly into the buffer
+   of the caller. Shorter ones are served by the tiles.
+   If the direct read fails, the blocks get read one by one via
+   ds_read_block() which knows how to handle read errors.
+*/
+static int ds_read_blocks(IsoDataSource *src, uint32_t lba, uint32_t count,
+                          uint8_t *buffer)
+{
+ int ret;
+ uint32_t i, start_lba;
+ off_t data_count;
+ struct isoburn_cached_drive *icd;
+
+ if(src == NULL || buffer == NULL)
+   return ISO_NULL_POINTER;
+ icd = (struct isoburn_cached_drive *) src->data;
 
+ if(icd->drive != NULL && count >= (uint32_t) icd->tile_blocks) {
+   start_lba= lba;
+   if(icd->displacement_sign == 1) {
+     if(lba + icd->displacement < lba)
+       return ISO_DISPLACE_ROLLOVER;
+     start_lba= lba + icd->displacement;
+   } else if(icd->displacement_sign == -1) {
+     if(lba < icd->displacement)
+       return ISO_DISPLACE_ROLLOVER;
+     start_lba= lba - icd->displacement;
+   }
+   ret= burn_read_data(icd->drive, (off_t) start_lba * (off_t) 2048,
+                       (char *) buffer, (off_t) count * (off_t) 2048,
+                       &data_count, 2);
+   if(ret > 0 && data_count == (off_t) count * (off_t) 2048)
+     return 1;
+ }
+ for(i= 0; i < count; i++) {
+   ret= ds_read_block(src, lba + i, buffer + (size_t) i * 2048);
+   if(ret < 0)
+     return ret;
+ }
  return 1;
 }
 
@@ -233,6 +535,8 @@ static int isoburn_cache_tile_new(struct isoburn_cache_tile **o,
  t->last_error_lba = 0xffffffff;
  t->last_aligned_error_lba = 0xffffffff;
  t->age= 0;
+ t->hash_next= -1;
+ t->loading= 0;
 
  t->cache_data = calloc(1, tile_blocks * 2048);
  if (t->cache_data == NULL)
@@ -254,6 +558,15 @@ static int isoburn_cached_drive_destroy(struct isoburn_cached_drive **o,
  if (*o == NULL)
    return(0);
  c= *o;
+ if (c->lock_initialized) {
+   pthread_mutex_lock(&c->lock);
+   ds_stop_ahead(c);
+   pthread_mutex_unlock(&c->lock);
+   pthread_mutex_destroy(&c->lock);
+   pthread_cond_destroy(&c->cond);
+ }
+ if (c->hash != NULL)
+   free(c->hash);
  if (c->tiles != NULL) {
    for (i = 0; i < c->num_tiles; i++) 
      isoburn_cache_tile_destroy(&(c->tiles[i]), 0);
@@ -282,6 +595,32 @@ static int isoburn_cached_drive_new(struct isoburn_cached_drive **o,
  icd->current_age = 0;
  icd->displacement = 0;
  icd->displacement_sign = 0;
+ icd->hash = NULL;
+ icd->lock_initialized = 0;
+ icd->max_ahead = 0;
+ if (!(flag & 1) && cache_tiles >= Libisoburn_min_ahead_tileS)
+   icd->max_ahead = cache_tiles / 2;
+ icd->ahead_window = 0;
+ icd->last_aligned_lba = 0xffffffff;
+ icd->seq_count = 0;
+ icd->ahead_lba = 0;
+ icd->ahead_todo = 0;
+ icd->thread_state = 0;
+
+ for (icd->hash_size = 1; icd->hash_size < 2 * cache_tiles;
+      icd->hash_size *= 2);
+ icd->hash = calloc(icd->hash_size, sizeof(int));
+ if (icd->hash == NULL)
+   goto fail;
+ for (i = 0; i < icd->hash_size; i++)
+   icd->hash[i] = -1;
+ if (pthread_mutex_init(&icd->lock, NULL) != 0)
+   goto fail;
+ if (pthread_cond_init(&icd->cond, NULL) != 0) {
+   pthread_mutex_destroy(&icd->lock);
+   goto fail;
+ }
+ icd->lock_initialized = 1;
 
  icd->tiles = calloc(1, sizeof(struct isoburn_cache_tile *) * icd->num_tiles);
  if (icd->tiles == NULL)
@@ -317,14 +656,38 @@ int isoburn_data_source_shutdown(IsoDataSource *src, int flag)
  if(src==NULL)
    return(0);
  icd= (struct isoburn_cached_drive *) src->data;
- icd->drive= NULL;
+ pthread_mutex_lock(&icd->lock);
+ icd->ahead_window= 0;
+ ds_stop_ahead(icd);
+ if(!(flag & 1))
+   icd->drive= NULL;
+ pthread_mutex_unlock(&icd->lock);
+ return(1);
+}
+
+
+int isoburn_data_source_read_ahead(IsoDataSource *src, int flag)
+{
+ struct isoburn_cached_drive *icd;
+
+ if(src==NULL)
+   return(0);
+ icd= (struct isoburn_cached_drive *) src->data;
+ pthread_mutex_lock(&icd->lock);
+ if(flag & 1) {
+   icd->ahead_window= 1;
+ } else {
+   icd->ahead_window= 0;
+   ds_stop_ahead(icd);
+ }
+ pthread_mutex_unlock(&icd->lock);
  return(1);
 }
 
 
 IsoDataSource *isoburn_data_source_new(struct burn_drive *d,
                                   uint32_t displacement, int displacement_sign,
-                                  int cache_tiles, int tile_blocks)
+                                  int cache_tiles, int tile_blocks, int flag)
 {
  IsoDataSource *src;
  struct isoburn_cached_drive *icd= NULL;
@@ -335,14 +698,16 @@ IsoDataSource *isoburn_data_source_new(struct burn_drive *d,
  src = malloc(sizeof(IsoDataSource));
  if (src == NULL)
    return NULL;
- ret = isoburn_cached_drive_new(&icd, d, cache_tiles, tile_blocks, 0);
+ ret = isoburn_cached_drive_new(&icd, d, cache_tiles, tile_blocks,
+                                flag & 1);
  if (ret <= 0) {
    free(src);
    return NULL;
  }
- src->version = 0;
+ src->version = 1;
  src->refcount = 1;
  src->read_block = ds_read_block;
+ src->read_blocks = ds_read_blocks;
  src->open = ds_open;
  src->close = ds_close;
  src->free_data = ds_free_data;
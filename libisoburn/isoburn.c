@@ -193,6 +193,11 @@ int isoburn_destroy(struct isoburn **objpt, int flag)
 
  /* >>> end mutex */
 
+ /* The drive may get released after this. So the read-ahead thread has
+    to end even if the image still holds the data source.
+ */
+ if(o->iso_data_source!=NULL)
+   isoburn_data_source_shutdown(o->iso_data_source, 1);
  if(o->image!=NULL)
    iso_image_unref(o->image);
  if(o->toc!=NULL)
@@ -512,7 +517,7 @@ int isoburn_prepare_disc_aux(struct burn_drive *in_d, struct burn_drive *out_d,
  iso_write_opts_set_dir_rec_mtime(wopts, rec_mtime);
  iso_write_opts_set_aaip_susp_1_10(wopts, opts->aaip_susp_1_10);
  iso_write_opts_set_sort_files(wopts, opts->sort_files);
- iso_write_opts_set_record_md5(wopts, opts->session_md5, opts->file_md5 & 3);
+ iso_write_opts_set_record_md5(wopts, opts->session_md5, opts->file_md5 & 7);
  if(opts->scdbackup_tag_name[0] && opts->scdbackup_tag_time[0])
    iso_write_opts_set_scdbackup_tag(wopts, opts->scdbackup_tag_name,
                                     opts->scdbackup_tag_time,
@@ -525,6 +530,19 @@ int isoburn_prepare_disc_aux(struct burn_drive *in_d, struct burn_drive *out_d,
  iso_write_opts_set_default_gid(wopts, opts->gid);
  iso_write_opts_set_output_charset(wopts, opts->output_charset);
  iso_write_opts_set_fifo_size(wopts, fifo_chunks);
+ ret= iso_write_opts_set_file_readers(wopts, opts->file_readers,
+                                      opts->file_prefetch);
+ if(ret < 0) {
+   isoburn_report_iso_error(ret, "Cannot set number of file reader threads",
+                            0, "FAILURE", 0);
+   {ret= -1; goto ex;}
+ }
+ ret= iso_write_opts_set_dedup_content(wopts, opts->dedup_content);
+ if(ret < 0) {
+   isoburn_report_iso_error(ret, "Cannot set content deduplication",
+                            0, "FAILURE", 0);
+   {ret= -1; goto ex;}
+ }
  ret = iso_write_opts_set_system_area(wopts, opts->system_area_data,
                                       opts->system_area_options, 0);
  if (ret < 0) {
@@ -803,6 +821,7 @@ int isoburn_ropt_new(struct isoburn_read_opts **new_o, int flag)
  }
  o->cache_tiles= Libisoburn_default_cache_tileS;
  o->cache_tile_blocks= Libisoburn_default_tile_blockS;
+ o->cache_flag= 0;
  o->norock= 0;
  o->nojoliet= 0;
  o->noiso1999= 1;
@@ -811,6 +830,7 @@ int isoburn_ropt_new(struct isoburn_read_opts **new_o, int flag)
  o->noea= 1;
  o->noino= 1;
  o->nomd5= 1;
+ o->lazy_dirs= 0;
  o->preferjoliet= 0;
  o->uid= geteuid();
  o->gid= getegid();
@@ -870,6 +890,7 @@ int isoburn_ropt_set_data_cache(struct isoburn_read_opts *o,
  if(o != NULL) {
    o->cache_tiles= cache_tiles;
    o->cache_tile_blocks= tile_blocks;
+   o->cache_flag= flag & 1;
  }
  return(1);
 } 
@@ -887,7 +908,7 @@ int isoburn_ropt_get_data_cache(struct isoburn_read_opts *o,
  }
  *cache_tiles= o->cache_tiles;
  *tile_blocks= o->cache_tile_blocks;
- *set_flag= 0;
+ *set_flag= o->cache_flag;
  return(1);
 }
 
@@ -904,6 +925,7 @@ int isoburn_ropt_set_extensions(struct isoburn_read_opts *o, int ext)
  o->noea= !!(ext & 128);
  o->noino= !!(ext & 256);
  o->nomd5= (ext >> 9) & 3;
+ o->lazy_dirs= !!(ext & 2048);
  return(1);
 }
 
@@ -913,7 +935,8 @@ int isoburn_ropt_get_extensions(struct isoburn_read_opts *o, int *ext)
  *ext= (!!o->norock) | ((!!o->nojoliet)<<1) | ((!!o->noiso1999)<<2) |
        ((!!o->preferjoliet)<<3) | ((!!o->pretend_blank)<<4) |
        ((!!o->noaaip) << 5) | ((!!o->noacl) << 6) | ((!!o->noea) << 7) |
-       ((!!o->noino) << 8) | ((o->nomd5 & 3) << 9);
+       ((!!o->noino) << 8) | ((o->nomd5 & 3) << 9) |
+       ((!!o->lazy_dirs) << 11);
  return(1);
 }
 
@@ -1080,6 +1103,9 @@ int isoburn_igopt_new(struct isoburn_imgen_opts **new_o, int flag)
  o->gid= 0;
  o->output_charset= NULL;
  o->fifo_size= 4*1024*1024;
+ o->file_readers= 0;
+ o->file_prefetch= 0;
+ o->dedup_content= 0;
  o->effective_lba= -1;
  o->data_start_lba= -1;
  o->system_area_data= NULL;
@@ -1152,7 +1178,7 @@ int isoburn_igopt_set_extensions(struct isoburn_imgen_opts *o, int ext)
  o->hardlinks= !!(ext & 8);
  o->aaip= !!(ext & 32);
  o->session_md5= !!(ext & 64);
- o->file_md5= (ext & (128 | 256)) >> 7;
+ o->file_md5= ((ext & (128 | 256)) >> 7) | ((!!(ext & 16384)) << 2);
  o->no_emul_toc= !!(ext & 512);
  o->will_cancel= !!(ext & 1024);
  o->old_empty= !!(ext & 2048);
@@ -1169,7 +1195,7 @@ int isoburn_igopt_get_extensions(struct isoburn_imgen_opts *o, int *ext)
        ((!!o->session_md5) << 6) | ((o->file_md5 & 3) << 7) |
        ((!!o->no_emul_toc) << 9) | ((o->will_cancel) << 10) |
        ((!!o->old_empty) << 11) | ((!!o->hfsplus) << 12) |
-       ((!!o->fat) << 13);
+       ((!!o->fat) << 13) | ((!!(o->file_md5 & 4)) << 14);
  return(1);
 }
 
@@ -1385,6 +1411,43 @@ int isoburn_igopt_get_fifo_size(struct isoburn_imgen_opts *o, int *fifo_size)
 }
 
 
+int isoburn_igopt_set_file_readers(struct isoburn_imgen_opts *o,
+                                   int num_readers, int prefetch_files)
+{
+ if(num_readers < 0 || num_readers > 64 ||
+    prefetch_files < 0 || prefetch_files > 1024)
+   return(0);
+ o->file_readers= num_readers;
+ o->file_prefetch= prefetch_files;
+ return(1);
+}
+
+
+int isoburn_igopt_get_file_readers(struct isoburn_imgen_opts *o,
+                                   int *num_readers, int *prefetch_files)
+{
+ *num_readers= o->file_readers;
+ *prefetch_files= o->file_prefetch;
+ return(1);
+}
+
+
+int isoburn_igopt_set_dedup_content(struct isoburn_imgen_opts *o, int mode)
+{
+ if(mode < 0 || mode > 1)
+   return(0);
+ o->dedup_content= mode;
+ return(1);
+}
+
+
+int isoburn_igopt_get_dedup_content(struct isoburn_imgen_opts *o, int *mode)
+{
+ *mode= o->dedup_content;
+ return(1);
+}
+
+
 int isoburn_igopt_get_effective_lba(struct isoburn_imgen_opts *o, int *lba)
 {
  *lba= o->effective_lba;
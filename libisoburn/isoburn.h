@@ -259,6 +259,7 @@ int isoburn_get_msc2(struct isoburn *o,
     @param d drive to read from. Must be grabbed.
     @param displacement will be added or subtracted to any block address
     @param displacement_sign  +1 = add , -1= subtract , else keep unaltered
+    @param flag  bit0= do not read ahead by a background thread
     @return the data source, NULL on error. Must be freed with libisofs
             iso_data_source_unref() function. Note: this doesn't release
             the drive.
@@ -266,7 +267,7 @@ int isoburn_get_msc2(struct isoburn *o,
 IsoDataSource *
 isoburn_data_source_new(struct burn_drive *d,
                          uint32_t displacement, int displacement_sign,
-                         int cache_tiles, int tile_blocks);
+                         int cache_tiles, int tile_blocks, int flag);
 
 /** Default settings for above cache_tiles, tile_blocks in newly created
     struct isoburn_read_opts.
@@ -287,12 +288,27 @@ isoburn_data_source_new(struct burn_drive *d,
     to use this object for reading any more, nevertheless. The disabled state
     of the data source is a safety fence around this daring situation.
     @param src The data source to be disabled
-    @param flag  unused yet
+    @param flag  bit0= only end read-ahead and wait until the read-ahead
+                       thread does not use the drive any more.
+                       Keep the data source usable.
     @return <=0 is failure , >0 success
 */
 int isoburn_data_source_shutdown(IsoDataSource *src, int flag);
 
 
+/** Open or close the window in which a data source which was created by
+    isoburn_data_source_new() may read ahead by a background thread.
+    The window is closed initially. Closing it ends read-ahead and waits
+    until the read-ahead thread does not use the drive any more.
+    The drive must not be used for anything but burn_read_data() while
+    the window is open.
+    @param src   The data source
+    @param flag  bit0= open the window, else close it
+    @return <=0 is failure , >0 success
+*/
+int isoburn_data_source_read_ahead(IsoDataSource *src, int flag);
+
+
 /** Check whether the size of target_iso_head matches the given partition
     offset. Eventually adjust size.
 */
@@ -314,6 +330,7 @@ int isoburn_root_defaults(IsoImage *image, int flag);
 struct isoburn_read_opts {
     int cache_tiles; /* number of cache tiles */
     int cache_tile_blocks;
+    int cache_flag;  /* bit0= no read-ahead */
 
     unsigned int norock:1; /*< Do not read Rock Ridge extensions */
     unsigned int nojoliet:1; /*< Do not read Joliet extensions */
@@ -330,6 +347,8 @@ struct isoburn_read_opts {
     /* ts A90810 */
     unsigned int nomd5:2;    /* Do not read eventual MD5 array */
 
+    unsigned int lazy_dirs:1; /* Read directories on first access */
+
     unsigned int preferjoliet:1; 
                 /*< When both Joliet and RR extensions are present, the RR
                  *  tree is used. If you prefer using Joliet, set this to 1. */
@@ -410,7 +429,7 @@ struct isoburn_imgen_opts {
     /* Produce and write MD5 checksums for each single IsoFile.
        See parameter "files" of iso_write_opts_set_record_md5().
      */
-    unsigned int file_md5 :2;
+    unsigned int file_md5 :3;
 
     /* On overwriteable media or random access files do not write the first
        session to LBA 32, but rather to LBA 0 directly.
@@ -595,6 +614,17 @@ struct isoburn_imgen_opts {
     */
     int fifo_size;
 
+    /** Number of threads and of data files for read-ahead of file content.
+        See libisofs.h, iso_write_opts_set_file_readers().
+    */
+    int file_readers;
+    int file_prefetch;
+
+    /** Whether data files with identical content shall share their extents.
+        See libisofs.h, iso_write_opts_set_dedup_content().
+    */
+    int dedup_content;
+
 
     /** Output value: Block address of session start as evaluated from medium
                       and other options by libisoburn and libburn.
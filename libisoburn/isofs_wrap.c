@@ -269,6 +269,7 @@ displacement_rollover:;
    int_num= 0;
  iso_read_opts_set_no_md5(ropts, int_num);
  iso_read_opts_set_new_inos(ropts, read_opts->noino);
+ iso_read_opts_set_lazy_dirs(ropts, read_opts->lazy_dirs);
 
  iso_read_opts_set_no_joliet(ropts, read_opts->nojoliet);
  iso_read_opts_set_no_iso1999(ropts, read_opts->noiso1999);
@@ -283,7 +284,8 @@ displacement_rollover:;
 
  ds = isoburn_data_source_new(d, read_opts->displacement,
                          read_opts->displacement_sign,
-                         read_opts->cache_tiles, read_opts->cache_tile_blocks);
+                         read_opts->cache_tiles, read_opts->cache_tile_blocks,
+                         read_opts->cache_flag & 1);
  if (ds == NULL) {
    isoburn_report_iso_error(ret, "Cannot create IsoDataSource object", 0,
                             "FATAL", 0);
@@ -298,8 +300,11 @@ displacement_rollover:;
    iso_tree_set_report_callback(o->image, NULL);
  else
    iso_tree_set_report_callback(o->image, o->read_pacifier);
+ isoburn_data_source_read_ahead(ds, 1);
  ret = iso_image_import(o->image, ds, ropts, &features);
  iso_tree_set_report_callback(o->image, NULL);
+ /* Let the application use the drive without a read-ahead thread */
+ isoburn_data_source_shutdown(ds, 1);
  iso_read_opts_free(ropts);
  ropts= NULL;
 
@@ -371,6 +376,23 @@ int isoburn_attach_start_lba(struct burn_drive *d, int lba, int flag)
 }
 
 
+/* API */
+int isoburn_set_read_ahead(struct burn_drive *d, int flag)
+{
+ int ret;
+ struct isoburn *o;
+
+ ret = isoburn_find_emulator(&o, d, 0);
+ if(ret < 0)
+   return ret;
+ if(o == NULL)
+   return 0;
+ if(o->iso_data_source == NULL)
+   return 0;
+ return isoburn_data_source_read_ahead(o->iso_data_source, flag & 1);
+}
+
+
 /* API function. See libisoburn.h
 */
 int isoburn_activate_session(struct burn_drive *drive)
@@ -807,7 +807,12 @@ int isoburn_ropt_destroy(struct isoburn_read_opts **o, int flag);
                         Default is 32.
                         cache_tiles * tile_blocks * 2048 must not exceed
                         1073741824 (= 1 GiB).
-    @param flag         Bitfield for control purposes. Unused yet. Submit 0.
+    @param flag         Bitfield for control purposes.
+                        bit0= @since 1.3.2
+                              Do not read ahead.
+                              With 4 or more tiles, a background thread loads
+                              up to cache_tiles / 2 tiles ahead if the tiles
+                              get read in ascending sequence.
     @return             <=0 error , >0 ok
 */ 
 int isoburn_ropt_set_data_cache(struct isoburn_read_opts *o,
@@ -819,7 +824,8 @@ int isoburn_ropt_set_data_cache(struct isoburn_read_opts *o,
                         NULL has the same effect as flag bit0.
     @param cache_tiles  Will return the number of tiles in the cache.
     @param tile_blocks  Will return the number of blocks per tile.
-    @param set_flag     Will return control bits. None are defined yet.
+    @param set_flag     Will return control bits as of
+                        isoburn_ropt_set_data_cache() parameter flag.
     @param flag         Bitfield for control purposes
                         bit0= return default values rather than current ones
     @return             <=0 error , >0 reply is valid
@@ -874,6 +880,12 @@ int isoburn_ropt_get_data_cache(struct isoburn_read_opts *o,
                      @since 1.0.4
                      Do not check eventual session_md5 tags although bit9
                      is not set.
+              bit11= lazy_dirs
+                     @since 1.3.2
+                     Read only the top level directory of the image tree.
+                     Other directories get read when their content is
+                     needed for the first time. Images with El Torito boot
+                     records get loaded completely.
     @return    1 success, <=0 failure
 */
 #define isoburn_ropt_norock         1
@@ -887,6 +899,7 @@ int isoburn_ropt_get_data_cache(struct isoburn_read_opts *o,
 #define isoburn_ropt_noino        256
 #define isoburn_ropt_nomd5        512
 #define isoburn_ropt_nomd5tag    1024
+#define isoburn_ropt_lazy_dirs   2048
 
 int isoburn_ropt_set_extensions(struct isoburn_read_opts *o, int ext);
 int isoburn_ropt_get_extensions(struct isoburn_read_opts *o, int *ext);
@@ -1143,6 +1156,14 @@ int isoburn_igopt_get_level(struct isoburn_imgen_opts *o, int *level);
                  by an MBR partition entry in the System Area.
                  Caution: Interferes with isoburn_igopt_set_system_area() by
                           >>> what impact ?
+          bit14= file_stat_stability (only together with file_md5)
+                 @since 1.3.2
+                 Like file_stability, but compare size, timestamps and inode
+                 number of each disk file before and after copying it into
+                 the image, rather than reading it twice. Only files which
+                 changed too recently to be judged by their timestamps get
+                 read for a MD5 in advance. Overrides file_stability.
+                 See also libisofs.h  iso_write_opts_set_record_md5()
 
     @return 1 success, <=0 failure
 */
@@ -1159,6 +1180,7 @@ int isoburn_igopt_get_level(struct isoburn_imgen_opts *o, int *level);
 #define isoburn_igopt_old_empty      2048
 #define isoburn_igopt_hfsplus        4096
 #define isoburn_igopt_fat            8192
+#define isoburn_igopt_file_stat_stability 16384
 int isoburn_igopt_set_extensions(struct isoburn_imgen_opts *o, int ext);
 int isoburn_igopt_get_extensions(struct isoburn_imgen_opts *o, int *ext);
 
@@ -1433,6 +1455,37 @@ int isoburn_igopt_set_fifo_size(struct isoburn_imgen_opts *o, int fifo_size);
 int isoburn_igopt_get_fifo_size(struct isoburn_imgen_opts *o, int *fifo_size);
 
 
+/** Set the number of threads which open, read and filter the content of
+    data files ahead of the image writer thread, and the number of data
+    files which may be read ahead at the same time.
+    The resulting image is the same as without read-ahead.
+    See libisofs.h, iso_write_opts_set_file_readers().
+    @since 1.3.2
+    @param o               The option set to work on
+    @param num_readers     Number of threads. 0 disables read-ahead.
+                           Maximum is 64.
+    @param prefetch_files  Number of files which may be in reading at the
+                           same time. Maximum is 1024.
+    @return 1 success, <=0 failure
+*/
+int isoburn_igopt_set_file_readers(struct isoburn_imgen_opts *o,
+                                   int num_readers, int prefetch_files);
+int isoburn_igopt_get_file_readers(struct isoburn_imgen_opts *o,
+                                   int *num_readers, int *prefetch_files);
+
+
+/** Control whether data files with identical content shall be written only
+    once and share their extents in the image.
+    See libisofs.h, iso_write_opts_set_dedup_content().
+    @since 1.3.2
+    @param o               The option set to work on
+    @param mode            0= off (default), 1= on
+    @return 1 success, <=0 failure
+*/
+int isoburn_igopt_set_dedup_content(struct isoburn_imgen_opts *o, int mode);
+int isoburn_igopt_get_dedup_content(struct isoburn_imgen_opts *o, int *mode);
+
+
 /** Obtain after image preparation the block address where the session will
     start on the medium.
     This value cannot be set by the application but only be inquired.
@@ -2004,6 +2057,26 @@ int isoburn_attach_image(struct burn_drive *d, IsoImage *image);
 int isoburn_attach_start_lba(struct burn_drive *d, int lba, int flag);
 
 
+/** Allow or end read-ahead by a background thread when file content of the
+    image gets read from the drive. isoburn_read_image() allows it only for
+    the time of tree loading. An application may allow it for the time of
+    reading file content in large sequences, e.g. when copying files from
+    the image to disk.
+    Read-ahead does not happen if it was disabled by
+    isoburn_ropt_set_data_cache().
+    The drive must not be used for anything but reading of image data until
+    read-ahead gets ended by this call.
+    @since 1.3.2
+    @param d    The drive from which the image was loaded
+    @param flag Bitfield for control purposes
+                bit0= allow read-ahead
+                      else end read-ahead and wait until the read-ahead
+                      thread does not use the drive any more
+    @return     <=0 error (e.g. no image was loaded from d), 1 = success
+*/
+int isoburn_set_read_ahead(struct burn_drive *d, int flag);
+
+
 /** Return the best possible estimation of the currently available capacity of
     the medium. This might depend on particular write option settings and on
     drive state.
@@ -10,9 +10,13 @@
 /*
  * Synchronized ring buffer, works with a writer thread and a read thread.
  *
+ * The writer thread alone advances the count of written bytes and the
+ * reader thread alone advances the count of read bytes. So as long as
+ * there is space resp. data available, both threads work without locking.
+ * The mutex and the condition variables are only used for waiting when
+ * the buffer is full resp. empty, and for closing.
+ *
  * TODO #00010 : optimize ring buffer
- *  - write/read at the end of buffer requires a second mutex_lock, even if
- *    there's enought space/data at the beginning
  *  - pre-buffer for writes < BLOCK_SIZE
  *
  */
@@ -37,6 +41,23 @@
 #   define MIN(a, b) (((a) < (b)) ? (a) : (b))
 #endif
 
+
+/* Whether the compiler offers the __atomic builtins of GCC >= 4.7.
+   Else the shared counters and flags get protected by a mutex.
+*/
+#ifndef Libisofs_ring_with_atomicS
+#ifdef __clang__
+#define Libisofs_ring_with_atomicS yes
+#else
+#ifdef __GNUC__
+#if __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)
+#define Libisofs_ring_with_atomicS yes
+#endif
+#endif
+#endif /* ! __clang__ */
+#endif /* ! Libisofs_ring_with_atomicS */
+
+
 struct iso_ring_buffer
 {
     uint8_t *buf;
@@ -47,9 +68,13 @@ struct iso_ring_buffer
     size_t cap;
 
     /*
-     * Number of bytes available.
+     * Number of bytes ever written resp. read. The difference is the number
+     * of bytes available. wcount is only changed by the writer thread,
+     * rcount only by the reader thread. Both may overflow, unsigned
+     * arithmetics keeps the difference correct.
      */
-    size_t size;
+    size_t wcount;
+    size_t rcount;
 
     /* position for reading and writing, offset from buf */
     size_t rpos;
@@ -59,8 +84,12 @@ struct iso_ring_buffer
      * flags to report if read or writer threads ends execution
      * 0 not finished, 1 finished ok, 2 finish with error
      */
-    unsigned int rend :2;
-    unsigned int wend :2;
+    int rend;
+    int wend;
+
+    /* Set while the writer resp. reader thread waits for the other one */
+    int w_waiting;
+    int r_waiting;
 
     /* just for statistical purposes */
     unsigned int times_full;
@@ -69,8 +98,68 @@ struct iso_ring_buffer
     pthread_mutex_t mutex;
     pthread_cond_t empty;
     pthread_cond_t full;
+
+#ifndef Libisofs_ring_with_atomicS
+    pthread_mutex_t counter_mutex;
+#endif
 };
 
+
+static
+size_t ring_get_count(IsoRingBuffer *buf, size_t *count)
+{
+#ifdef Libisofs_ring_with_atomicS
+    return __atomic_load_n(count, __ATOMIC_SEQ_CST);
+#else
+    size_t value;
+
+    pthread_mutex_lock(&buf->counter_mutex);
+    value = *count;
+    pthread_mutex_unlock(&buf->counter_mutex);
+    return value;
+#endif
+}
+
+static
+void ring_set_count(IsoRingBuffer *buf, size_t *count, size_t value)
+{
+#ifdef Libisofs_ring_with_atomicS
+    __atomic_store_n(count, value, __ATOMIC_SEQ_CST);
+#else
+    pthread_mutex_lock(&buf->counter_mutex);
+    *count = value;
+    pthread_mutex_unlock(&buf->counter_mutex);
+#endif
+}
+
+static
+int ring_get_flag(IsoRingBuffer *buf, int *flag)
+{
+#ifdef Libisofs_ring_with_atomicS
+    return __atomic_load_n(flag, __ATOMIC_SEQ_CST);
+#else
+    int value;
+
+    pthread_mutex_lock(&buf->counter_mutex);
+    value = *flag;
+    pthread_mutex_unlock(&buf->counter_mutex);
+    return value;
+#endif
+}
+
+static
+void ring_set_flag(IsoRingBuffer *buf, int *flag, int value)
+{
+#ifdef Libisofs_ring_with_atomicS
+    __atomic_store_n(flag, value, __ATOMIC_SEQ_CST);
+#else
+    pthread_mutex_lock(&buf->counter_mutex);
+    *flag = value;
+    pthread_mutex_unlock(&buf->counter_mutex);
+#endif
+}
+
+
 /**
  * Create a new buffer.
  *
@@ -103,7 +192,8 @@ int iso_ring_buffer_new(size_t size, IsoRingBuffer **rbuf)
         return ISO_OUT_OF_MEM;
     }
 
-    buffer->size = 0;
+    buffer->wcount = 0;
+    buffer->rcount = 0;
     buffer->wpos = 0;
     buffer->rpos = 0;
 
@@ -111,12 +201,17 @@ int iso_ring_buffer_new(size_t size, IsoRingBuffer **rbuf)
     buffer->times_empty = 0;
 
     buffer->rend = buffer->wend = 0;
+    buffer->w_waiting = buffer->r_waiting = 0;
 
     /* init mutex and waiting queues */
     pthread_mutex_init(&buffer->mutex, NULL);
     pthread_cond_init(&buffer->empty, NULL);
     pthread_cond_init(&buffer->full, NULL);
 
+#ifndef Libisofs_ring_with_atomicS
+    pthread_mutex_init(&buffer->counter_mutex, NULL);
+#endif
+
     *rbuf = buffer;
     return ISO_SUCCESS;
 }
@@ -130,6 +225,11 @@ void iso_ring_buffer_free(IsoRingBuffer *buf)
     pthread_mutex_destroy(&buf->mutex);
     pthread_cond_destroy(&buf->empty);
     pthread_cond_destroy(&buf->full);
+
+#ifndef Libisofs_ring_with_atomicS
+    pthread_mutex_destroy(&buf->counter_mutex);
+#endif
+
     free(buf);
 }
 
@@ -149,7 +249,7 @@ void iso_ring_buffer_free(IsoRingBuffer *buf)
  */
 int iso_ring_buffer_write(IsoRingBuffer *buf, uint8_t *data, size_t count)
 {
-    size_t len;
+    size_t len, space;
     size_t bytes_write = 0;
 
     if (buf == NULL || data == NULL) {
@@ -158,42 +258,106 @@ int iso_ring_buffer_write(IsoRingBuffer *buf, uint8_t *data, size_t count)
 
     while (bytes_write < count) {
 
-        pthread_mutex_lock(&buf->mutex);
-
-        while (buf->size == buf->cap) {
-
-            /*
-             * Note. There's only a writer, so we have no race conditions.
-             * Thus, the while(buf->size == buf->cap) is used here
-             * only to propertly detect the reader has been cancelled
-             */
-
-            if (buf->rend) {
-                /* the read procces has been finished */
-                pthread_mutex_unlock(&buf->mutex);
-                return 0;
+        space = buf->cap - (buf->wcount - ring_get_count(buf, &buf->rcount));
+        if (space == 0) {
+            pthread_mutex_lock(&buf->mutex);
+
+            /* Announce waiting before looking again at the reader's count,
+               so that the reader cannot miss to wake us up */
+            ring_set_flag(buf, &buf->w_waiting, 1);
+            while (buf->wcount - ring_get_count(buf, &buf->rcount) ==
+                   buf->cap) {
+
+                if (ring_get_flag(buf, &buf->rend)) {
+                    /* the read procces has been finished */
+                    ring_set_flag(buf, &buf->w_waiting, 0);
+                    pthread_mutex_unlock(&buf->mutex);
+                    return 0;
+                }
+                buf->times_full++;
+                /* wait until space available */
+                pthread_cond_wait(&buf->full, &buf->mutex);
             }
-            buf->times_full++;
-            /* wait until space available */
-            pthread_cond_wait(&buf->full, &buf->mutex);
+            ring_set_flag(buf, &buf->w_waiting, 0);
+            pthread_mutex_unlock(&buf->mutex);
+    continue;
         }
 
-        len = MIN(count - bytes_write, buf->cap - buf->size);
+        len = MIN(count - bytes_write, space);
         if (buf->wpos + len > buf->cap) {
             len = buf->cap - buf->wpos;
         }
         memcpy(buf->buf + buf->wpos, data + bytes_write, len);
         buf->wpos = (buf->wpos + len) % (buf->cap);
         bytes_write += len;
-        buf->size += len;
+        ring_set_count(buf, &buf->wcount, buf->wcount + len);
 
         /* wake up reader */
-        pthread_cond_signal(&buf->empty);
-        pthread_mutex_unlock(&buf->mutex);
+        if (ring_get_flag(buf, &buf->r_waiting)) {
+            pthread_mutex_lock(&buf->mutex);
+            pthread_cond_signal(&buf->empty);
+            pthread_mutex_unlock(&buf->mutex);
+        }
     }
     return ISO_SUCCESS;
 }
 
+/*
+ * Wait until data are available for the reader thread.
+ *
+ * @return
+ *      number of bytes available, 0 EOF
+ */
+static
+size_t ring_wait_data(IsoRingBuffer *buf)
+{
+    size_t size;
+
+    size = ring_get_count(buf, &buf->wcount) - buf->rcount;
+    if (size > 0)
+        return size;
+
+    pthread_mutex_lock(&buf->mutex);
+
+    /* Announce waiting before looking again at the writer's count,
+       so that the writer cannot miss to wake us up */
+    ring_set_flag(buf, &buf->r_waiting, 1);
+    while ((size = ring_get_count(buf, &buf->wcount) - buf->rcount) == 0) {
+        /*
+         * Check for the EOF only if the buffer is empty, so that
+         * the reader gets all data which were written before the
+         * writer finished.
+         */
+        if (ring_get_flag(buf, &buf->wend)) {
+            /* the writer procces has been finished */
+    break;
+        }
+        buf->times_empty++;
+        /* wait until data available */
+        pthread_cond_wait(&buf->empty, &buf->mutex);
+    }
+    ring_set_flag(buf, &buf->r_waiting, 0);
+    pthread_mutex_unlock(&buf->mutex);
+    return size;
+}
+
+/*
+ * Hand len bytes at the read position back to the writer thread.
+ */
+static
+void ring_consume(IsoRingBuffer *buf, size_t len)
+{
+    buf->rpos = (buf->rpos + len) % (buf->cap);
+    ring_set_count(buf, &buf->rcount, buf->rcount + len);
+
+    /* wake up the writer */
+    if (ring_get_flag(buf, &buf->w_waiting)) {
+        pthread_mutex_lock(&buf->mutex);
+        pthread_cond_signal(&buf->full);
+        pthread_mutex_unlock(&buf->mutex);
+    }
+}
+
 /**
  * Read count bytes from the buffer into dest. It blocks until the desired
  * bytes has been read. If the writer finishes before outputting enought
@@ -205,7 +369,7 @@ int iso_ring_buffer_write(IsoRingBuffer *buf, uint8_t *data, size_t count)
  */
 int iso_ring_buffer_read(IsoRingBuffer *buf, uint8_t *dest, size_t count)
 {
-    size_t len;
+    size_t len, size;
     size_t bytes_read = 0;
 
     if (buf == NULL || dest == NULL) {
@@ -213,46 +377,82 @@ int iso_ring_buffer_read(IsoRingBuffer *buf, uint8_t *dest, size_t count)
     }
 
     while (bytes_read < count) {
-        pthread_mutex_lock(&buf->mutex);
-
-        while (buf->size == 0) {
-            /*
-             * Note. There's only a reader, so we have no race conditions.
-             * Thus, the while(buf->size == 0) is used here just to ensure
-             * a reader detects the EOF propertly if the writer has been
-             * canceled while the reader was waiting
-             */
-
-            if (buf->wend) {
-                /* the writer procces has been finished */
-                pthread_mutex_unlock(&buf->mutex);
-                return 0; /* EOF */
-            }
-            buf->times_empty++;
-            /* wait until data available */
-            pthread_cond_wait(&buf->empty, &buf->mutex);
-        }
+        size = ring_wait_data(buf);
+        if (size == 0)
+            return 0; /* EOF */
 
-        len = MIN(count - bytes_read, buf->size);
+        len = MIN(count - bytes_read, size);
         if (buf->rpos + len > buf->cap) {
             len = buf->cap - buf->rpos;
         }
         memcpy(dest + bytes_read, buf->buf + buf->rpos, len);
-        buf->rpos = (buf->rpos + len) % (buf->cap);
         bytes_read += len;
-        buf->size -= len;
+        ring_consume(buf, len);
+    }
+    return ISO_SUCCESS;
+}
 
-        /* wake up the writer */
-        pthread_cond_signal(&buf->full);
-        pthread_mutex_unlock(&buf->mutex);
+/**
+ * Lend the reader a pointer to the next bytes in the buffer instead of
+ * copying them. It blocks until at least one byte is available.
+ * The lent bytes stay valid until iso_ring_buffer_release() is called.
+ *
+ * @param data
+ *      Will return a pointer into the buffer
+ * @param count
+ *      Maximum number of bytes to lend
+ * @param lent
+ *      Will return the number of bytes at *data. They are contiguous in
+ *      memory. It may be less than count.
+ * @return
+ *      1 success, 0 EOF, < 0 error
+ */
+int iso_ring_buffer_lend(IsoRingBuffer *buf, uint8_t **data, size_t count,
+                         size_t *lent)
+{
+    size_t size;
+
+    if (buf == NULL || data == NULL || lent == NULL) {
+        return ISO_NULL_POINTER;
+    }
+    *lent = 0;
+    size = ring_wait_data(buf);
+    if (size == 0)
+        return 0; /* EOF */
+    if (size > count)
+        size = count;
+    if (buf->rpos + size > buf->cap)
+        size = buf->cap - buf->rpos;
+    *data = buf->buf + buf->rpos;
+    *lent = size;
+    return ISO_SUCCESS;
+}
+
+/**
+ * Give the first count bytes of a lending by iso_ring_buffer_lend() back
+ * to the writer.
+ *
+ * @return
+ *      1 success, < 0 error
+ */
+int iso_ring_buffer_release(IsoRingBuffer *buf, size_t count)
+{
+    if (buf == NULL) {
+        return ISO_NULL_POINTER;
+    }
+    if (count > ring_get_count(buf, &buf->wcount) - buf->rcount ||
+        buf->rpos + count > buf->cap) {
+        return ISO_ASSERT_FAILURE;
     }
+    if (count > 0)
+        ring_consume(buf, count);
     return ISO_SUCCESS;
 }
 
 void iso_ring_buffer_writer_close(IsoRingBuffer *buf, int error)
 {
     pthread_mutex_lock(&buf->mutex);
-    buf->wend = error ? 2 : 1;
+    ring_set_flag(buf, &buf->wend, error ? 2 : 1);
 
     /* ensure no reader is waiting */
     pthread_cond_signal(&buf->empty);
@@ -263,13 +463,13 @@ void iso_ring_buffer_reader_close(IsoRingBuffer *buf, int error)
 {
     pthread_mutex_lock(&buf->mutex);
 
-    if (buf->rend) {
+    if (ring_get_flag(buf, &buf->rend)) {
         /* reader already closed */
         pthread_mutex_unlock(&buf->mutex);
         return;
     }
 
-    buf->rend = error ? 2 : 1;
+    ring_set_flag(buf, &buf->rend, error ? 2 : 1);
 
     /* ensure no writer is waiting */
     pthread_cond_signal(&buf->full);
@@ -316,23 +516,25 @@ int iso_ring_buffer_get_buf_status(IsoRingBuffer *buf, size_t *size,
                                    size_t *free_bytes)
 {
     int ret;
+    size_t rcount, wcount;
 
     if (buf == NULL) {
         return ISO_NULL_POINTER;
     }
 
-    /* get mutex */
-    pthread_mutex_lock(&buf->mutex);
     if (size) {
         *size = buf->cap;
     }
     if (free_bytes) {
-        *free_bytes = buf->cap - buf->size;
+        /* rcount first: both only grow and wcount never falls behind
+           rcount, so the difference cannot underflow */
+        rcount = ring_get_count(buf, &buf->rcount);
+        wcount = ring_get_count(buf, &buf->wcount);
+        *free_bytes = buf->cap - (wcount - rcount);
     }
 
-    ret = (buf->rend ? 4 : 0) + (buf->wend + 1);
-
-    pthread_mutex_unlock(&buf->mutex);
+    ret = (ring_get_flag(buf, &buf->rend) ? 4 : 0) +
+          (ring_get_flag(buf, &buf->wend) + 1);
     return ret;
 }
 
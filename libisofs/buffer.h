@@ -70,6 +70,25 @@ int iso_ring_buffer_write(IsoRingBuffer *buf, uint8_t *data, size_t count);
  */
 int iso_ring_buffer_read(IsoRingBuffer *buf, uint8_t *dest, size_t count);
 
+/**
+ * Lend a pointer to up to count bytes at the read position instead of
+ * copying them. It blocks until at least one byte is available.
+ * The bytes stay valid until iso_ring_buffer_release() is called.
+ * 
+ * @return
+ *      1 success, 0 EOF, < 0 error
+ */
+int iso_ring_buffer_lend(IsoRingBuffer *buf, uint8_t **data, size_t count,
+                         size_t *lent);
+
+/**
+ * Mark the first count bytes of the current lending as read.
+ * 
+ * @return
+ *      1 success, < 0 error
+ */
+int iso_ring_buffer_release(IsoRingBuffer *buf, size_t count);
+
 /** Backend of API call iso_ring_buffer_get_status()
  *
  * Get the status of a ring buffer.
@@ -13,6 +13,7 @@
 
 #include "libisofs.h"
 #include "util.h"
+#include "fsource.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -20,6 +21,7 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <errno.h>
 
 /**
  * Private data for File IsoDataSource
@@ -123,6 +125,57 @@ static int ds_read_block(IsoDataSource *src, uint32_t lba, uint8_t *buffer)
     return ISO_SUCCESS;
 }
 
+static int ds_read_blocks(IsoDataSource *src, uint32_t lba, uint32_t count,
+                          uint8_t *buffer)
+{
+    struct file_data_src *data;
+    size_t todo, done = 0;
+    ssize_t ret;
+
+    if (src == NULL || src->data == NULL || buffer == NULL) {
+        return ISO_NULL_POINTER;
+    }
+
+    data = (struct file_data_src*) src->data;
+    if (data->fd == -1) {
+        return ISO_FILE_NOT_OPENED;
+    }
+
+    if (lseek(data->fd, (off_t)lba * (off_t)2048, SEEK_SET) == (off_t) -1) {
+        return ISO_FILE_SEEK_ERROR;
+    }
+
+    todo = (size_t) count * 2048;
+    while (done < todo) {
+        ret = read(data->fd, buffer + done, todo - done);
+        if (ret == -1 && errno == EINTR)
+            continue;
+        if (ret <= 0) {
+            return ISO_FILE_READ_ERROR;
+        }
+        done += ret;
+    }
+    return ISO_SUCCESS;
+}
+
+int iso_data_source_read_blocks(IsoDataSource *src, uint32_t lba,
+                                uint32_t count, uint8_t *buffer)
+{
+    int ret;
+    uint32_t i;
+
+    if (src->version >= 1 && src->read_blocks != NULL) {
+        return src->read_blocks(src, lba, count, buffer);
+    }
+    for (i = 0; i < count; i++) {
+        ret = src->read_block(src, lba + i, buffer + (size_t) i * 2048);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return ISO_SUCCESS;
+}
+
 static
 void ds_free_data(IsoDataSource *src)
 {
@@ -186,13 +239,14 @@ int iso_data_source_new_from_file(const char *path, IsoDataSource **src)
     }
 
     data->fd = -1;
-    ds->version = 0;
+    ds->version = 1;
     ds->refcount = 1;
     ds->data = data;
 
     ds->open = ds_open;
     ds->close = ds_close;
     ds->read_block = ds_read_block;
+    ds->read_blocks = ds_read_blocks;
     ds->free_data = ds_free_data;
 
     *src = ds;
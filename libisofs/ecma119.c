@@ -741,17 +741,18 @@ int write_dirs(Ecma119Image *t, Ecma119Node *root, Ecma119Node *parent)
 static
 int write_path_table(Ecma119Image *t, Ecma119Node **pathlist, int l_type)
 {
-    size_t i, len;
+    size_t i, len, done, n;
     uint8_t buf[64]; /* 64 is just a convenient size larger enought */
     struct ecma119_path_table_record *rec;
     void (*write_int)(uint8_t*, uint32_t, int);
     Ecma119Node *dir;
-    uint32_t path_table_size;
     int parent = 0;
     int ret= ISO_SUCCESS;
-    uint8_t *zeros = NULL;
+    uint8_t *buffer = NULL;
+    size_t fill = 0; /* bytes of records in buffer */
 
-    path_table_size = 0;
+    /* The records get collected in buffer and written block by block */
+    LIBISO_ALLOC_MEM(buffer, uint8_t, BLOCK_SIZE);
     write_int = l_type ? iso_lsb : iso_msb;
 
     for (i = 0; i < t->ndirs; i++) {
@@ -774,23 +775,32 @@ int write_path_table(Ecma119Image *t, Ecma119Node **pathlist, int l_type)
             memcpy(rec->dir_id, dir->iso_name, rec->len_di[0]);
         }
         len = 8 + rec->len_di[0] + (rec->len_di[0] % 2);
-        ret = iso_write(t, buf, len);
-        if (ret < 0) {
-            /* error */
-            goto ex;
+
+        /* a record may continue in the next block */
+        for (done = 0; done < len; done += n) {
+            n = BLOCK_SIZE - fill;
+            if (n > len - done)
+                n = len - done;
+            memcpy(buffer + fill, buf + done, n);
+            fill += n;
+            if (fill == BLOCK_SIZE) {
+                ret = iso_write(t, buffer, BLOCK_SIZE);
+                if (ret < 0) {
+                    /* error */
+                    goto ex;
+                }
+                fill = 0;
+            }
         }
-        path_table_size += len;
     }
 
     /* we need to fill the last block with zeros */
-    path_table_size %= BLOCK_SIZE;
-    if (path_table_size) {
-        len = BLOCK_SIZE - path_table_size;
-        LIBISO_ALLOC_MEM(zeros, uint8_t, len);
-        ret = iso_write(t, zeros, len);
+    if (fill > 0) {
+        memset(buffer + fill, 0, BLOCK_SIZE - fill);
+        ret = iso_write(t, buffer, BLOCK_SIZE);
     }
 ex:;
-    LIBISO_FREE_MEM(zeros);
+    LIBISO_FREE_MEM(buffer);
     return ret;
 }
 
@@ -1675,6 +1685,143 @@ int checksum_prepare_nodes(Ecma119Image *target, IsoNode *node, int flag)
     return ISO_SUCCESS;
 }
 
+void ecma119_trees_lock(Ecma119Image *target)
+{
+    if (target->trees_running)
+        pthread_mutex_lock(&target->trees_mutex);
+}
+
+void ecma119_trees_unlock(Ecma119Image *target)
+{
+    if (target->trees_running)
+        pthread_mutex_unlock(&target->trees_mutex);
+}
+
+/* Check whether the Joliet, ISO 9660:1999 and HFS+ trees may be built
+   concurrently. This is the case if all their data files already got an
+   IsoFileSrc by the ECMA-119 tree or El Torito. New IsoFileSrc would get
+   their checksum indices in the sequence of tree construction.
+   Sizes of filtered streams get determined here, not in the threads.
+   @param hidden  The LIBISO_HIDE_ON_* bits of the ancestors
+   @return 1= may be built concurrently, 0= not, <0= error
+*/
+static
+int ecma119_trees_check(Ecma119Image *t, IsoNode *node, int hidden)
+{
+    int ret, trees = 0;
+    IsoNode *pos;
+    IsoFileSrc key;
+    off_t size;
+
+    hidden |= node->hidden;
+    if (t->joliet && !(hidden & LIBISO_HIDE_ON_JOLIET))
+        trees |= 1;
+    if (t->iso1999 && !(hidden & LIBISO_HIDE_ON_1999))
+        trees |= 2;
+    if ((t->hfsplus || t->fat) && !(hidden & LIBISO_HIDE_ON_HFSPLUS))
+        trees |= 4;
+    if (trees == 0)
+        return 1;
+
+    if (node->type == LIBISO_DIR) {
+        for (pos = ((IsoDir *) node)->children; pos != NULL; pos = pos->next) {
+            ret = ecma119_trees_check(t, pos, hidden);
+            if (ret <= 0)
+                return ret;
+        }
+    } else if (node->type == LIBISO_FILE) {
+        size = iso_stream_get_size(((IsoFile *) node)->stream);
+        if (size > (off_t) MAX_ISO_FILE_SECTION_SIZE && t->iso_level != 3)
+            trees &= 4; /* Joliet and ISO 9660:1999 will refuse it */
+        if (trees == 0)
+            return 1;
+        memset(&key, 0, sizeof(key));
+        key.stream = ((IsoFile *) node)->stream;
+        if (iso_rbtree_find(t->files, &key, NULL, NULL) <= 0)
+            return 0;
+    } else if (node->type == LIBISO_BOOT) {
+        if ((trees & 3) && t->eltorito && t->cat == NULL)
+            return 0;
+    }
+    return 1;
+}
+
+struct ecma119_tree_job {
+    Ecma119Image *target;
+    int tree;  /* 0= Joliet , 1= ISO 9660:1999 , 2= HFS+ */
+    int ret;
+    pthread_t thread;
+    int thread_running;
+};
+
+static
+void *ecma119_tree_job_run(void *arg)
+{
+    struct ecma119_tree_job *job = (struct ecma119_tree_job *) arg;
+    Ecma119Image *t = job->target;
+
+    if (job->tree == 0) {
+        iso_msg_debug(t->image->id, "Creating low level Joliet tree...");
+        job->ret = joliet_tree_create(t, 0);
+        if (job->ret >= 0 && t->partition_offset > 0)
+            job->ret = joliet_tree_create(t, 1);
+    } else if (job->tree == 1) {
+        iso_msg_debug(t->image->id,
+                      "Creating low level ISO 9660:1999 tree...");
+        job->ret = iso1999_tree_create(t);
+    } else {
+        job->ret = hfsplus_tree_create(t);
+    }
+    return NULL;
+}
+
+/* Build the Joliet, ISO 9660:1999 and HFS+ trees in parallel threads.
+   Their writers were already registered without trees, so that their
+   free_data() functions dispose partly built trees in case of error.
+   The calling thread builds the first tree. A tree which gets no own thread
+   is built after the others have been finished.
+   Errors are reported in the fixed sequence Joliet, ISO 9660:1999, HFS+.
+*/
+static
+int ecma119_build_trees(Ecma119Image *t)
+{
+    struct ecma119_tree_job jobs[3];
+    int njobs = 0, i, ret;
+
+    memset(jobs, 0, sizeof(jobs));
+    if (t->joliet)
+        jobs[njobs++].tree = 0;
+    if (t->iso1999)
+        jobs[njobs++].tree = 1;
+    if (t->hfsplus || t->fat)
+        jobs[njobs++].tree = 2;
+    for (i = 0; i < njobs; i++)
+        jobs[i].target = t;
+
+    pthread_mutex_init(&t->trees_mutex, NULL);
+    t->trees_running = 1;
+    for (i = 1; i < njobs; i++) {
+        ret = pthread_create(&(jobs[i].thread), NULL, ecma119_tree_job_run,
+                             (void *) (jobs + i));
+        if (ret == 0)
+            jobs[i].thread_running = 1;
+    }
+    ecma119_tree_job_run(jobs);
+    for (i = 1; i < njobs; i++)
+        if (jobs[i].thread_running)
+            pthread_join(jobs[i].thread, NULL);
+    t->trees_running = 0;
+    pthread_mutex_destroy(&t->trees_mutex);
+
+    for (i = 1; i < njobs; i++)
+        if (!jobs[i].thread_running)
+            ecma119_tree_job_run(jobs + i);
+    for (i = 0; i < njobs; i++)
+        if (jobs[i].ret < 0)
+            return jobs[i].ret;
+    return ISO_SUCCESS;
+}
+
 static
 int ecma119_image_new(IsoImage *src, IsoWriteOpts *opts, Ecma119Image **img)
 {
@@ -1687,6 +1834,11 @@ int ecma119_image_new(IsoImage *src, IsoWriteOpts *opts, Ecma119Image **img)
     char *system_area = NULL;
     int write_count = 0, write_count_mem;
 
+    /* All directories of an imported image have to be present */
+    ret = iso_image_load_lazy_dirs(src, 0);
+    if (ret < 0)
+        return ret;
+
     /* 1. Allocate target and copy opts there */
     target = calloc(1, sizeof(Ecma119Image));
     if (target == NULL) {
@@ -1954,6 +2106,9 @@ int ecma119_image_new(IsoImage *src, IsoWriteOpts *opts, Ecma119Image **img)
 
     target->filesrc_start = 0;
     target->filesrc_blocks = 0;
+    target->file_readers = opts->file_readers;
+    target->file_prefetch = opts->file_prefetch;
+    target->dedup_content = opts->dedup_content;
 
     /*
      * 2. Based on those options, create needed writers: iso, joliet...
@@ -2027,6 +2182,17 @@ int ecma119_image_new(IsoImage *src, IsoWriteOpts *opts, Ecma119Image **img)
         el_torito_writer_index = target->nwriters - 1;
     }
 
+    /* Decide whether the Joliet, ISO 9660:1999 and HFS+ trees get built
+       concurrently by ecma119_build_trees()
+    */
+    if (target->joliet + target->iso1999 +
+        (target->hfsplus || target->fat) >= 2) {
+        ret = ecma119_trees_check(target, (IsoNode *) src->root, 0);
+        if (ret < 0)
+            goto target_cleanup;
+        target->trees_parallel = ret;
+    }
+
     /* create writer for Joliet structure */
     if (target->joliet) {
         ret = joliet_writer_create(target);
@@ -2080,6 +2246,11 @@ int ecma119_image_new(IsoImage *src, IsoWriteOpts *opts, Ecma119Image **img)
             goto target_cleanup;
         }
     }
+    if (target->trees_parallel) {
+        ret = ecma119_build_trees(target);
+        if (ret < 0)
+            goto target_cleanup;
+    }
 
     /* create writer for file contents */
     ret = iso_file_src_writer_create(target);
@@ -2442,6 +2613,42 @@ static int bs_read(struct burn_source *bs, unsigned char *buf, int size)
     }
 }
 
+static int bs_lend(struct burn_source *bs, unsigned char **buf, int size)
+{
+    int ret;
+    size_t lent;
+    Ecma119Image *t = (Ecma119Image*)bs->data;
+
+    if (size <= 0)
+        return 0;
+    ret = iso_ring_buffer_lend(t->buffer, buf, (size_t) size, &lent);
+    if (ret == ISO_SUCCESS) {
+        return (int) lent;
+    } else if (ret < 0) {
+        /* error */
+        iso_msg_submit(t->image->id, ISO_BUF_READ_ERROR, ret, NULL);
+        return -1;
+    } else {
+        /* EOF */
+        return 0;
+    }
+}
+
+static int bs_release(struct burn_source *bs, int size)
+{
+    int ret;
+    Ecma119Image *t = (Ecma119Image*)bs->data;
+
+    if (size < 0)
+        return 0;
+    ret = iso_ring_buffer_release(t->buffer, (size_t) size);
+    if (ret < 0) {
+        iso_msg_submit(t->image->id, ISO_BUF_READ_ERROR, ret, NULL);
+        return 0;
+    }
+    return 1;
+}
+
 static off_t bs_get_size(struct burn_source *bs)
 {
     Ecma119Image *target = (Ecma119Image*)bs->data;
@@ -2608,13 +2815,15 @@ int iso_image_create_burn_source(IsoImage *image, IsoWriteOpts *opts,
     }
 
     source->refcount = 1;
-    source->version = 1;
+    source->version = 2;
     source->read = NULL;
     source->get_size = bs_get_size;
     source->set_size = bs_set_size;
     source->free_data = bs_free_data;
     source->read_xt = bs_read;
     source->cancel = bs_cancel;
+    source->lend = bs_lend;
+    source->release = bs_release;
     source->data = target;
 
     *burn_src = source;
@@ -2622,6 +2831,12 @@ int iso_image_create_burn_source(IsoImage *image, IsoWriteOpts *opts,
 }
 
 int iso_write(Ecma119Image *target, void *buf, size_t count)
+{
+    return iso_write_md5(target, buf, count, NULL, (size_t) 0);
+}
+
+int iso_write_md5(Ecma119Image *target, void *buf, size_t count,
+                  void *md5_ctx, size_t md5_len)
 {
     int ret;
 
@@ -2638,10 +2853,22 @@ int iso_write(Ecma119Image *target, void *buf, size_t count)
     }
     if (ret < 0)
         return ret;
+    if (md5_len > count)
+        md5_len = count;
     if (target->checksum_ctx != NULL) {
         /* Add to image checksum */
         target->checksum_counter += count;
-        iso_md5_compute(target->checksum_ctx, (char *) buf, (int) count);
+        if (md5_ctx != NULL && md5_len > 0) {
+            iso_md5_compute_2(target->checksum_ctx, md5_ctx, (char *) buf,
+                              (int) md5_len);
+            if (md5_len < count)
+                iso_md5_compute(target->checksum_ctx, (char *) buf + md5_len,
+                                (int) (count - md5_len));
+        } else {
+            iso_md5_compute(target->checksum_ctx, (char *) buf, (int) count);
+        }
+    } else if (md5_ctx != NULL && md5_len > 0) {
+        iso_md5_compute(md5_ctx, (char *) buf, (int) md5_len);
     }
 
     ret = show_chunk_to_jte(target, buf, count);
@@ -2715,6 +2942,9 @@ int iso_write_opts_new(IsoWriteOpts **opts, int profile)
     wopts->hfsplus = 0;
     wopts->fat = 0;
     wopts->fifo_size = 1024; /* 2 MB buffer */
+    wopts->file_readers = 0;
+    wopts->file_prefetch = 0;
+    wopts->dedup_content = 0;
     wopts->sort_files = 1; /* file sorting is always good */
     wopts->rr_reloc_dir = NULL;
     wopts->rr_reloc_flags = 0;
@@ -3063,7 +3293,7 @@ int iso_write_opts_set_sort_files(IsoWriteOpts *opts, int sort)
 int iso_write_opts_set_record_md5(IsoWriteOpts *opts, int session, int files)
 {
     opts->md5_session_checksum = session & 1;
-    opts->md5_file_checksums = files & 3;
+    opts->md5_file_checksums = files & 7;
     return ISO_SUCCESS;
 }
 
@@ -3238,6 +3468,35 @@ int iso_write_opts_set_fifo_size(IsoWriteOpts *opts, size_t fifo_size)
     return ISO_SUCCESS;
 }
 
+int iso_write_opts_set_file_readers(IsoWriteOpts *opts, int num_readers,
+                                    int prefetch_files)
+{
+    if (opts == NULL) {
+        return ISO_NULL_POINTER;
+    }
+    if (num_readers < 0 || num_readers > ISO_MAX_FILE_READERS ||
+        prefetch_files < 0 || prefetch_files > ISO_MAX_FILE_PREFETCH) {
+        return ISO_WRONG_ARG_VALUE;
+    }
+    if (num_readers > 0 && prefetch_files < num_readers)
+        prefetch_files = num_readers;
+    opts->file_readers = num_readers;
+    opts->file_prefetch = prefetch_files;
+    return ISO_SUCCESS;
+}
+
+int iso_write_opts_set_dedup_content(IsoWriteOpts *opts, int mode)
+{
+    if (opts == NULL) {
+        return ISO_NULL_POINTER;
+    }
+    if (mode < 0 || mode > 1) {
+        return ISO_WRONG_ARG_VALUE;
+    }
+    opts->dedup_content = mode;
+    return ISO_SUCCESS;
+}
+
 int iso_write_opts_get_data_start(IsoWriteOpts *opts, uint32_t *data_start,
                                   int flag)
 {
@@ -70,6 +70,13 @@
 #endif
 
 
+/* The maximum number of threads and of data files in the read-ahead pool
+   of the file source writer. See iso_write_opts_set_file_readers().
+*/
+#define ISO_MAX_FILE_READERS   64
+#define ISO_MAX_FILE_PREFETCH  1024
+
+
 /* The theoretical maximum number of Apple Partition Map entries in the
    System Area of an ISO image:
    Block0 plus 63 entries with block size 512
@@ -267,8 +274,11 @@ struct iso_write_opts {
      * bit0= compute individual checksums
      * bit1= pre-compute checksum and compare it with actual one.
      *       Raise MISHAP if mismatch.
+     * bit2= like bit1, but compare the file attributes before and after
+     *       copying. Pre-compute the checksum only if the attributes are
+     *       too young to be judged.
      */
-    unsigned int md5_file_checksums :2;
+    unsigned int md5_file_checksums :3;
 
     /** If files should be sorted based on their weight. */
     unsigned int sort_files :1;
@@ -393,6 +403,26 @@ struct iso_write_opts {
      */
     size_t fifo_size;
 
+    /**
+     * Number of threads which open, read and filter data file content ahead
+     * of the writer thread. 0 means that the writer thread reads all files
+     * by itself.
+     * See iso_write_opts_set_file_readers().
+     */
+    int file_readers;
+
+    /**
+     * Number of data files which may be in the hands of the file_readers
+     * at the same time.
+     */
+    int file_prefetch;
+
+    /**
+     * Whether data files with identical content shall share their extents.
+     * See iso_write_opts_set_dedup_content().
+     */
+    int dedup_content;
+
     /**
      * This is not an option setting but a value returned after the options
      * were used to compute the layout of the image.
@@ -561,7 +591,7 @@ struct ecma119_image
     Ecma119Node *rr_reloc_node;  /* Directory node in ecma119_image */
 
     unsigned int md5_session_checksum :1;
-    unsigned int md5_file_checksums :2;
+    unsigned int md5_file_checksums :3;
 
     /*
      * Mode replace. If one of these flags is set, the correspodent values are
@@ -779,6 +809,26 @@ struct ecma119_image
     int wthread_is_running;
     pthread_attr_t th_attr;
 
+    /* Read-ahead of data file content. See iso_write_opts_set_file_readers()
+     */
+    int file_readers;
+    int file_prefetch;
+
+    /* Sharing of extents by content. See iso_write_opts_set_dedup_content()
+     */
+    int dedup_content;
+
+    /* Construction of the Joliet, ISO 9660:1999 and HFS+ trees in own
+       threads. See ecma119_build_trees().
+       trees_parallel lets the writer_create functions of these trees leave
+       the tree construction to ecma119_build_trees().
+       trees_running is set while the threads work. trees_mutex then guards
+       the reference counts of IsoNode and the registry of IsoFileSrc.
+     */
+    int trees_parallel;
+    int trees_running;
+    pthread_mutex_t trees_mutex;
+
     /* User settable PVD time stamps */
     time_t vol_creation_time;
     time_t vol_modification_time;
@@ -1050,6 +1100,12 @@ struct ecma119_vol_desc_terminator
 void ecma119_set_voldescr_times(IsoImageWriter *writer,
                                 struct ecma119_pri_vol_desc *vol);
 
+/* Serialize access to shared objects during ecma119_build_trees().
+   No-ops if the trees are built sequentially.
+*/
+void ecma119_trees_lock(Ecma119Image *target);
+void ecma119_trees_unlock(Ecma119Image *target);
+
 /* Copies a data file into the ISO image output stream */
 int iso_write_partition_file(Ecma119Image *target, char *path,
                              uint32_t prepad, uint32_t blocks, int flag);
@@ -72,6 +72,19 @@ struct ecma119_node
 
     /**< file, symlink, special, directory or placeholder */
     enum ecma119_node_type type;
+
+    /*
+     * Outcome of the NM, SL and AL size prediction by rrip_calc_len() for
+     * the directory record of this node. rrip_get_susp_fields() re-uses it
+     * if the record space and the size of the preceding fields are the same.
+     * rr_pred_space is 0 if nothing was predicted yet or if the CE length
+     * did not fit. The fields occupy the padding after type.
+     */
+    uint8_t rr_pred_space;
+    uint8_t rr_pred_su_len;
+    unsigned int rr_pred_ce_used :1;
+    unsigned int rr_pred_ce_len :15;
+
     union
     {
         IsoFileSrc *file;
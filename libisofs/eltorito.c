@@ -19,6 +19,7 @@
 #include "image.h"
 #include "messages.h"
 #include "writer.h"
+#include "util.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -260,25 +261,20 @@ int iso_tree_add_boot_node(IsoDir *parent, const char *name, IsoBoot **boot)
         return ret;
 
     /* find place where to insert */
-    pos = &(parent->children);
-    while (*pos != NULL && strcmp((*pos)->name, name) < 0) {
-        pos = &((*pos)->next);
-    }
-    if (*pos != NULL && !strcmp((*pos)->name, name)) {
+    if (iso_dir_exists(parent, name, &pos)) {
         /* a node with same name already exists */
         return ISO_NODE_NAME_NOT_UNIQUE;
     }
 
-    node = calloc(1, sizeof(IsoBoot));
+    node = (IsoBoot *) iso_node_alloc(LIBISO_BOOT);
     if (node == NULL) {
         return ISO_OUT_OF_MEM;
     }
 
     node->node.refcount = 1;
-    node->node.type = LIBISO_BOOT;
-    node->node.name = strdup(name);
+    node->node.name = iso_str_intern(name);
     if (node->node.name == NULL) {
-        free(node);
+        iso_node_unref((IsoNode *) node);
         return ISO_OUT_OF_MEM;
     }
     node->lba = 0;
@@ -297,15 +293,12 @@ int iso_tree_add_boot_node(IsoDir *parent, const char *name, IsoBoot **boot)
     node->node.ctime = now;
     node->node.mtime = now;
 
-    /* add to dir */
-    node->node.parent = parent;
-    node->node.next = *pos;
-    *pos = (IsoNode*)node;
-
     if (boot) {
         *boot = node;
     }
-    return ++parent->nchildren;
+
+    /* add to dir */
+    return iso_dir_insert(parent, (IsoNode*)node, pos, ISO_REPLACE_NEVER);
 }
 
 
@@ -21,10 +21,13 @@
 #include "image.h"
 #include "stream.h"
 #include "md5.h"
+#include "fsource.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <pthread.h>
+#include <time.h>
 
 /* <<< */
 #include <stdio.h>
@@ -66,6 +69,32 @@ int iso_file_src_cmp(const void *n1, const void *n2)
     return ret;
 }
 
+/* The variant of iso_file_src_create() while ecma119_build_trees() runs.
+   All needed IsoFileSrc exist already. So the tree gets only searched.
+*/
+static
+int iso_file_src_find_shared(Ecma119Image *img, IsoFile *file,
+                             IsoFileSrc **src)
+{
+    int ret = 0, cret;
+    IsoFileSrc key;
+
+    memset(&key, 0, sizeof(key));
+    key.stream = file->stream;
+
+    ecma119_trees_lock(img);
+    iso_rbtree_find(img->files, &key, (void **) src, NULL);
+    if (*src == NULL) {
+        ret = ISO_ASSERT_FAILURE;
+    } else if ((*src)->checksum_index > 0 && !img->will_cancel) {
+        cret = iso_file_set_isofscx(file, (*src)->checksum_index, 0);
+        if (cret < 0)
+            ret = cret;
+    }
+    ecma119_trees_unlock(img);
+    return ret;
+}
+
 int iso_file_src_create(Ecma119Image *img, IsoFile *file, IsoFileSrc **src)
 {
     int ret, i;
@@ -79,6 +108,8 @@ int iso_file_src_create(Ecma119Image *img, IsoFile *file, IsoFileSrc **src)
     if (img == NULL || file == NULL || src == NULL) {
         return ISO_NULL_POINTER;
     }
+    if (img->trees_running)
+        return iso_file_src_find_shared(img, file, src);
 
     iso_stream_get_id(file->stream, &fs_id, &dev_id, &ino_id);
 
@@ -227,12 +258,206 @@ int shall_be_written(void *arg)
     return f->no_write ? 0 : 1;
 }
 
+/* Number of bytes at the start of a file which get hashed to sort out
+   most candidates of equal size before their full content gets read.
+*/
+#define Libisofs_dedup_head_sizE (64 * 1024)
+
+struct iso_dedup_item {
+    IsoFileSrc *file;
+    off_t size;
+    size_t pos;            /* index in filelist */
+    int state;             /* 0 = size known, 1 = head MD5 known,
+                              2 = full MD5 known, -1 = not a candidate */
+    char head_md5[16];
+    char md5[16];
+};
+
+static
+int dedup_cmp(const void *v1, const void *v2)
+{
+    const struct iso_dedup_item *a, *b;
+    int ret;
+
+    a = (const struct iso_dedup_item *) v1;
+    b = (const struct iso_dedup_item *) v2;
+    if (a->size != b->size)
+        return a->size < b->size ? -1 : 1;
+    ret = memcmp(a->head_md5, b->head_md5, 16);
+    if (ret != 0)
+        return ret;
+    ret = memcmp(a->md5, b->md5, 16);
+    if (ret != 0)
+        return ret;
+    if (a->pos != b->pos)
+        return a->pos < b->pos ? -1 : 1;
+    return 0;
+}
+
+/* Compare size and the fingerprints which are known for both items
+*/
+static
+int dedup_same(struct iso_dedup_item *a, struct iso_dedup_item *b, int state)
+{
+    if (a->size != b->size)
+        return 0;
+    if (state >= 1 && memcmp(a->head_md5, b->head_md5, 16) != 0)
+        return 0;
+    if (state >= 2 && memcmp(a->md5, b->md5, 16) != 0)
+        return 0;
+    return 1;
+}
+
+/* Compute the MD5 of the first Libisofs_dedup_head_sizE bytes.
+   If the file is not larger, then this is also its full MD5.
+   @return 1 = ok, 0 = cannot be read, <0 = error
+*/
+static
+int dedup_head_md5(IsoFileSrc *file, off_t size, char *buffer, char md5[16])
+{
+    int ret, is_open = 0;
+    size_t got, todo;
+    void *ctx = NULL;
+
+    ret = iso_md5_start(&ctx);
+    if (ret < 0)
+        return ret;
+    ret = iso_stream_open(file->stream);
+    if (ret < 0)
+        {ret = 0; goto ex;}
+    is_open = 1;
+    if (size > Libisofs_dedup_head_sizE)
+        todo = Libisofs_dedup_head_sizE;
+    else
+        todo = size;
+    ret = iso_stream_read_buffer(file->stream, buffer, todo, &got);
+    if (ret < 0 || got != todo)
+        {ret = 0; goto ex;}
+    iso_md5_compute(ctx, buffer, (int) todo);
+    ret = 1;
+ex:;
+    if (is_open)
+        iso_stream_close(file->stream);
+    iso_md5_end(&ctx, md5);
+    return ret;
+}
+
+/* Find data files with identical content and mark all but the first one
+   in filelist as .dedup_of the first one.
+   The candidates get sorted into groups of equal size, then of equal
+   MD5 of their start, then of equal MD5 of their full content.
+   Only groups with more than one member proceed to the next stage.
+   @return 1 = ok, <0 = error
+*/
+static
+int filesrc_dedup(Ecma119Image *t, IsoFileSrc **filelist, size_t size)
+{
+    int ret, state, k;
+    size_t i, j, n = 0, dups = 0;
+    struct iso_dedup_item *items = NULL;
+    IsoFileSrc *file;
+    char *buffer = NULL;
+    off_t saved_blocks = 0;
+
+    if (size < 2)
+        return ISO_SUCCESS;
+    items = calloc(size, sizeof(struct iso_dedup_item));
+    if (items == NULL)
+        return ISO_OUT_OF_MEM;
+    LIBISO_ALLOC_MEM(buffer, char, Libisofs_dedup_head_sizE);
+
+    for (i = 0; i < size; i++) {
+        file = filelist[i];
+        if (file->no_write || file->sections[0].block == 0xfffffffe)
+    continue;
+        for (k = 0; k < t->num_bootsrc; k++)
+            if (t->bootsrc[k] == file)
+        break;
+        if (k < t->num_bootsrc)
+    continue;
+        if (!iso_stream_is_repeatable(file->stream))
+    continue;
+        items[n].file = file;
+        items[n].size = iso_stream_get_size(file->stream);
+        if (items[n].size <= 0)
+    continue;
+        items[n].pos = i;
+        n++;
+    }
+
+    for (state = 0; state < 2; state++) {
+        qsort(items, n, sizeof(struct iso_dedup_item), dedup_cmp);
+
+        /* Compute the next fingerprint of all members of groups */
+        for (i = 0; i < n; i = j) {
+            for (j = i + 1; j < n; j++)
+                if (!dedup_same(items + i, items + j, state))
+            break;
+            if (j - i < 2)
+        continue;
+            for (k = i; k < (int) j; k++) {
+                if (items[k].state != state)
+            continue;
+                if (state == 0) {
+                    ret = dedup_head_md5(items[k].file, items[k].size,
+                                         buffer, items[k].head_md5);
+                    if (ret > 0 && items[k].size <= Libisofs_dedup_head_sizE)
+                        memcpy(items[k].md5, items[k].head_md5, 16);
+                } else if (items[k].size <= Libisofs_dedup_head_sizE) {
+                    ret = 1;
+                } else {
+                    ret = iso_stream_make_md5(items[k].file->stream,
+                                              items[k].md5, 0);
+                }
+                if (ret < 0)
+                    goto ex;
+                if (ret == 0) {
+                    /* Make the unreadable file unique by its position */
+                    items[k].state = -1;
+                    memset(items[k].head_md5, 0, 16);
+                    memset(items[k].md5, 0, 16);
+                    iso_msg_debug(t->image->id,
+                               "dedup: Cannot read candidate #%.f",
+                               (double) items[k].pos);
+                } else {
+                    items[k].state = state + 1;
+                }
+            }
+        }
+    }
+
+    /* Groups of equal full MD5 share the extents of their first member */
+    qsort(items, n, sizeof(struct iso_dedup_item), dedup_cmp);
+    for (i = 0; i < n; i = j) {
+        for (j = i + 1; j < n; j++)
+            if (items[i].state != 2 || items[j].state != 2 ||
+                !dedup_same(items + i, items + j, 2))
+        break;
+        for (k = i + 1; k < (int) j; k++) {
+            items[k].file->dedup_of = items[i].file;
+            items[k].file->no_write = 1;
+            saved_blocks += DIV_UP(items[k].size, BLOCK_SIZE);
+            dups++;
+        }
+    }
+    if (dups > 0)
+        iso_msg_debug(t->image->id,
+                      "dedup: %.f files share content with others, %.f blocks saved",
+                      (double) dups, (double) saved_blocks);
+    ret = ISO_SUCCESS;
+ex:;
+    free(items);
+    LIBISO_FREE_MEM(buffer);
+    return ret;
+}
+
 int filesrc_writer_pre_compute(IsoImageWriter *writer)
 {
     size_t i, size, is_external;
     Ecma119Image *t;
     IsoFileSrc **filelist;
     int (*inc_item)(void *);
+    int ret;
 
     if (writer == NULL) {
         return ISO_ASSERT_FAILURE;
@@ -265,12 +490,24 @@ int filesrc_writer_pre_compute(IsoImageWriter *writer)
         qsort(filelist, size, sizeof(void*), cmp_by_weight);
     }
 
+    if (t->dedup_content && !t->will_cancel) {
+        ret = filesrc_dedup(t, filelist, size);
+        if (ret < 0) {
+            free(filelist);
+            return ret;
+        }
+    }
+
     /* fill block value */
     for (i = 0; i < size; ++i) {
         int extent = 0;
         IsoFileSrc *file = filelist[i];
         off_t section_size;
 
+        /* Will get the final sections of its twin */
+        if (file->dedup_of != NULL)
+    continue;
+
         /* 0xfffffffe in emerging image means that this is an external
            partition. Only assess extent sizes but do not count as part
            of filesrc_writer output.
@@ -356,6 +593,15 @@ int filesrc_writer_compute_data_blocks(IsoImageWriter *writer)
        }
     }
 
+    /* Let content twins point to the extents of their first occurence */
+    i = 0;
+    while ((file = filelist[i++]) != NULL) {
+       if (file->dedup_of == NULL)
+    continue;
+       for (extent = 0; extent < file->nsections; ++extent)
+            file->sections[extent] = file->dedup_of->sections[extent];
+    }
+
     t->curblock += t->filesrc_blocks;
     return ISO_SUCCESS;
 }
@@ -402,21 +648,580 @@ int filesrc_make_md5(Ecma119Image *t, IsoFileSrc *file, char md5[16], int flag)
     return iso_stream_make_md5(file->stream, md5, 0);
 }
 
-/* name must be NULL or offer at least PATH_MAX characters.
-   buffer must be NULL or offer at least BLOCK_SIZE characters.
+
+/* What is known about a data file before it gets copied, for the stability
+   check of md5_file_checksums bit1 and bit2.
 */
-int iso_filesrc_write_data(Ecma119Image *t, IsoFileSrc *file,
-                           char *name, char *buffer, int flag)
+struct iso_filesrc_check {
+    int md5_valid;
+    char md5[16];
+    int stat_valid;
+    struct stat info;
+};
+
+static
+IsoStream *filesrc_get_origin(IsoFileSrc *file)
+{
+    IsoStream *stream, *inp;
+
+    for (stream = file->stream; ; stream = inp) {
+        inp = iso_stream_get_input_stream(stream, 0);
+        if (inp == NULL)
+    break;
+    }
+    return stream;
+}
+
+/* Prepare the stability check before the file gets opened for copying.
+   With bit2 the attributes of the file source get recorded. A pre-computed
+   MD5 is then only needed if the attributes changed during the current
+   second, so that one second timestamps cannot reveal further changes.
+   @return <0 = fatal error, else ok
+*/
+static
+int filesrc_pre_check(Ecma119Image *t, IsoFileSrc *file,
+                      struct iso_filesrc_check *chk)
+{
+    int ret;
+    time_t now;
+
+    chk->md5_valid = 0;
+    chk->stat_valid = 0;
+    if (file->checksum_index <= 0 || !(t->md5_file_checksums & 6))
+        return 1;
+    if (t->md5_file_checksums & 4) {
+        now = time(NULL);
+        ret = iso_stream_get_src_stat(filesrc_get_origin(file),
+                                      &chk->info, 0);
+        if (ret > 0 && chk->info.st_mtime < now && chk->info.st_ctime < now) {
+            chk->stat_valid = 1;
+            return 1;
+        }
+    }
+    chk->md5_valid = filesrc_make_md5(t, file, chk->md5, 0);
+    return chk->md5_valid;
+}
+
+/* Compare the result of filesrc_pre_check() with the situation after
+   copying.
+   @return 1 = content is stable, 0 = content changed
+*/
+static
+int filesrc_post_check(Ecma119Image *t, IsoFileSrc *file,
+                       struct iso_filesrc_check *chk, char md5[16])
+{
+    int ret;
+    struct stat info;
+
+    if (chk->stat_valid) {
+        ret = iso_stream_get_src_stat(filesrc_get_origin(file), &info, 0);
+        if (ret <= 0)
+            return 0;
+        if (info.st_dev != chk->info.st_dev ||
+            info.st_ino != chk->info.st_ino ||
+            info.st_size != chk->info.st_size ||
+            info.st_mtime != chk->info.st_mtime ||
+            info.st_ctime != chk->info.st_ctime)
+            return 0;
+    } else if (chk->md5_valid > 0) {
+        if (! iso_md5_match(md5, chk->md5))
+            return 0;
+    }
+    return 1;
+}
+
+
+/* ------------------------ Read-ahead of file content ------------------- */
+
+/* The number of blocks which a reader thread may buffer ahead of the
+   writer thread for a single data file.
+*/
+#define Libisofs_filesrc_slot_blockS 128
+
+/* The number of blocks which a reader thread reads before it hands them
+   over to the writer thread.
+*/
+#define Libisofs_filesrc_slot_chunK 16
+
+
+/* The read-ahead state of a single data file */
+struct iso_filesrc_slot {
+
+    size_t seq;           /* Index in iso_filesrc_pool.files */
+    IsoFileSrc *file;
+    IsoStream *origin;    /* The end of the filter chain */
+
+    /* 0= unused
+       1= in the hands of a reader thread
+       2= reader thread is done with the file
+       3= to be read by the writer thread itself
+    */
+    int status;
+
+    int opened;           /* Whether open_res and pre are valid */
+    int open_res;
+    struct iso_filesrc_check pre;
+
+    /* Ring of Libisofs_filesrc_slot_blockS blocks */
+    uint8_t *buf;
+
+    uint32_t nblocks;      /* Number of blocks to deliver */
+    uint32_t read_blocks;  /* Number of blocks delivered by the reader */
+    uint32_t taken_blocks; /* Number of blocks released by the writer */
+    int read_res;          /* < 0 if reading ended by an error */
+    int abandoned;         /* Writer thread wants no more content */
+
+    /* Private to the writer thread */
+    uint32_t w_avail;      /* Blocks known to be available */
+    uint32_t w_consumed;   /* Blocks consumed but not released yet */
+};
+
+
+/* A pool of reader threads which work on the next files in image order */
+struct iso_filesrc_pool {
+
+    Ecma119Image *t;
+
+    IsoFileSrc **files;   /* The data files which shall be written */
+    size_t nfiles;
+    size_t next_file;     /* Next file to be assigned to a reader thread */
+    size_t done_files;    /* Number of files completed by the writer */
+
+    int nslots;
+    struct iso_filesrc_slot *slots;
+
+    int nthreads;
+    pthread_t *threads;
+
+    int canceled;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t work;  /* Reader threads wait for file or buffer space */
+    pthread_cond_t data;  /* Writer thread waits for content */
+};
+
+
+/* Only streams which do not share state with other streams may be read
+   outside the writer thread. This excludes files from imported ISO images,
+   which share the IsoDataSource, and external filter processes.
+*/
+static
+int filesrc_is_prefetchable(IsoFileSrc *file)
+{
+    IsoStream *stream;
+    unsigned int fs_id;
+    dev_t dev_id;
+    ino_t ino_id;
+    char *type;
+
+    for (stream = file->stream; stream != NULL;
+         stream = iso_stream_get_input_stream(stream, 0)) {
+        type = stream->class->type;
+        if (strncmp(type, "fsrc", 4) == 0) {
+            iso_stream_get_id(stream, &fs_id, &dev_id, &ino_id);
+            if (fs_id != ISO_LOCAL_FS_ID)
+                return 0;
+        } else if (strncmp(type, "gzip", 4) != 0 &&
+                   strncmp(type, "pizg", 4) != 0 &&
+                   strncmp(type, "ziso", 4) != 0 &&
+                   strncmp(type, "osiz", 4) != 0 &&
+                   strncmp(type, "mem ", 4) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* To be called under lock.
+   Two files in the pool must not operate on the same stream object.
+*/
+static
+int filesrc_pool_origin_busy(struct iso_filesrc_pool *pool,
+                             struct iso_filesrc_slot *slot)
+{
+    int i;
+
+    for (i = 0; i < pool->nslots; i++)
+        if (pool->slots + i != slot && pool->slots[i].status != 0 &&
+            pool->slots[i].origin == slot->origin)
+            return 1;
+    return 0;
+}
+
+/* Performed by a reader thread */
+static
+void filesrc_pool_fill_slot(struct iso_filesrc_pool *pool,
+                            struct iso_filesrc_slot *slot)
+{
+    int res;
+    uint32_t i, n, count;
+    struct iso_filesrc_check pre;
+
+    filesrc_pre_check(pool->t, slot->file, &pre);
+    res = filesrc_open(slot->file);
+
+    pthread_mutex_lock(&pool->mutex);
+    slot->pre = pre;
+    slot->open_res = res;
+    slot->opened = 1;
+    pthread_cond_signal(&pool->data);
+    if (res < 0)
+        goto ex;
+
+    while (slot->read_blocks < slot->nblocks) {
+        while (!(pool->canceled || slot->abandoned) &&
+               slot->read_blocks - slot->taken_blocks >=
+                                                  Libisofs_filesrc_slot_blockS)
+            pthread_cond_wait(&pool->work, &pool->mutex);
+        if (pool->canceled || slot->abandoned)
+    break;
+        count = Libisofs_filesrc_slot_blockS -
+                (slot->read_blocks - slot->taken_blocks);
+        if (count > slot->nblocks - slot->read_blocks)
+            count = slot->nblocks - slot->read_blocks;
+        if (count > Libisofs_filesrc_slot_chunK)
+            count = Libisofs_filesrc_slot_chunK;
+        n = slot->read_blocks;
+        pthread_mutex_unlock(&pool->mutex);
+
+        res = 1;
+        for (i = 0; i < count; i++) {
+            res = filesrc_read(slot->file, (char *) slot->buf +
+                    ((n + i) % Libisofs_filesrc_slot_blockS) * BLOCK_SIZE,
+                    BLOCK_SIZE);
+            if (res < 0)
+        break;
+        }
+
+        pthread_mutex_lock(&pool->mutex);
+        slot->read_blocks += i;
+        pthread_cond_signal(&pool->data);
+        if (res < 0) {
+            slot->read_res = res;
+    break;
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    filesrc_close(slot->file);
+    pthread_mutex_lock(&pool->mutex);
+
+ex:;
+    slot->status = 2;
+    pthread_cond_signal(&pool->data);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+static
+void *filesrc_pool_reader(void *arg)
+{
+    struct iso_filesrc_pool *pool;
+    struct iso_filesrc_slot *slot;
+    IsoFileSrc *file;
+    size_t seq;
+    uint8_t *buf;
+
+    pool = (struct iso_filesrc_pool *) arg;
+    pthread_mutex_lock(&pool->mutex);
+    while (1) {
+        while (!pool->canceled && pool->next_file < pool->nfiles &&
+               pool->next_file >= pool->done_files + pool->nslots)
+            pthread_cond_wait(&pool->work, &pool->mutex);
+        if (pool->canceled || pool->next_file >= pool->nfiles)
+    break;
+        seq = pool->next_file++;
+        file = pool->files[seq];
+        slot = pool->slots + (seq % pool->nslots);
+        slot->seq = seq;
+        slot->file = file;
+        slot->origin = filesrc_get_origin(file);
+        slot->opened = 0;
+        slot->open_res = 0;
+        slot->pre.md5_valid = slot->pre.stat_valid = 0;
+        slot->nblocks = DIV_UP(iso_file_src_get_size(file), BLOCK_SIZE);
+        slot->read_blocks = slot->taken_blocks = 0;
+        slot->read_res = 0;
+        slot->abandoned = 0;
+        slot->w_avail = slot->w_consumed = 0;
+
+        if (slot->buf == NULL) {
+            pthread_mutex_unlock(&pool->mutex);
+            buf = malloc(Libisofs_filesrc_slot_blockS * BLOCK_SIZE);
+            pthread_mutex_lock(&pool->mutex);
+            slot->buf = buf;
+        }
+        if (slot->buf == NULL || !filesrc_is_prefetchable(file) ||
+            filesrc_pool_origin_busy(pool, slot)) {
+            /* Leave it to the writer thread */
+            slot->status = 3;
+            pthread_cond_signal(&pool->data);
+    continue;
+        }
+        slot->status = 1;
+        pthread_mutex_unlock(&pool->mutex);
+
+        filesrc_pool_fill_slot(pool, slot);
+
+        pthread_mutex_lock(&pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+static
+void filesrc_pool_destroy(struct iso_filesrc_pool **pool_handle)
+{
+    struct iso_filesrc_pool *pool;
+    int i;
+
+    pool = *pool_handle;
+    if (pool == NULL)
+        return;
+    pthread_mutex_lock(&pool->mutex);
+    pool->canceled = 1;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->mutex);
+    for (i = 0; i < pool->nthreads; i++)
+        pthread_join(pool->threads[i], NULL);
+    for (i = 0; i < pool->nslots; i++)
+        if (pool->slots[i].buf != NULL)
+            free(pool->slots[i].buf);
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->work);
+    pthread_cond_destroy(&pool->data);
+    if (pool->slots != NULL)
+        free(pool->slots);
+    if (pool->threads != NULL)
+        free(pool->threads);
+    if (pool->files != NULL)
+        free(pool->files);
+    free(pool);
+    *pool_handle = NULL;
+}
+
+/* @return 1= pool is running, 0= no files to read ahead, <0 = error
+*/
+static
+int filesrc_pool_new(Ecma119Image *t, IsoFileSrc **filelist,
+                     struct iso_filesrc_pool **pool_handle)
+{
+    struct iso_filesrc_pool *pool;
+    size_t i, n;
+    int ret;
+
+    *pool_handle = NULL;
+    for (n = 0, i = 0; filelist[i] != NULL; i++)
+        if (!filelist[i]->no_write)
+            n++;
+    if (n == 0)
+        return 0;
+
+    pool = calloc(1, sizeof(struct iso_filesrc_pool));
+    if (pool == NULL)
+        return ISO_OUT_OF_MEM;
+    pool->t = t;
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->data, NULL);
+
+    pool->files = calloc(n, sizeof(IsoFileSrc *));
+    if (pool->files == NULL)
+        {ret = ISO_OUT_OF_MEM; goto ex;}
+    for (n = 0, i = 0; filelist[i] != NULL; i++)
+        if (!filelist[i]->no_write)
+            pool->files[n++] = filelist[i];
+    pool->nfiles = n;
+
+    pool->nslots = t->file_prefetch;
+    if (pool->nslots < t->file_readers)
+        pool->nslots = t->file_readers;
+    if ((size_t) pool->nslots > n)
+        pool->nslots = n;
+    pool->slots = calloc(pool->nslots, sizeof(struct iso_filesrc_slot));
+    if (pool->slots == NULL)
+        {ret = ISO_OUT_OF_MEM; goto ex;}
+
+    n = t->file_readers;
+    if (n > (size_t) pool->nslots)
+        n = pool->nslots;
+    pool->threads = calloc(n, sizeof(pthread_t));
+    if (pool->threads == NULL)
+        {ret = ISO_OUT_OF_MEM; goto ex;}
+    for (i = 0; i < n; i++) {
+        ret = pthread_create(&(pool->threads[i]), NULL,
+                             filesrc_pool_reader, (void *) pool);
+        if (ret != 0) {
+            iso_msg_submit(t->image->id, ISO_THREAD_ERROR, 0,
+                           "Cannot create file reader thread");
+            ret = ISO_THREAD_ERROR;
+            goto ex;
+        }
+        pool->nthreads++;
+    }
+    *pool_handle = pool;
+    ret = 1;
+ex:;
+    if (ret < 0)
+        filesrc_pool_destroy(&pool);
+    return ret;
+}
+
+/* Wait until the file with index seq is assigned.
+   @return The slot, or NULL if the writer thread shall read the file itself
+*/
+static
+struct iso_filesrc_slot *filesrc_pool_get_slot(struct iso_filesrc_pool *pool,
+                                               size_t seq)
+{
+    struct iso_filesrc_slot *slot;
+
+    slot = pool->slots + (seq % pool->nslots);
+    pthread_mutex_lock(&pool->mutex);
+    while (slot->status == 0 || slot->seq != seq)
+        pthread_cond_wait(&pool->data, &pool->mutex);
+    pthread_mutex_unlock(&pool->mutex);
+    if (slot->status == 3)
+        return NULL;
+    return slot;
+}
+
+/* Give the slot of file seq back to the reader threads */
+static
+void filesrc_pool_release_slot(struct iso_filesrc_pool *pool, size_t seq)
+{
+    struct iso_filesrc_slot *slot;
+
+    slot = pool->slots + (seq % pool->nslots);
+    pthread_mutex_lock(&pool->mutex);
+    slot->taken_blocks += slot->w_consumed;
+    slot->w_consumed = 0;
+    slot->abandoned = 1;
+    pthread_cond_broadcast(&pool->work);
+    while (slot->status == 1)
+        pthread_cond_wait(&pool->data, &pool->mutex);
+    slot->status = 0;
+    slot->file = NULL;
+    slot->origin = NULL;
+    pool->done_files++;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+static
+void filesrc_pool_wait_open(struct iso_filesrc_pool *pool,
+                            struct iso_filesrc_slot *slot)
+{
+    pthread_mutex_lock(&pool->mutex);
+    while (!slot->opened && slot->status == 1)
+        pthread_cond_wait(&pool->data, &pool->mutex);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+/* Lend the writer thread the next contiguous run of read-ahead blocks.
+   The blocks stay valid until the next call or the release of the slot.
+   @return 1= ok, <0 = read error
+*/
+static
+int filesrc_pool_fetch(struct iso_filesrc_pool *pool,
+                       struct iso_filesrc_slot *slot, uint32_t max_blocks,
+                       char **data, uint32_t *count)
+{
+    int res = ISO_FILE_READ_ERROR;
+    uint32_t pos, n;
+
+    *count = 0;
+    if (slot->w_avail == 0 ||
+        slot->w_consumed >= Libisofs_filesrc_slot_blockS / 2) {
+        pthread_mutex_lock(&pool->mutex);
+        slot->taken_blocks += slot->w_consumed;
+        slot->w_consumed = 0;
+        pthread_cond_broadcast(&pool->work);
+        while (slot->w_avail == 0 &&
+               slot->read_blocks == slot->taken_blocks && slot->status == 1)
+            pthread_cond_wait(&pool->data, &pool->mutex);
+        slot->w_avail = slot->read_blocks - slot->taken_blocks;
+        if (slot->read_res < 0)
+            res = slot->read_res;
+        pthread_mutex_unlock(&pool->mutex);
+        if (slot->w_avail == 0)
+            return res;
+    }
+    pos = (slot->taken_blocks + slot->w_consumed) %
+          Libisofs_filesrc_slot_blockS;
+    n = slot->w_avail;
+    if (n > Libisofs_filesrc_slot_blockS - pos)
+        n = Libisofs_filesrc_slot_blockS - pos;
+    if (n > max_blocks)
+        n = max_blocks;
+    *data = (char *) slot->buf + pos * BLOCK_SIZE;
+    *count = n;
+    slot->w_avail -= n;
+    slot->w_consumed += n;
+    return 1;
+}
+
+
+/* ------------------------------------------------------------------------ */
+
+
+/* The number of blocks which get read, checksummed and written in one step
+   if the writer thread reads the file content itself. 512 blocks = 1 MiB.
+*/
+#define Libisofs_filesrc_bulk_blockS 512
+
+
+/* Write blocks of file content and add them to the file checksum.
+   b is the index of the first block in the file.
+*/
+static
+int filesrc_write_blocks(Ecma119Image *t, IsoFileSrc *file, void *ctx,
+                         off_t file_size, size_t b, char *data,
+                         uint32_t count)
+{
+    int ret;
+    off_t len = 0;
+
+    if (file->checksum_index > 0) {
+        /* Add to file checksum while writing */
+        if (ctx == NULL) {
+            file->checksum_index = 0;
+        } else {
+            len = file_size - (off_t) b * BLOCK_SIZE;
+            if (len > (off_t) count * BLOCK_SIZE)
+                len = (off_t) count * BLOCK_SIZE;
+            if (len < 0)
+                len = 0;
+        }
+    }
+    ret = iso_write_md5(t, data, (size_t) count * BLOCK_SIZE,
+                        len > 0 ? ctx : NULL, (size_t) len);
+    if (ret < 0)
+        return ret;
+    return ISO_SUCCESS;
+}
+
+
+/* If slot is not NULL then the content gets taken from the read-ahead pool.
+   Else the file gets opened and read by the calling thread.
+   buffer must offer at least buf_blocks * BLOCK_SIZE bytes. It determines
+   how many blocks get transferred in one step.
+*/
+static
+int filesrc_write_data(Ecma119Image *t, IsoFileSrc *file,
+                       struct iso_filesrc_pool *pool,
+                       struct iso_filesrc_slot *slot,
+                       char *name, char *buffer, uint32_t buf_blocks)
 {
     int res, ret, was_error;
     char *name_data = NULL;
     char *buffer_data = NULL;
-    size_t b;
+    char *data;
+    size_t b, got;
+    uint32_t count;
     off_t file_size;
     uint32_t nblocks;
     void *ctx= NULL;
-    char md5[16], pre_md5[16];
-    int pre_md5_valid = 0;
+    char md5[16];
+    struct iso_filesrc_check pre;
     IsoStream *stream, *inp;
 
 #ifdef Libisofs_with_libjtE
@@ -428,19 +1233,26 @@ int iso_filesrc_write_data(Ecma119Image *t, IsoFileSrc *file,
         name = name_data;
     }
     if (buffer == NULL) {
-        LIBISO_ALLOC_MEM(buffer_data, char, BLOCK_SIZE);
+        buf_blocks = Libisofs_filesrc_bulk_blockS;
+        LIBISO_ALLOC_MEM(buffer_data, char, buf_blocks * BLOCK_SIZE);
         buffer = buffer_data;
     }
+    if (buf_blocks < 1)
+        buf_blocks = 1;
 
     was_error = 0;
     file_size = iso_file_src_get_size(file);
     nblocks = DIV_UP(file_size, BLOCK_SIZE);
-    pre_md5_valid = 0; 
-    if (file->checksum_index > 0 && (t->md5_file_checksums & 2)) {
-        /* Obtain an MD5 of content by a first read pass */
-        pre_md5_valid = filesrc_make_md5(t, file, pre_md5, 0);
+    pre.md5_valid = pre.stat_valid = 0;
+    if (slot != NULL) {
+        filesrc_pool_wait_open(pool, slot);
+        pre = slot->pre;
+        res = slot->open_res;
+    } else {
+        /* Record attributes or obtain an MD5 of content by a first read */
+        filesrc_pre_check(t, file, &pre);
+        res = filesrc_open(file);
     }
-    res = filesrc_open(file);
 
     /* Get file name from end of filter chain */
     for (stream = file->stream; ; stream = inp) {
@@ -462,9 +1274,12 @@ int iso_filesrc_write_data(Ecma119Image *t, IsoFileSrc *file,
             ret = res; /* aborted due to error severity */
             goto ex;
         }
-        memset(buffer, 0, BLOCK_SIZE);
-        for (b = 0; b < nblocks; ++b) {
-            res = iso_write(t, buffer, BLOCK_SIZE);
+        memset(buffer, 0, buf_blocks * BLOCK_SIZE);
+        for (b = 0; b < nblocks; b += count) {
+            count = nblocks - b;
+            if (count > buf_blocks)
+                count = buf_blocks;
+            res = iso_write(t, buffer, (size_t) count * BLOCK_SIZE);
             if (res < 0) {
                 /* ko, writer error, we need to go out! */
                 ret = res;
@@ -480,7 +1295,8 @@ int iso_filesrc_write_data(Ecma119Image *t, IsoFileSrc *file,
                   "Size of file \"%s\" has changed. It will be %s", name,
                   (res == 2 ? "truncated" : "padded with 0's"));
         if (res < 0) {
-            filesrc_close(file);
+            if (slot == NULL)
+                filesrc_close(file);
             ret = res; /* aborted due to error severity */
             goto ex;
         }
@@ -501,7 +1317,8 @@ int iso_filesrc_write_data(Ecma119Image *t, IsoFileSrc *file,
             res = iso_libjte_forward_msgs(t->libjte_handle, t->image->id,
                                     ISO_LIBJTE_FILE_FAILED, 0);
             if (res < 0) {
-                filesrc_close(file);
+                if (slot == NULL)
+                    filesrc_close(file);
                 ret = ISO_LIBJTE_FILE_FAILED;
                 goto ex;
             }
@@ -517,33 +1334,41 @@ int iso_filesrc_write_data(Ecma119Image *t, IsoFileSrc *file,
             file->checksum_index = 0;
     }
     /* write file contents to image */
-    for (b = 0; b < nblocks; ++b) {
-        int wres;
-        res = filesrc_read(file, buffer, BLOCK_SIZE);
+    res = 1;
+    for (b = 0; b < nblocks; b += count) {
+        count = nblocks - b;
+        if (count > buf_blocks)
+            count = buf_blocks;
+        if (slot != NULL) {
+            res = filesrc_pool_fetch(pool, slot, count, &data, &count);
+        } else {
+            data = buffer;
+            res = iso_stream_read_buffer(file->stream, buffer,
+                                         (size_t) count * BLOCK_SIZE, &got);
+            if (res < 0) {
+                /* Only the complete blocks before the error are valid */
+                count = got / BLOCK_SIZE;
+            }
+        }
+        if (count > 0) {
+            ret = filesrc_write_blocks(t, file, ctx, file_size, b,
+                                       data, count);
+            if (ret < 0) {
+                /* ko, writer error, we need to go out! */
+                if (slot == NULL)
+                    filesrc_close(file);
+                goto ex;
+            }
+        }
         if (res < 0) {
             /* read error */
+            b += count;
             break;
         }
-        wres = iso_write(t, buffer, BLOCK_SIZE);
-        if (wres < 0) {
-            /* ko, writer error, we need to go out! */
-            filesrc_close(file);
-            ret = wres;
-            goto ex;
-        }
-        if (file->checksum_index > 0) {
-            /* Add to file checksum */
-            if (file_size - b * BLOCK_SIZE > BLOCK_SIZE)
-                res = BLOCK_SIZE;
-            else
-                res = file_size - b * BLOCK_SIZE;
-            res = iso_md5_compute(ctx, buffer, res);
-            if (res <= 0)
-                file->checksum_index = 0;
-        }
     }
 
-    filesrc_close(file);
+    if (slot == NULL)
+        filesrc_close(file);
 
     if (b < nblocks) {
         /* premature end of file, due to error or eof */
@@ -567,24 +1392,17 @@ int iso_filesrc_write_data(Ecma119Image *t, IsoFileSrc *file,
         /* fill with 0s */
         iso_msg_submit(t->image->id, ISO_FILE_CANT_WRITE, 0,
                        "Filling with 0");
-        memset(buffer, 0, BLOCK_SIZE);
-        while (b++ < nblocks) {
-            res = iso_write(t, buffer, BLOCK_SIZE);
-            if (res < 0) {
+        memset(buffer, 0, buf_blocks * BLOCK_SIZE);
+        for (; b < nblocks; b += count) {
+            count = nblocks - b;
+            if (count > buf_blocks)
+                count = buf_blocks;
+            ret = filesrc_write_blocks(t, file, ctx, file_size, b,
+                                       buffer, count);
+            if (ret < 0) {
                 /* ko, writer error, we need to go out! */
-                ret = res;
                 goto ex;
             }
-            if (file->checksum_index > 0) {
-                /* Add to file checksum */
-                if (file_size - b * BLOCK_SIZE > BLOCK_SIZE)
-                    res = BLOCK_SIZE;
-                else
-                    res = file_size - b * BLOCK_SIZE;
-                res = iso_md5_compute(ctx, buffer, res);
-                if (res <= 0)
-                    file->checksum_index = 0;
-            }
         }
     }
     if (file->checksum_index > 0 &&
@@ -593,9 +1411,9 @@ int iso_filesrc_write_data(Ecma119Image *t, IsoFileSrc *file,
         res = iso_md5_end(&ctx, md5);
         if (res <= 0)
             file->checksum_index = 0;
-        if ((t->md5_file_checksums & 2) && pre_md5_valid > 0 &&
-            !was_error) {
-            if (! iso_md5_match(md5, pre_md5)) {
+        if ((t->md5_file_checksums & 6) &&
+            (pre.md5_valid > 0 || pre.stat_valid) && !was_error) {
+            if (! filesrc_post_check(t, file, &pre, md5)) {
                 /* Issue MISHAP event */
                 iso_report_errfile(name, ISO_MD5_STREAM_CHANGE, 0, 0);
                 was_error = 1;
@@ -632,23 +1450,34 @@ ex:;
     return ret;
 }
 
+/* name must be NULL or offer at least PATH_MAX characters.
+   buffer must be NULL or offer at least BLOCK_SIZE characters.
+*/
+int iso_filesrc_write_data(Ecma119Image *t, IsoFileSrc *file,
+                           char *name, char *buffer, int flag)
+{
+    return filesrc_write_data(t, file, NULL, NULL, name, buffer, 1);
+}
+
 static
 int filesrc_writer_write_data(IsoImageWriter *writer)
 {
     int ret;
-    size_t i;
+    size_t i, seq;
     Ecma119Image *t = NULL;
     IsoFileSrc *file;
     IsoFileSrc **filelist;
     char *name = NULL;
     char *buffer = NULL;
+    struct iso_filesrc_pool *pool = NULL;
+    struct iso_filesrc_slot *slot;
 
     if (writer == NULL) {
         ret = ISO_ASSERT_FAILURE; goto ex;
     }
 
     LIBISO_ALLOC_MEM(name, char, PATH_MAX);
-    LIBISO_ALLOC_MEM(buffer, char, BLOCK_SIZE);
+    LIBISO_ALLOC_MEM(buffer, char, Libisofs_filesrc_bulk_blockS * BLOCK_SIZE);
     t = writer->target;
     filelist = writer->data;
 
@@ -664,7 +1493,14 @@ int filesrc_writer_write_data(IsoImageWriter *writer)
             goto ex;
     }
 
+    if (t->file_readers > 0) {
+        ret = filesrc_pool_new(t, filelist, &pool);
+        if (ret < 0)
+            goto ex;
+    }
+
     i = 0;
+    seq = 0;
     while ((file = filelist[i++]) != NULL) {
         if (file->no_write) {
             /* Do not write external partitions */
@@ -675,13 +1511,34 @@ int filesrc_writer_write_data(IsoImageWriter *writer)
                                 (file->sections[0].size + 2047) / BLOCK_SIZE));
     continue;
         }
-        ret = iso_filesrc_write_data(t, file, name, buffer, 0);
+        if (pool != NULL) {
+            slot = filesrc_pool_get_slot(pool, seq);
+            ret = filesrc_write_data(t, file, pool, slot, name, buffer,
+                                     Libisofs_filesrc_bulk_blockS);
+            filesrc_pool_release_slot(pool, seq);
+            seq++;
+        } else {
+            ret = filesrc_write_data(t, file, NULL, NULL, name, buffer,
+                                     Libisofs_filesrc_bulk_blockS);
+        }
         if (ret < 0)
             goto ex;
     }
 
+    /* Content twins inherit the MD5 of the file which was written */
+    i = 0;
+    while ((file = filelist[i++]) != NULL) {
+        if (file->dedup_of == NULL || file->checksum_index <= 0)
+    continue;
+        if (file->dedup_of->checksum_index > 0)
+            memcpy(t->checksum_buffer + 16 * file->checksum_index,
+                   t->checksum_buffer + 16 * file->dedup_of->checksum_index,
+                   16);
+    }
+
     ret = ISO_SUCCESS;
 ex:;
+    filesrc_pool_destroy(&pool);
     LIBISO_FREE_MEM(buffer);
     LIBISO_FREE_MEM(name);
     return ret;
@@ -34,6 +34,13 @@ struct Iso_File_Src
 
     unsigned int checksum_index :31;
 
+    /* If not NULL, then this IsoFileSrc has the same content as the
+       one pointed to. It is marked as .no_write and gets the sections
+       of the other one in filesrc_writer_compute_data_blocks().
+       See iso_write_opts_set_dedup_content().
+    */
+    IsoFileSrc *dedup_of;
+
     /** File Sections of the file in the image */
     /* Special sections[0].block values while they are relative
        before filesrc_writer_compute_data_blocks().
@@ -16,6 +16,12 @@
 #include "filter.h"
 #include "node.h"
 
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
 
 void iso_filter_ref(FilterContext *filter)
 {
@@ -69,3 +75,295 @@ int iso_file_remove_filter(IsoFile *file, int flag)
     return 1;
 }
 
+
+
+/* --------------------------- IsoFilterSpill ---------------------------- */
+
+/* Size of the memory pieces which hold kept filter output */
+#define Libisofs_spill_chunK (64 * 1024)
+
+struct iso_filter_spill_chunk {
+    char *mem;        /* NULL if the bytes are stored in the spill file */
+    off_t file_pos;
+    size_t size;
+    struct iso_filter_spill_chunk *next;
+};
+
+struct iso_filter_spill {
+    struct iso_filter_spill_chunk *first;
+    struct iso_filter_spill_chunk *last;
+    int on_disk;      /* Whether counted in spill_disk_users */
+    int failed;
+
+    /* Read position */
+    struct iso_filter_spill_chunk *rchunk;
+    size_t roffset;
+};
+
+/* The global budget and the temporary file are shared by all spill objects.
+   Filter streams may get read by the file reader threads of the image
+   writer. So the shared state is protected by a mutex.
+*/
+static pthread_mutex_t spill_mutex = PTHREAD_MUTEX_INITIALIZER;
+static off_t spill_mem_limit = 0;
+static off_t spill_disk_limit = 0;
+static char *spill_tmp_dir = NULL;
+static off_t spill_mem_used = 0;
+static off_t spill_disk_used = 0;  /* Current end of the spill file */
+static int spill_disk_users = 0;   /* Spill objects with bytes in the file */
+static int spill_fd = -1;
+
+
+/* API */
+int iso_filter_set_spill_params(off_t mem_limit, off_t disk_limit,
+                                char *tmp_dir, int flag)
+{
+    char *dir = NULL;
+
+    if (mem_limit < 0 || disk_limit < 0)
+        return ISO_WRONG_ARG_VALUE;
+    if (tmp_dir != NULL) {
+        dir = strdup(tmp_dir);
+        if (dir == NULL)
+            return ISO_OUT_OF_MEM;
+    }
+    pthread_mutex_lock(&spill_mutex);
+    spill_mem_limit = mem_limit;
+    spill_disk_limit = disk_limit;
+    if (spill_tmp_dir != NULL)
+        free(spill_tmp_dir);
+    spill_tmp_dir = dir;
+    pthread_mutex_unlock(&spill_mutex);
+    return ISO_SUCCESS;
+}
+
+
+/* API */
+int iso_filter_get_spill_params(off_t *mem_limit, off_t *disk_limit,
+                                off_t *mem_used, off_t *disk_used, int flag)
+{
+    pthread_mutex_lock(&spill_mutex);
+    *mem_limit = spill_mem_limit;
+    *disk_limit = spill_disk_limit;
+    *mem_used = spill_mem_used;
+    *disk_used = spill_disk_used;
+    pthread_mutex_unlock(&spill_mutex);
+    return ISO_SUCCESS;
+}
+
+
+/* To be called with spill_mutex locked */
+static
+int iso_filter_spill_open_file(void)
+{
+    char *dir, *path;
+    int fd;
+
+    if (spill_fd != -1)
+        return 1;
+    dir = spill_tmp_dir;
+    if (dir == NULL)
+        dir = getenv("TMPDIR");
+    if (dir == NULL || dir[0] == 0)
+        dir = "/tmp";
+    path = calloc(1, strlen(dir) + 30);
+    if (path == NULL)
+        return 0;
+    sprintf(path, "%s/libisofs_spill_XXXXXX", dir);
+    fd = mkstemp(path);
+    if (fd == -1) {
+        free(path);
+        return 0;
+    }
+    /* The file shall vanish with its last file descriptor */
+    unlink(path);
+    free(path);
+    spill_fd = fd;
+    spill_disk_used = 0;
+    return 1;
+}
+
+
+int iso_filter_spill_new(IsoFilterSpill **spill, int flag)
+{
+    int enabled;
+
+    *spill = NULL;
+    pthread_mutex_lock(&spill_mutex);
+    enabled = (spill_mem_limit > 0 || spill_disk_limit > 0);
+    pthread_mutex_unlock(&spill_mutex);
+    if (!enabled)
+        return 0;
+    *spill = calloc(1, sizeof(IsoFilterSpill));
+    if (*spill == NULL)
+        return ISO_OUT_OF_MEM;
+    return ISO_SUCCESS;
+}
+
+
+/* Get a new chunk with room for at least count bytes.
+   Memory is preferred. Chunks in the spill file get their range reserved.
+*/
+static
+int iso_filter_spill_add_chunk(IsoFilterSpill *spill, size_t count)
+{
+    struct iso_filter_spill_chunk *chunk;
+    int use_mem = 0, use_disk = 0;
+
+    chunk = calloc(1, sizeof(struct iso_filter_spill_chunk));
+    if (chunk == NULL)
+        return 0;
+
+    pthread_mutex_lock(&spill_mutex);
+    if (count <= Libisofs_spill_chunK &&
+        spill_mem_used + Libisofs_spill_chunK <= spill_mem_limit) {
+        spill_mem_used += Libisofs_spill_chunK;
+        use_mem = 1;
+    } else if (spill_disk_used + (off_t) count <= spill_disk_limit &&
+               iso_filter_spill_open_file()) {
+        chunk->file_pos = spill_disk_used;
+        spill_disk_used += count;
+        if (!spill->on_disk) {
+            spill->on_disk = 1;
+            spill_disk_users++;
+        }
+        use_disk = 1;
+    }
+    pthread_mutex_unlock(&spill_mutex);
+
+    if (use_mem) {
+        chunk->mem = malloc(Libisofs_spill_chunK);
+        if (chunk->mem == NULL) {
+            pthread_mutex_lock(&spill_mutex);
+            spill_mem_used -= Libisofs_spill_chunK;
+            pthread_mutex_unlock(&spill_mutex);
+            use_mem = 0;
+        }
+    }
+    if (!(use_mem || use_disk)) {
+        free(chunk);
+        return 0;
+    }
+    if (spill->last == NULL)
+        spill->first = chunk;
+    else
+        spill->last->next = chunk;
+    spill->last = chunk;
+    return 1;
+}
+
+
+int iso_filter_spill_write(IsoFilterSpill *spill, char *buf, size_t count)
+{
+    struct iso_filter_spill_chunk *chunk;
+    size_t todo;
+    ssize_t ret;
+
+    if (spill->failed)
+        return 0;
+    while (count > 0) {
+        chunk = spill->last;
+        if (chunk == NULL || chunk->mem == NULL ||
+            chunk->size >= Libisofs_spill_chunK) {
+            if (!iso_filter_spill_add_chunk(spill, count))
+                goto failed;
+            chunk = spill->last;
+        }
+        if (chunk->mem != NULL) {
+            todo = Libisofs_spill_chunK - chunk->size;
+            if (todo > count)
+                todo = count;
+            memcpy(chunk->mem + chunk->size, buf, todo);
+        } else {
+            /* The range of count bytes is reserved */
+            todo = count;
+            ret = pwrite(spill_fd, buf, todo, chunk->file_pos);
+            if (ret != (ssize_t) todo)
+                goto failed;
+        }
+        chunk->size += todo;
+        buf += todo;
+        count -= todo;
+    }
+    return 1;
+failed:;
+    spill->failed = 1;
+    return 0;
+}
+
+
+int iso_filter_spill_read(IsoFilterSpill *spill, char *buf, size_t desired)
+{
+    struct iso_filter_spill_chunk *chunk;
+    size_t fill = 0, todo;
+    ssize_t ret;
+
+    if (spill->failed)
+        return ISO_FILE_READ_ERROR;
+    while (fill < desired) {
+        chunk = spill->rchunk;
+        if (chunk == NULL)
+    break;
+        if (spill->roffset >= chunk->size) {
+            spill->rchunk = chunk->next;
+            spill->roffset = 0;
+    continue;
+        }
+        todo = chunk->size - spill->roffset;
+        if (todo > desired - fill)
+            todo = desired - fill;
+        if (chunk->mem != NULL) {
+            memcpy(buf + fill, chunk->mem + spill->roffset, todo);
+        } else {
+            ret = pread(spill_fd, buf + fill, todo,
+                        chunk->file_pos + spill->roffset);
+            if (ret != (ssize_t) todo)
+                return ISO_FILE_READ_ERROR;
+        }
+        fill += todo;
+        spill->roffset += todo;
+    }
+    return fill;
+}
+
+
+void iso_filter_spill_rewind(IsoFilterSpill *spill)
+{
+    spill->rchunk = spill->first;
+    spill->roffset = 0;
+}
+
+
+void iso_filter_spill_destroy(IsoFilterSpill **spill)
+{
+    struct iso_filter_spill_chunk *chunk, *next;
+    off_t mem_count = 0;
+
+    if (*spill == NULL)
+        return;
+    for (chunk = (*spill)->first; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        if (chunk->mem != NULL) {
+            free(chunk->mem);
+            mem_count += Libisofs_spill_chunK;
+        }
+        free(chunk);
+    }
+
+    pthread_mutex_lock(&spill_mutex);
+    spill_mem_used -= mem_count;
+    if ((*spill)->on_disk) {
+        /* The file only grows. It gets emptied when nobody uses it. */
+        spill_disk_users--;
+        if (spill_disk_users <= 0 && spill_fd != -1) {
+            close(spill_fd);
+            spill_fd = -1;
+            spill_disk_used = 0;
+            spill_disk_users = 0;
+        }
+    }
+    pthread_mutex_unlock(&spill_mutex);
+
+    free(*spill);
+    *spill = NULL;
+}
@@ -73,4 +73,54 @@ int iso_file_add_filter(IsoFile *file, FilterContext *filter, int flag);
 void iso_filter_ref(FilterContext *filter);
 void iso_filter_unref(FilterContext *filter);
 
+/**
+ * End the threads of the zisofs compression pool. To be called by
+ * iso_finish(). Implemented in filters/zisofs.c.
+ */
+void ziso_pool_dispose(int flag);
+
+
+/*
+ * Storage for the output of a filter stream. It gets filled by the run
+ * of .get_size() and replayed by the next run of .read() up to EOF.
+ * See iso_filter_set_spill_params().
+ */
+typedef struct iso_filter_spill IsoFilterSpill;
+
+/**
+ * Create an empty spill object.
+ *
+ * @return
+ *      1 success, 0 if keeping of output is disabled (*spill is NULL),
+ *      < 0 error
+ */
+int iso_filter_spill_new(IsoFilterSpill **spill, int flag);
+
+/**
+ * Append bytes to the end of the stored output.
+ *
+ * @return
+ *      1 success, 0 if the budget is exhausted or storing failed otherwise.
+ *      In this case the spill object is unusable and should be destroyed.
+ */
+int iso_filter_spill_write(IsoFilterSpill *spill, char *buf, size_t count);
+
+/**
+ * Read the next bytes of the stored output.
+ *
+ * @return
+ *      number of bytes, 0 at EOF, < 0 error
+ */
+int iso_filter_spill_read(IsoFilterSpill *spill, char *buf, size_t desired);
+
+/**
+ * Let the next iso_filter_spill_read() start at the first byte.
+ */
+void iso_filter_spill_rewind(IsoFilterSpill *spill);
+
+/**
+ * Release the stored output and the spill object. *spill becomes NULL.
+ */
+void iso_filter_spill_destroy(IsoFilterSpill **spill);
+
 #endif /*LIBISO_FILTER_H_*/
@@ -56,6 +56,7 @@ typedef struct
     int out_eof;
     uint8_t pipebuf[2048]; /* buffers in case of EAGAIN on write() */
     int pipebuf_fill;
+    int replay; /* output comes from the spill of the stream, no process */
 } ExternalFilterRuntime;
 
 
@@ -77,6 +78,7 @@ int extf_running_new(ExternalFilterRuntime **running, int send_fd, int recv_fd,
     o->out_eof = 0;
     memset(o->pipebuf, 0, sizeof(o->pipebuf));
     o->pipebuf_fill = 0;
+    o->replay = 0;
     return 1;
 }
 
@@ -96,6 +98,8 @@ typedef struct
 
     ExternalFilterRuntime *running; /* is non-NULL when open */
 
+    IsoFilterSpill *spill; /* kept output of .get_size(), or NULL */
+
 } ExternalFilterStreamData;
 
 
@@ -132,6 +136,12 @@ int extf_stream_close_flag(IsoStream *stream, int flag)
     if (data->running == NULL) {
         return 1;
     }
+    if (data->running->replay) {
+        /* Neither the filter process nor the original stream exist */
+        free(data->running);
+        data->running = NULL;
+        return 1;
+    }
 
     /* <<< */
     if (print_fd) {
@@ -192,6 +202,16 @@ int extf_stream_open_flag(IsoStream *stream, int flag)
       */
       stream->class->get_size(stream);
     }
+    if (data->spill != NULL) {
+        /* Deliver the output which was kept by the size determination run */
+        ret = extf_running_new(&running, -1, -1, 0, 0);
+        if (ret < 0)
+            return ret;
+        running->replay = 1;
+        data->running = running;
+        iso_filter_spill_rewind(data->spill);
+        return 1;
+    }
 
     ret = pipe(send_pipe);
     if (ret == -1) {
@@ -401,6 +421,19 @@ int extf_stream_read(IsoStream *stream, void *buf, size_t desired)
     if (running->out_eof) {
         return 0;
     }
+    if (running->replay) {
+        ret = 0;
+        if (data->spill != NULL)
+            ret = iso_filter_spill_read(data->spill, buf, desired);
+        if (ret > 0) {
+            running->out_counter += ret;
+        } else if (ret == 0) {
+            /* Replayed once. Further runs will start the filter again. */
+            running->out_eof = 1;
+            iso_filter_spill_destroy(&(data->spill));
+        }
+        return ret;
+    }
 
     while (1) {
         if (running->in_eof && !blocking) {
@@ -505,6 +538,7 @@ off_t extf_stream_get_size(IsoStream *stream)
     int ret, ret_close;
     off_t count = 0;
     ExternalFilterStreamData *data;
+    IsoFilterSpill *spill = NULL;
     char buf[64 * 1024];
     size_t bufsize = 64 * 1024;
 
@@ -522,18 +556,25 @@ off_t extf_stream_get_size(IsoStream *stream)
     if (ret < 0) {
         return ret;
     }
+    /* Keep the output for the next read run, if enabled and possible */
+    iso_filter_spill_new(&spill, 0);
     while (1) {
         ret = extf_stream_read(stream, buf, bufsize);
         if (ret <= 0)
             break;
         count += ret;
+        if (spill != NULL && !iso_filter_spill_write(spill, buf, ret))
+            iso_filter_spill_destroy(&spill);
     }
     ret_close = extf_stream_close(stream);
+    if (ret < 0 || ret_close < 0)
+        iso_filter_spill_destroy(&spill);
     if (ret < 0)
         return ret;
     if (ret_close < 0)
         return ret_close;
 
+    data->spill = spill;
     data->size = count;
     return count;
 }
@@ -572,6 +613,7 @@ void extf_stream_free(IsoStream *stream)
     if (data->running != NULL) {
         extf_stream_close(stream);
     }
+    iso_filter_spill_destroy(&(data->spill));
     iso_stream_unref(data->orig);
     if (data->cmd->refcount > 0)
         data->cmd->refcount--;
@@ -625,6 +667,7 @@ int extf_clone_stream(IsoStream *old_stream, IsoStream **new_stream, int flag)
     stream_data->cmd->refcount++;
     stream_data->size = old_stream_data->size;
     stream_data->running = NULL;
+    stream_data->spill = NULL;
     stream->data = stream_data;
     *new_stream = stream;
     return ISO_SUCCESS;
@@ -713,6 +756,7 @@ int extf_filter_get_filter(FilterContext *filter, IsoStream *original,
     data->cmd = cmd;
     data->size = -1;
     data->running = NULL;
+    data->spill = NULL;
 
     /* get reference to the source */
     iso_stream_ref(data->orig);
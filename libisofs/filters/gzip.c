@@ -74,6 +74,8 @@ typedef struct
 
     int error_ret;
 
+    int replay; /* output comes from the spill of the stream, not from zlib */
+
 } GzipFilterRuntime;
 
 #ifdef Libisofs_with_zliB
@@ -113,6 +115,7 @@ int gzip_running_new(GzipFilterRuntime **running, int flag)
     o->out_counter = 0;
     o->do_flush = Z_NO_FLUSH;
     o->error_ret = 1;
+    o->replay = 0;
 
     o->in_buffer_size= 2048;
     o->out_buffer_size= 2048;
@@ -165,6 +168,8 @@ typedef struct
 
     ino_t id;
 
+    IsoFilterSpill *spill; /* kept output of .get_size(), or NULL */
+
 } GzipFilterStreamData;
 
 
@@ -207,6 +212,11 @@ int gzip_stream_close_flag(IsoStream *stream, int flag)
     if (data->running == NULL) {
         return 1;
     }
+    if (data->running->replay) {
+        /* Neither zlib nor the original stream were opened */
+        gzip_running_destroy(&(data->running), 0);
+        return 1;
+    }
     if (stream->class->read == &gzip_stream_uncompress) {
         inflateEnd(&(data->running->strm));
     } else {
@@ -269,6 +279,13 @@ int gzip_stream_open_flag(IsoStream *stream, int flag)
     }
     data->running = running;
 
+    if (data->spill != NULL) {
+        /* Deliver the output which was kept by the size determination run */
+        running->replay = 1;
+        iso_filter_spill_rewind(data->spill);
+        return 1;
+    }
+
     /* Start up zlib compression context */
     strm = &(running->strm);
     strm->zalloc = Z_NULL;
@@ -332,6 +349,17 @@ int gzip_stream_convert(IsoStream *stream, void *buf, size_t desired, int flag)
     if (rng == NULL) {
         return ISO_FILE_NOT_OPENED;
     }
+    if (rng->replay) {
+        if (data->spill == NULL)
+            return 0;
+        ret = iso_filter_spill_read(data->spill, buf, desired);
+        if (ret > 0)
+            rng->out_counter += ret;
+        else if (ret == 0)
+            /* Replayed once. Further runs will compress again. */
+            iso_filter_spill_destroy(&(data->spill));
+        return ret;
+    }
     strm = &(rng->strm);
     if (rng->error_ret < 0) {
         return rng->error_ret;
@@ -431,6 +459,7 @@ off_t gzip_stream_get_size(IsoStream *stream)
     int ret, ret_close;
     off_t count = 0;
     GzipFilterStreamData *data;
+    IsoFilterSpill *spill = NULL;
     char buf[64 * 1024];
     size_t bufsize = 64 * 1024;
 
@@ -448,18 +477,25 @@ off_t gzip_stream_get_size(IsoStream *stream)
     if (ret < 0) {
         return ret;
     }
+    /* Keep the output for the next read run, if enabled and possible */
+    iso_filter_spill_new(&spill, 0);
     while (1) {
         ret = stream->class->read(stream, buf, bufsize);
         if (ret <= 0)
     break;
         count += ret;
+        if (spill != NULL && !iso_filter_spill_write(spill, buf, ret))
+            iso_filter_spill_destroy(&spill);
     }
     ret_close = gzip_stream_close(stream);
+    if (ret < 0 || ret_close < 0)
+        iso_filter_spill_destroy(&spill);
     if (ret < 0)
         return ret;
     if (ret_close < 0)
         return ret_close;
 
+    data->spill = spill;
     data->size = count;
     return count;
 }
@@ -498,6 +534,7 @@ void gzip_stream_free(IsoStream *stream)
     if (data->running != NULL) {
         gzip_stream_close(stream);
     }
+    iso_filter_spill_destroy(&(data->spill));
     if (stream->class->read == &gzip_stream_uncompress) {
         if (--gunzip_ref_count < 0)
             gunzip_ref_count = 0;
@@ -558,6 +595,7 @@ int gzip_clone_stream(IsoStream *old_stream, IsoStream **new_stream, int flag)
     stream_data->size = old_stream_data->size;
     stream_data->running = NULL;
     stream_data->id = ++gzip_ino_id;
+    stream_data->spill = NULL;
     stream->data = stream_data;
     *new_stream = stream;
     return ISO_SUCCESS;
@@ -659,6 +697,7 @@ int gzip_filter_get_filter(FilterContext *filter, IsoStream *original,
     data->orig = original;
     data->size = -1;
     data->running = NULL;
+    data->spill = NULL;
 
     /* get reference to the source */
     iso_stream_ref(data->orig);
@@ -31,6 +31,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <string.h>
+#include <pthread.h>
 
 #ifdef Libisofs_with_zliB
 #include <zlib.h>
@@ -51,6 +52,36 @@
 static uint8_t ziso_block_size_log2 = 15;
 static int ziso_block_size = 32768;
 
+/* Number of threads which compress the blocks of a stream */
+static int ziso_compress_threads = 1;
+
+/* A batch of consecutive input blocks of a stream, which get compressed
+   concurrently by the thread which reads the stream and by the threads of
+   the compression pool.
+*/
+typedef struct ziso_batch
+{
+    int capacity;   /* Number of blocks for which memory is allocated */
+    int count;      /* Number of blocks in the batch */
+    int next;       /* Next block to be compressed */
+    int done;       /* Number of compressed blocks */
+
+    int level;      /* zlib compression level */
+    char *in;       /* count input blocks of size in_size */
+    int in_size;
+    int *in_len;
+    char *out;      /* count output buffers of size out_size */
+    int out_size;
+    int *out_len;
+    int *zret;      /* zlib return values */
+
+    pthread_cond_t finished;
+    int finished_valid;
+
+    struct ziso_batch *next_batch; /* in the queue of the compression pool */
+
+} ZisofsBatch;
+
 
 /* Individual runtime properties exist only as long as the stream is opened.
  */
@@ -78,9 +109,70 @@ typedef struct
 
     int error_ret;
 
+    int spill_mode; /* 0= none, 1= record data blocks into the spill of the
+                       stream, 2= replay data blocks from that spill */
+
+    ZisofsBatch *batch; /* non-NULL if compression is done by the pool */
+    int batch_pos;      /* Next block of the batch to be delivered */
+    int batch_eof;      /* The input stream is at its end */
+
 } ZisofsFilterRuntime;
 
 
+static
+void ziso_batch_destroy(ZisofsBatch **batch)
+{
+    ZisofsBatch *o = *batch;
+
+    if (o == NULL)
+        return;
+    if (o->finished_valid)
+        pthread_cond_destroy(&(o->finished));
+    if (o->in != NULL)
+        free(o->in);
+    if (o->in_len != NULL)
+        free(o->in_len);
+    if (o->out != NULL)
+        free(o->out);
+    if (o->out_len != NULL)
+        free(o->out_len);
+    if (o->zret != NULL)
+        free(o->zret);
+    free(o);
+    *batch = NULL;
+}
+
+
+static
+int ziso_batch_new(ZisofsBatch **batch, int blocks, int in_size, int out_size)
+{
+    ZisofsBatch *o;
+
+    *batch = o = calloc(1, sizeof(ZisofsBatch));
+    if (o == NULL)
+        return ISO_OUT_OF_MEM;
+    o->capacity = blocks;
+    o->in_size = in_size;
+    o->out_size = out_size;
+    o->in = calloc(blocks, in_size);
+    o->in_len = calloc(blocks, sizeof(int));
+    o->out = calloc(blocks, out_size);
+    o->out_len = calloc(blocks, sizeof(int));
+    o->zret = calloc(blocks, sizeof(int));
+    if (o->in == NULL || o->in_len == NULL || o->out == NULL ||
+        o->out_len == NULL || o->zret == NULL)
+        goto failed;
+    if (pthread_cond_init(&(o->finished), NULL) != 0)
+        goto failed;
+    o->finished_valid = 1;
+    return 1;
+failed:;
+    ziso_batch_destroy(batch);
+    return ISO_OUT_OF_MEM;
+}
+
+
+
 static
 int ziso_running_destroy(ZisofsFilterRuntime **running, int flag)
 {
@@ -93,6 +185,7 @@ int ziso_running_destroy(ZisofsFilterRuntime **running, int flag)
         free(o->read_buffer);
     if (o->block_buffer != NULL)
         free(o->block_buffer);
+    ziso_batch_destroy(&(o->batch));
     free((char *) o);
     *running = NULL;
     return 1;
@@ -124,6 +217,10 @@ int ziso_running_new(ZisofsFilterRuntime **running, int flag)
     o->in_counter = 0;
     o->out_counter = 0;
     o->error_ret = 0;
+    o->spill_mode = 0;
+    o->batch = NULL;
+    o->batch_pos = 0;
+    o->batch_eof = 0;
 
     if (flag & 1)
         return 1;
@@ -166,6 +263,167 @@ static int ziso_compression_level = 6;
 #endif /* Libisofs_with_zliB */
 
 
+/* ----------------------------- Compression pool -------------------------- */
+
+#ifdef Libisofs_with_zliB
+
+/* The pool threads take blocks from the batches in the queue. They end
+   when there are more of them than ziso_compress_threads - 1, or when
+   ziso_pool_dispose() asks them to.
+*/
+static pthread_mutex_t ziso_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ziso_pool_work = PTHREAD_COND_INITIALIZER;
+static int ziso_pool_threads = 0;
+static int ziso_pool_end = 0;
+static ZisofsBatch *ziso_pool_queue = NULL;
+
+
+/* Compress one block. All-zero blocks are represented by 0 bytes. */
+static
+int ziso_compress_block(char *in, int in_len, char *out, int out_size,
+                        int *out_len, int level)
+{
+    int i, ret;
+    uLongf buf_len;
+
+    for (i = 0; i < in_len; i++)
+        if (in[i])
+    break;
+    if (i >= in_len) { /* All 0-bytes. Bypass compression. */
+        *out_len = 0;
+        return Z_OK;
+    }
+    buf_len = out_size;
+    ret = compress2((Bytef *) out, &buf_len, (Bytef *) in, (uLong) in_len,
+                    level);
+    *out_len = buf_len;
+    return ret;
+}
+
+
+/* To be called with ziso_pool_mutex locked.
+   Takes the next block of batch, compresses it with the mutex unlocked.
+*/
+static
+void ziso_batch_work(ZisofsBatch *batch)
+{
+    ZisofsBatch **pt;
+    int i;
+
+    i = batch->next++;
+    if (batch->next >= batch->count) {
+        /* No more blocks to take. Remove batch from queue. */
+        for (pt = &ziso_pool_queue; *pt != NULL; pt = &((*pt)->next_batch))
+            if (*pt == batch) {
+                *pt = batch->next_batch;
+        break;
+            }
+        batch->next_batch = NULL;
+    }
+    pthread_mutex_unlock(&ziso_pool_mutex);
+
+    batch->zret[i] = ziso_compress_block(batch->in + i * batch->in_size,
+                                         batch->in_len[i],
+                                         batch->out + i * batch->out_size,
+                                         batch->out_size, batch->out_len + i,
+                                         batch->level);
+
+    pthread_mutex_lock(&ziso_pool_mutex);
+    batch->done++;
+    if (batch->done >= batch->count)
+        pthread_cond_signal(&(batch->finished));
+}
+
+
+static
+void *ziso_pool_thread(void *arg)
+{
+    pthread_mutex_lock(&ziso_pool_mutex);
+    while (1) {
+        while (ziso_pool_queue == NULL) {
+            if (ziso_pool_end ||
+                ziso_pool_threads > ziso_compress_threads - 1) {
+                ziso_pool_threads--;
+                if (ziso_pool_end)
+                    pthread_cond_broadcast(&ziso_pool_work);
+                pthread_mutex_unlock(&ziso_pool_mutex);
+                return NULL;
+            }
+            pthread_cond_wait(&ziso_pool_work, &ziso_pool_mutex);
+        }
+        ziso_batch_work(ziso_pool_queue);
+    }
+    return NULL;
+}
+
+
+/* Compress all blocks of the batch by the pool and the calling thread.
+   Returns when all blocks are compressed.
+*/
+static
+void ziso_batch_compress(ZisofsBatch *batch)
+{
+    pthread_t thread;
+    pthread_attr_t attr;
+    ZisofsBatch **pt;
+
+    batch->next = 0;
+    batch->done = 0;
+    batch->level = ziso_compression_level;
+    batch->next_batch = NULL;
+    if (batch->count <= 0)
+        return;
+
+    pthread_mutex_lock(&ziso_pool_mutex);
+
+    /* Start missing pool threads. If this fails, the caller works alone. */
+    if (ziso_pool_threads < ziso_compress_threads - 1) {
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        while (ziso_pool_threads < ziso_compress_threads - 1) {
+            if (pthread_create(&thread, &attr, ziso_pool_thread, NULL) != 0)
+        break;
+            ziso_pool_threads++;
+        }
+        pthread_attr_destroy(&attr);
+    }
+
+    for (pt = &ziso_pool_queue; *pt != NULL; pt = &((*pt)->next_batch));
+    *pt = batch;
+    pthread_cond_broadcast(&ziso_pool_work);
+
+    while (batch->next < batch->count)
+        ziso_batch_work(batch);
+    while (batch->done < batch->count)
+        pthread_cond_wait(&(batch->finished), &ziso_pool_mutex);
+
+    pthread_mutex_unlock(&ziso_pool_mutex);
+}
+
+#endif /* Libisofs_with_zliB */
+
+
+/* To be called by iso_finish() when no stream is compressed any more.
+   Ends the pool threads and waits until they are gone.
+*/
+void ziso_pool_dispose(int flag)
+{
+
+#ifdef Libisofs_with_zliB
+
+    pthread_mutex_lock(&ziso_pool_mutex);
+    ziso_pool_end = 1;
+    pthread_cond_broadcast(&ziso_pool_work);
+    while (ziso_pool_threads > 0)
+        pthread_cond_wait(&ziso_pool_work, &ziso_pool_mutex);
+    ziso_pool_end = 0;
+    pthread_mutex_unlock(&ziso_pool_mutex);
+
+#endif /* Libisofs_with_zliB */
+
+}
+
+
 /*
  * The common data payload of an individual Zisofs Filter IsoStream
  * IMPORTANT: Any change must be reflected by ziso_clone_stream().
@@ -196,6 +454,11 @@ typedef struct
                                  written before the data and so need 2 passes.
                                  This cache avoids surplus passes.
                                */
+    IsoFilterSpill *spill; /* Data blocks kept from the size determination
+                              run, or NULL. The header and block pointers
+                              are not kept. They are complete only after
+                              that run.
+                            */
 } ZisofsComprStreamData;
 
 
@@ -243,6 +506,8 @@ int ziso_stream_close_flag(IsoStream *stream, int flag)
     if (data->running == NULL) {
         return 1;
     }
+    if (data->running->spill_mode == 2)
+        flag |= 1; /* Replay did not open the original stream */
     ziso_running_destroy(&(data->running), 0);
     if (flag & 1)
         return 1;
@@ -264,6 +529,7 @@ static
 int ziso_stream_open_flag(IsoStream *stream, int flag)
 {
     ZisofsFilterStreamData *data;
+    ZisofsComprStreamData *cnstd;
     ZisofsFilterRuntime *running = NULL;
     int ret;
 
@@ -288,6 +554,17 @@ int ziso_stream_open_flag(IsoStream *stream, int flag)
     }
     data->running = running;
 
+    if (stream->class->read != &ziso_stream_uncompress) {
+        cnstd = stream->data;
+        if (cnstd->spill != NULL && cnstd->block_pointers != NULL) {
+            /* Deliver the data blocks which were kept by the size
+               determination run */
+            running->spill_mode = 2;
+            iso_filter_spill_rewind(cnstd->spill);
+            return 1;
+        }
+    }
+
     ret = iso_stream_open(data->orig);
     if (ret < 0) {
         return ret;
@@ -303,19 +580,92 @@ int ziso_stream_open(IsoStream *stream)
 }
 
 
+#ifdef Libisofs_with_zliB
+
+/* Read and compress the next input block. The result gets stored in
+   rng->block_buffer.
+   If ziso_compress_threads is larger than 1, a batch of blocks gets read
+   and compressed concurrently. Then the blocks get delivered one by one.
+   @return  number of input bytes, 0 at end of input, < 0 error
+*/
+static
+int ziso_read_block(ZisofsComprStreamData *data, ZisofsFilterRuntime *rng,
+                    int *out_len)
+{
+    int ret, i, blocks;
+    ZisofsBatch *batch;
+
+    if (rng->batch == NULL) {
+        /* Once allocated, the batch keeps its capacity even if
+           iso_zisofs_set_params() changes the number of threads meanwhile.
+           If no memory is available, compress serially.
+        */
+        blocks = 2 * ziso_compress_threads;
+        if (blocks > 2)
+            ziso_batch_new(&(rng->batch), blocks, rng->block_size,
+                           rng->buffer_size);
+        rng->batch_pos = 0;
+    }
+    batch = rng->batch;
+
+    if (batch == NULL) {
+        ret = iso_stream_read(data->std.orig, rng->read_buffer,
+                              rng->block_size);
+        if (ret <= 0)
+            return ret;
+        i = ziso_compress_block(rng->read_buffer, ret, rng->block_buffer,
+                                rng->buffer_size, out_len,
+                                ziso_compression_level);
+        if (i != Z_OK)
+            return ISO_ZLIB_COMPR_ERR;
+        return ret;
+    }
+
+    if (rng->batch_pos >= batch->count) {
+        /* Read the next batch and compress it */
+        batch->count = 0;
+        rng->batch_pos = 0;
+        while (!rng->batch_eof && batch->count < batch->capacity) {
+            ret = iso_stream_read(data->std.orig,
+                                  batch->in + batch->count * batch->in_size,
+                                  rng->block_size);
+            if (ret < 0)
+                return ret;
+            if (ret == 0) {
+                rng->batch_eof = 1;
+        break;
+            }
+            batch->in_len[batch->count] = ret;
+            batch->count++;
+        }
+        if (batch->count == 0)
+            return 0;
+        ziso_batch_compress(batch);
+    }
+
+    i = rng->batch_pos++;
+    if (batch->zret[i] != Z_OK)
+        return ISO_ZLIB_COMPR_ERR;
+    *out_len = batch->out_len[i];
+    memcpy(rng->block_buffer, batch->out + i * batch->out_size, *out_len);
+    return batch->in_len[i];
+}
+
+#endif /* Libisofs_with_zliB */
+
+
 static
 int ziso_stream_compress(IsoStream *stream, void *buf, size_t desired)
 {
 
 #ifdef Libisofs_with_zliB
 
-    int ret, todo, i;
+    int ret, todo, buf_len = 0;
     ZisofsComprStreamData *data;
     ZisofsFilterRuntime *rng;
     size_t fill = 0;
     off_t orig_size, next_pt;
     char *cbuf = buf;
-    uLongf buf_len;
 
     if (stream == NULL) {
         return ISO_NULL_POINTER;
@@ -389,34 +739,43 @@ int ziso_stream_compress(IsoStream *stream, void *buf, size_t desired)
                 }
             }
         }
-        if (rng->state == 2 && rng->buffer_rpos >= rng->buffer_fill) {
+        if (rng->state == 2 && rng->buffer_rpos >= rng->buffer_fill &&
+            rng->spill_mode == 2) {
+            /* Delivering kept data blocks */;
+
+            ret = 0;
+            if (data->spill != NULL)
+                ret = iso_filter_spill_read(data->spill, rng->block_buffer,
+                                            rng->buffer_size);
+            if (ret < 0)
+                return (rng->error_ret = ret);
+            if (ret == 0) {
+                /* Replayed once. Further runs will compress again. */
+                iso_filter_spill_destroy(&(data->spill));
+                rng->state = 3;
+                return fill;
+            }
+            rng->buffer_fill = ret;
+            rng->buffer_rpos = 0;
+
+        } else if (rng->state == 2 && rng->buffer_rpos >= rng->buffer_fill) {
             /* Delivering data blocks */;
 
-            ret = iso_stream_read(data->std.orig, rng->read_buffer,
-                                  rng->block_size);
+            ret = ziso_read_block(data, rng, &buf_len);
             if (ret > 0) {
                 rng->in_counter += ret;
                 if (rng->in_counter > data->orig_size) {
                     /* Input size became larger */
                     return (rng->error_ret = ISO_FILTER_WRONG_INPUT);
                 }
-                /* Check whether all 0 : represent as 0-length block */;
-                for (i = 0; i < ret; i++)
-                    if (rng->read_buffer[i])
-                break;
-                if (i >= ret) { /* All 0-bytes. Bypass compression. */
-                    buf_len = 0;
-                } else {
-                    buf_len = rng->buffer_size;
-                    ret = compress2((Bytef *) rng->block_buffer, &buf_len,
-                                    (Bytef *) rng->read_buffer, (uLong) ret,
-                                    ziso_compression_level);
-                    if (ret != Z_OK) {
-                        return (rng->error_ret = ISO_ZLIB_COMPR_ERR);
-                    }
-                }
                 rng->buffer_fill = buf_len;
                 rng->buffer_rpos = 0;
+                if (rng->spill_mode == 1 && buf_len > 0 &&
+                    !iso_filter_spill_write(data->spill, rng->block_buffer,
+                                            buf_len)) {
+                    iso_filter_spill_destroy(&(data->spill));
+                    rng->spill_mode = 0;
+                }
 
                 next_pt = data->block_pointers[rng->block_counter] + buf_len;
 
@@ -674,6 +1033,7 @@ off_t ziso_stream_get_size(IsoStream *stream)
     int ret, ret_close;
     off_t count = 0;
     ZisofsFilterStreamData *data;
+    ZisofsComprStreamData *cnstd = NULL;
     char buf[64 * 1024];
     size_t bufsize = 64 * 1024;
 
@@ -696,6 +1056,12 @@ off_t ziso_stream_get_size(IsoStream *stream)
         ret = ziso_stream_uncompress(stream, buf, 0);
         count = data->size;
     } else {
+        /* Keep the data blocks for the next read run, if enabled */
+        cnstd = stream->data;
+        iso_filter_spill_new(&(cnstd->spill), 0);
+        if (cnstd->spill != NULL)
+            data->running->spill_mode = 1;
+
         /* The size of the compression result has to be counted */
         while (1) {
             ret = stream->class->read(stream, buf, bufsize);
@@ -705,6 +1071,8 @@ off_t ziso_stream_get_size(IsoStream *stream)
         }
     }
     ret_close = ziso_stream_close(stream);
+    if (cnstd != NULL && (ret < 0 || ret_close < 0))
+        iso_filter_spill_destroy(&(cnstd->spill));
     if (ret < 0)
         return ret;
     if (ret_close < 0)
@@ -756,6 +1124,7 @@ void ziso_stream_free(IsoStream *stream)
         nstd = stream->data;
         if (nstd->block_pointers != NULL)
             free((char *) nstd->block_pointers);
+        iso_filter_spill_destroy(&(nstd->spill));
         if (--ziso_ref_count < 0)
             ziso_ref_count = 0;
     }
@@ -817,6 +1186,7 @@ int ziso_clone_stream(IsoStream *old_stream, IsoStream **new_stream, int flag)
         old_compr = (ZisofsComprStreamData *) old_stream->data;
         compr->orig_size = old_compr->orig_size;
         compr->block_pointers = NULL;
+        compr->spill = NULL;
     }
     old_stream_data = (ZisofsFilterStreamData *) old_stream->data;
     stream_data->orig = new_input_stream;
@@ -948,6 +1318,7 @@ int ziso_filter_get_filter(FilterContext *filter, IsoStream *original,
     } else {
         cnstd->orig_size = 0;
         cnstd->block_pointers = NULL;
+        cnstd->spill = NULL;
         str->class = &ziso_stream_compress_class;
         ziso_ref_count++;
     }
@@ -1179,12 +1550,25 @@ int iso_zisofs_set_params(struct iso_zisofs_ctrl *params, int flag)
         params->block_size_log2 < 15 || params->block_size_log2  > 17) {
         return ISO_WRONG_ARG_VALUE;
     }
-    if (ziso_ref_count > 0) {
+    if (params->version >= 1 &&
+        (params->compress_threads < 1 || params->compress_threads > 64)) {
+        return ISO_WRONG_ARG_VALUE;
+    }
+    if (ziso_ref_count > 0 &&
+        (params->compression_level != ziso_compression_level ||
+         params->block_size_log2 != ziso_block_size_log2)) {
         return ISO_ZISOFS_PARAM_LOCK;
     }
     ziso_compression_level = params->compression_level;
     ziso_block_size_log2 = params->block_size_log2;
     ziso_block_size = 1 << ziso_block_size_log2;
+    if (params->version >= 1) {
+        /* Surplus pool threads end when they see the new number */
+        pthread_mutex_lock(&ziso_pool_mutex);
+        ziso_compress_threads = params->compress_threads;
+        pthread_cond_broadcast(&ziso_pool_work);
+        pthread_mutex_unlock(&ziso_pool_mutex);
+    }
     return 1;
     
 #else
@@ -1203,6 +1587,8 @@ int iso_zisofs_get_params(struct iso_zisofs_ctrl *params, int flag)
 
     params->compression_level = ziso_compression_level;
     params->block_size_log2 = ziso_block_size_log2;
+    if (params->version >= 1)
+        params->compress_threads = ziso_compress_threads;
     return 1;
 
 #else
@@ -51,6 +51,12 @@
 #endif /* Libisofs_syslinux_tesT */
 
 
+/* Number of directory blocks which read_dir() reads by one call of
+   iso_data_source_read_blocks()
+*/
+#define Libisofs_dir_read_blockS 16
+
+
 /**
  * Options for image reading.
  * There are four kind of options:
@@ -97,6 +103,12 @@ struct iso_read_opts
      */
     unsigned int preferjoliet : 1;
 
+    /**
+     * Read only the top level directory at import time. All other
+     * directories get read when their children are needed.
+     */
+    unsigned int lazy_dirs : 1;
+
     uid_t uid; /**< Default uid when no RR */
     gid_t gid; /**< Default uid when no RR */
     mode_t dir_mode; /**< Default mode when no RR (only permissions) */
@@ -356,6 +368,24 @@ typedef struct
 
 } _ImageFsData;
 
+/**
+ * The parts of struct stat which are recorded in the image. st_dev is the
+ * id of the image filesystem. st_blksize and st_blocks follow from the size.
+ */
+struct ifs_stat
+{
+    off_t size;
+    time_t atime;
+    time_t mtime;
+    time_t ctime;
+    ino_t ino;
+    dev_t rdev;
+    mode_t mode;
+    uid_t uid;
+    gid_t gid;
+    uint32_t nlink;
+};
+
 typedef struct image_fs_data ImageFileSourceData;
 
 /* IMPORTANT: Any change must be reflected by ifs_clone_src */
@@ -364,8 +394,8 @@ struct image_fs_data
     IsoImageFilesystem *fs; /**< reference to the image it belongs to */
     IsoFileSource *parent; /**< reference to the parent (NULL if root) */
 
-    struct stat info; /**< filled struct stat */
-    char *name; /**< name of this file */
+    struct ifs_stat info; /**< see ifs_stat_set() and ifs_stat_get() */
+    char *name; /**< name of this file, obtained by iso_str_intern() */
 
     /**
      * Location of file extents.
@@ -414,6 +444,40 @@ struct child_list
     struct child_list *next;
 };
 
+static
+void ifs_stat_set(ImageFileSourceData *data, struct stat *info)
+{
+    data->info.size = info->st_size;
+    data->info.atime = info->st_atime;
+    data->info.mtime = info->st_mtime;
+    data->info.ctime = info->st_ctime;
+    data->info.ino = info->st_ino;
+    data->info.rdev = info->st_rdev;
+    data->info.mode = info->st_mode;
+    data->info.uid = info->st_uid;
+    data->info.gid = info->st_gid;
+    data->info.nlink = info->st_nlink;
+}
+
+static
+void ifs_stat_get(ImageFileSourceData *data, struct stat *info)
+{
+    memset(info, 0, sizeof(struct stat));
+    info->st_size = data->info.size;
+    info->st_atime = data->info.atime;
+    info->st_mtime = data->info.mtime;
+    info->st_ctime = data->info.ctime;
+    info->st_ino = data->info.ino;
+    info->st_rdev = data->info.rdev;
+    info->st_mode = data->info.mode;
+    info->st_uid = data->info.uid;
+    info->st_gid = data->info.gid;
+    info->st_nlink = data->info.nlink;
+    info->st_dev = ((_ImageFsData *) data->fs->data)->id;
+    info->st_blksize = BLOCK_SIZE;
+    info->st_blocks = DIV_UP(info->st_size, BLOCK_SIZE);
+}
+
 void child_list_free(struct child_list *list)
 {
     struct child_list *temp;
@@ -476,7 +540,7 @@ int ifs_lstat(IsoFileSource *src, struct stat *info)
     data = src->data;
     if (data == NULL)
         return ISO_NULL_POINTER;
-    *info = data->info;
+    ifs_stat_get(data, info);
     return ISO_SUCCESS;
 }
 
@@ -491,11 +555,11 @@ int ifs_stat(IsoFileSource *src, struct stat *info)
 
     data = (ImageFileSourceData*)src->data;
 
-    if (S_ISLNK(data->info.st_mode)) {
+    if (S_ISLNK(data->info.mode)) {
         /* TODO #00012 : support follow symlinks on image filesystem */
         return ISO_FILE_BAD_PATH;
     }
-    *info = data->info;
+    ifs_stat_get(data, info);
     return ISO_SUCCESS;
 }
 
@@ -520,16 +584,18 @@ int read_dir(ImageFileSourceData *data)
     IsoImageFilesystem *fs;
     _ImageFsData *fsdata;
     struct ecma119_dir_record *record;
-    uint8_t *buffer = NULL;
+    uint8_t *buffer = NULL, *blk;
     IsoFileSource *child = NULL;
     uint32_t pos = 0;
     uint32_t tlen = 0;
+    uint32_t dir_blocks, win_start, win_count;
 
     if (data == NULL) {
         ret = ISO_NULL_POINTER; goto ex;
     }
 
-    LIBISO_ALLOC_MEM(buffer, uint8_t, BLOCK_SIZE);
+    LIBISO_ALLOC_MEM(buffer, uint8_t,
+                     BLOCK_SIZE * Libisofs_dir_read_blockS);
     fs = data->fs;
     fsdata = fs->data;
 
@@ -539,30 +605,46 @@ int read_dir(ImageFileSourceData *data)
     if (ret < 0) {
         goto ex;
     }
+    blk = buffer;
+    win_start = block;
+    win_count = 1;
 
     /* "." entry, get size of the dir and skip */
-    record = (struct ecma119_dir_record *)(buffer + pos);
+    record = (struct ecma119_dir_record *)(blk + pos);
     size = iso_read_bb(record->length, 4, NULL);
     tlen += record->len_dr[0];
     pos += record->len_dr[0];
+    dir_blocks = DIV_UP(size, BLOCK_SIZE);
 
     /* skip ".." */
-    record = (struct ecma119_dir_record *)(buffer + pos);
+    record = (struct ecma119_dir_record *)(blk + pos);
     tlen += record->len_dr[0];
     pos += record->len_dr[0];
 
     while (tlen < size) {
 
-        record = (struct ecma119_dir_record *)(buffer + pos);
+        record = (struct ecma119_dir_record *)(blk + pos);
         if (pos == 2048 || record->len_dr[0] == 0) {
             /*
              * The directory entries are splitted in several blocks
-             * read next block
+             * read next block. Several of them are read at once.
              */
-            ret = fsdata->src->read_block(fsdata->src, ++block, buffer);
-            if (ret < 0) {
-                goto ex;
+            ++block;
+            if (block >= win_start + win_count) {
+                if (block - data->sections[0].block < dir_blocks)
+                    win_count = dir_blocks - (block - data->sections[0].block);
+                else
+                    win_count = 1;
+                if (win_count > Libisofs_dir_read_blockS)
+                    win_count = Libisofs_dir_read_blockS;
+                ret = iso_data_source_read_blocks(fsdata->src, block,
+                                                  win_count, buffer);
+                if (ret < 0) {
+                    goto ex;
+                }
+                win_start = block;
             }
+            blk = buffer + (block - win_start) * BLOCK_SIZE;
             tlen += 2048 - pos;
             pos = 0;
             continue;
@@ -616,8 +698,8 @@ int read_dir(ImageFileSourceData *data)
                  */
                 ImageFileSourceData *ifsdata = child->data;
                 free(ifsdata->sections);
-                free(ifsdata->name);
-                free(ifsdata);
+                iso_str_release(ifsdata->name);
+                iso_pool_free(ifsdata, sizeof(ImageFileSourceData));
                 free(child);
             }
             goto ex;
@@ -667,7 +749,7 @@ int ifs_open(IsoFileSource *src)
         return ISO_FILE_ALREADY_OPENED;
     }
 
-    if (S_ISDIR(data->info.st_mode)) {
+    if (S_ISDIR(data->info.mode)) {
         /* ensure fs is openned */
         ret = data->fs->open(data->fs);
         if (ret < 0) {
@@ -690,7 +772,7 @@ int ifs_open(IsoFileSource *src)
         }
 
         return ret;
-    } else if (S_ISREG(data->info.st_mode)) {
+    } else if (S_ISREG(data->info.mode)) {
         /* ensure fs is openned */
         ret = data->fs->open(data->fs);
         if (ret < 0) {
@@ -793,6 +875,30 @@ uint32_t size_available(int nsections, struct iso_file_section *sections,
     return 0; /* should never happen */
 }
 
+/**
+ * Get the number of whole blocks which can be read in one sequence
+ * from the given offset on. The offset has to be block aligned.
+ */
+static
+uint32_t full_blocks_available(int nsections,
+                               struct iso_file_section *sections, off_t offset)
+{
+    int section = 0;
+    off_t bytes = 0;
+
+    do {
+        if ( (offset - bytes) < (off_t) sections[section].size ) {
+            return (sections[section].size - (uint32_t)(offset - bytes)) /
+                   BLOCK_SIZE;
+        } else {
+            bytes += (off_t) sections[section].size;
+            section++;
+        }
+
+    } while(section < nsections);
+    return 0; /* should never happen */
+}
+
 /**
  * Get the block offset for reading the given file offset
  */
@@ -855,16 +961,44 @@ int ifs_read(IsoFileSource *src, void *buf, size_t count)
         return ISO_FILE_IS_DIR;
     }
 
-    while (read < count && data->data.offset < data->info.st_size) {
+    while (read < count && data->data.offset < data->info.size) {
         size_t bytes;
         uint8_t *orig;
 
+        if (block_offset(data->nsections, data->sections, data->data.offset) == 0
+            && count - read >= BLOCK_SIZE) {
+            /* Whole blocks go directly into buf */
+            uint32_t block, nblocks;
+            _ImageFsData *fsdata;
+
+            nblocks = full_blocks_available(data->nsections, data->sections,
+                                            data->data.offset);
+            if (nblocks > (count - read) / BLOCK_SIZE)
+                nblocks = (count - read) / BLOCK_SIZE;
+            if (data->data.offset + (off_t) nblocks * BLOCK_SIZE >
+                data->info.size)
+                nblocks = (data->info.size - data->data.offset) /
+                          BLOCK_SIZE;
+            if (nblocks > 0) {
+                fsdata = data->fs->data;
+                block = block_from_offset(data->nsections, data->sections,
+                                          data->data.offset);
+                ret = iso_data_source_read_blocks(fsdata->src, block, nblocks,
+                                                  (uint8_t *) buf + read);
+                if (ret < 0) {
+                    return ret;
+                }
+                read += nblocks * BLOCK_SIZE;
+                data->data.offset += (off_t) nblocks * BLOCK_SIZE;
+                continue;
+            }
+        }
         if (block_offset(data->nsections, data->sections, data->data.offset) == 0) {
             /* we need to buffer next block */
             uint32_t block;
             _ImageFsData *fsdata;
 
-            if (data->data.offset >= data->info.st_size) {
+            if (data->data.offset >= data->info.size) {
                 /* EOF */
                 break;
             }
@@ -881,8 +1015,8 @@ int ifs_read(IsoFileSource *src, void *buf, size_t count)
         /* how much can I read */
         bytes = MIN(size_available(data->nsections, data->sections, data->data.offset),
                     count - read);
-        if (data->data.offset + (off_t)bytes > data->info.st_size) {
-             bytes = data->info.st_size - data->data.offset;
+        if (data->data.offset + (off_t)bytes > data->info.size) {
+             bytes = data->info.size - data->data.offset;
         }
         orig = data->data.content;
         orig += block_offset(data->nsections, data->sections, data->data.offset);
@@ -922,7 +1056,7 @@ off_t ifs_lseek(IsoFileSource *src, off_t offset, int flag)
         break;
     case 2: /* SEEK_END */
         /* do this make sense? */
-        data->data.offset = data->info.st_size + offset;
+        data->data.offset = data->info.size + offset;
         break;
     default:
         return (off_t)ISO_WRONG_ARG_VALUE;
@@ -937,7 +1071,7 @@ off_t ifs_lseek(IsoFileSource *src, off_t offset, int flag)
         uint32_t block;
         _ImageFsData *fsdata;
 
-        if (data->data.offset < data->info.st_size) {
+        if (data->data.offset < data->info.size) {
             int ret;
             fsdata = data->fs->data;
             block = block_from_offset(data->nsections, data->sections,
@@ -1029,7 +1163,7 @@ int ifs_readlink(IsoFileSource *src, char *buf, size_t bufsiz)
 
     data = (ImageFileSourceData*)src->data;
 
-    if (!S_ISLNK(data->info.st_mode)) {
+    if (!S_ISLNK(data->info.mode)) {
         return ISO_FILE_IS_NOT_SYMLINK;
     }
 
@@ -1072,7 +1206,7 @@ void ifs_free(IsoFileSource *src)
     }
 
     /* free destination if it is a link */
-    if (S_ISLNK(data->info.st_mode)) {
+    if (S_ISLNK(data->info.mode)) {
         free(data->data.content);
     }
     iso_filesystem_unref(data->fs);
@@ -1081,10 +1215,10 @@ void ifs_free(IsoFileSource *src)
     }
 
     free(data->sections);
-    free(data->name);
+    iso_str_release(data->name);
     if (data->aa_string != NULL)
         free(data->aa_string);
-    free(data);
+    iso_pool_free(data, sizeof(ImageFileSourceData));
 }
 
 
@@ -1128,10 +1262,10 @@ int ifs_clone_src(IsoFileSource *old_source,
     src = calloc(1, sizeof(IsoFileSource));
     if (src == NULL)
         goto no_mem;
-    new_name = strdup(old_data->name);
+    new_name = iso_str_intern_ref(old_data->name);
     if (new_name == NULL)
         goto no_mem;
-    new_data = calloc(1, sizeof(ImageFileSourceData));
+    new_data = iso_pool_alloc(sizeof(ImageFileSourceData));
 
     if (new_data == NULL)
         goto no_mem;
@@ -1149,7 +1283,7 @@ int ifs_clone_src(IsoFileSource *old_source,
 
     new_data->parent = old_data->parent;
 
-    memcpy(&(new_data->info), &(old_data->info), sizeof(struct stat));
+    new_data->info = old_data->info;
     new_data->name = new_name;
     new_data->sections = new_sections;
     new_data->nsections = old_data->nsections;
@@ -1176,9 +1310,8 @@ no_mem:;
     if (src != NULL)
         free((char *) src);
     if (new_data != NULL)
-        free((char *) new_data);
-    if (new_name != NULL)
-        free(new_name);
+        iso_pool_free(new_data, sizeof(ImageFileSourceData));
+    iso_str_release(new_name);
     if (new_sections != NULL)
         free((char *) new_sections);
     if (new_aa_string != NULL)
@@ -1272,6 +1405,25 @@ char *get_name(_ImageFsData *fsdata, const char *str, size_t len)
     return name;
 }
 
+/**
+ * Replace a malloc()ed name by its shared copy. The file sources and the
+ * nodes made from them use the same copy.
+ *
+ * @return
+ *      The shared name or NULL if name is NULL or out of memory
+ */
+static
+char *ifs_intern_name(char *name)
+{
+    char *shared;
+
+    if (name == NULL)
+        return NULL;
+    shared = iso_str_intern(name);
+    free(name);
+    return shared;
+}
+
 
 static
 int iso_rr_msg_submit(_ImageFsData *fsdata, int rr_err_bit,
@@ -1418,7 +1570,7 @@ int iso_file_source_new_ifs(IsoImageFilesystem *fs, IsoFileSource *parent,
         }
 
         if (*src == NULL) {
-            ifsdata = calloc(1, sizeof(ImageFileSourceData));
+            ifsdata = iso_pool_alloc(sizeof(ImageFileSourceData));
             if (ifsdata == NULL) {
                 ret = ISO_OUT_OF_MEM;
                 goto ifs_cleanup;
@@ -1429,7 +1581,8 @@ int iso_file_source_new_ifs(IsoImageFilesystem *fs, IsoFileSource *parent,
                 goto ifs_cleanup;
             }
             ifsrc->data = ifsdata;
-            ifsdata->name = get_name(fsdata, (char*)record->file_id, record->len_fi[0]);
+            ifsdata->name = ifs_intern_name(get_name(fsdata,
+                                  (char*)record->file_id, record->len_fi[0]));
             if (ifsdata->name == NULL) {
                 iso_msg_submit(fsdata->msgid, ISO_WRONG_ECMA119, 0,
                               "Cannot retrieve file name");
@@ -1446,14 +1599,14 @@ int iso_file_source_new_ifs(IsoImageFilesystem *fs, IsoFileSource *parent,
         ifsdata->sections = realloc(ifsdata->sections,
                     (1 + ifsdata->nsections) * sizeof(struct iso_file_section));
         if (ifsdata->sections == NULL) {
-            free(ifsdata->name);
+            iso_str_release(ifsdata->name);
             ret = ISO_OUT_OF_MEM;
             goto ifs_cleanup;
         }
         ifsdata->sections[ifsdata->nsections].block = iso_read_bb(record->block, 4, NULL);
         ifsdata->sections[ifsdata->nsections].size = iso_read_bb(record->length, 4, NULL);
 
-        ifsdata->info.st_size += (off_t) ifsdata->sections[ifsdata->nsections].size;
+        ifsdata->info.size += (off_t) ifsdata->sections[ifsdata->nsections].size;
         ifsdata->nsections++;
         {ret = 2; goto ex;}
     }
@@ -1867,7 +2020,13 @@ if (name != NULL && !namecont) {
 
         /* but the real name is the name of the placeholder */
         ifsdata = (ImageFileSourceData*) (*src)->data;
-        ifsdata->name = name;
+        iso_str_release(ifsdata->name);
+        ifsdata->name = ifs_intern_name(name);
+        if (ifsdata->name == NULL) {
+            iso_file_source_unref(*src);
+            *src = NULL;
+            {ret = ISO_OUT_OF_MEM; goto ex;}
+        }
 
         {ret = ISO_SUCCESS; goto ex;}
     }
@@ -1910,7 +2069,7 @@ if (name != NULL && !namecont) {
 
     /* ok, we can now create the file source */
     if (*src == NULL) {
-        ifsdata = calloc(1, sizeof(ImageFileSourceData));
+        ifsdata = iso_pool_alloc(sizeof(ImageFileSourceData));
         if (ifsdata == NULL) {
             ret = ISO_OUT_OF_MEM;
             goto ifs_cleanup;
@@ -1923,9 +2082,9 @@ if (name != NULL && !namecont) {
     } else {
         ifsdata = (*src)->data;
         ifsrc = (*src);
-        free(ifsdata->name); /* we will assign a new one */
+        iso_str_release(ifsdata->name); /* we will assign a new one */
         ifsdata->name = NULL;
-        atts.st_size += (off_t)ifsdata->info.st_size;
+        atts.st_size += (off_t)ifsdata->info.size;
         if (ifsdata->aa_string != NULL)
             free(ifsdata->aa_string);
         ifsdata->aa_string = NULL;
@@ -1938,9 +2097,17 @@ if (name != NULL && !namecont) {
         ifsdata->parent = parent;
         iso_file_source_ref(parent);
     }
-    ifsdata->info = atts;
-    ifsdata->name = name;
+    ifs_stat_set(ifsdata, &atts);
     ifsdata->aa_string = aa_string;
+    if (name != NULL) {
+        /* NULL is the name of "." */
+        ifsdata->name = ifs_intern_name(name);
+        name = NULL;
+        if (ifsdata->name == NULL) {
+            ret = ISO_OUT_OF_MEM;
+            goto ifs_cleanup;
+        }
+    }
 
 #ifdef Libisofs_with_zliB
     if (zisofs_hs4 > 0) {
@@ -1956,7 +2123,7 @@ if (name != NULL && !namecont) {
     ifsdata->sections = realloc(ifsdata->sections,
                 (1 + ifsdata->nsections) * sizeof(struct iso_file_section));
     if (ifsdata->sections == NULL) {
-        free(ifsdata->name);
+        iso_str_release(ifsdata->name);
         ret = ISO_OUT_OF_MEM;
         goto ifs_cleanup;
     }
@@ -1978,7 +2145,7 @@ if (name != NULL && !namecont) {
 ifs_cleanup: ;
     free(name);
     free(linkdest);
-    free(ifsdata);
+    iso_pool_free(ifsdata, sizeof(ImageFileSourceData));
     free(ifsrc);
 
 ex:;
@@ -2104,7 +2271,7 @@ int ifs_get_by_path(IsoFilesystem *fs, const char *path, IsoFileSource **file)
 
         ImageFileSourceData *fdata;
         fdata = src->data;
-        if (!S_ISDIR(fdata->info.st_mode)) {
+        if (!S_ISDIR(fdata->info.mode)) {
             ret = ISO_FILE_BAD_PATH;
             break;
         }
@@ -2496,7 +2663,7 @@ int read_el_torito_boot_catalog(_ImageFsData *data, uint32_t block)
     struct el_torito_validation_entry *ve;
     struct el_torito_section_header *sh;
     struct el_torito_section_entry *entry; /* also usable as default_entry */
-    unsigned char *buffer = NULL, *rpt;
+    unsigned char *buffer = NULL;
 
     LIBISO_ALLOC_MEM(buffer, unsigned char, BLOCK_SIZE);
     data->num_bootimgs = 0;
@@ -2601,12 +2768,11 @@ after_bootblocks:;
          ret = ISO_OUT_OF_MEM;
          goto ex; 
       }
-      for(rx = 0; rx < bufsize; rx += BLOCK_SIZE) {
-        rpt = (unsigned char *) (data->catcontent + rx);
-        ret = data->src->read_block(data->src, block + rx / BLOCK_SIZE, rpt);
-        if (ret < 0)
-           goto ex;
-      }
+      ret = iso_data_source_read_blocks(data->src, block,
+                                        bufsize / BLOCK_SIZE,
+                                        (uint8_t *) data->catcontent);
+      if (ret < 0)
+          goto ex;
     }
     ret = ISO_SUCCESS;
 ex:;
@@ -2625,10 +2791,10 @@ static
 int iso_src_check_sb_tree(IsoDataSource *src, uint32_t start_lba, int flag)
 {
     int tag_type, ret;
-    char *block = NULL, md5[16];
+    char *block = NULL, md5[16], *chunk = NULL;
     int desired = (1 << 2);
     void *ctx = NULL;
-    uint32_t next_tag = 0, i;
+    uint32_t next_tag = 0, i, j, n = 0;
 
     LIBISO_ALLOC_MEM(block, char, 2048);    
     ret = iso_md5_start(&ctx);
@@ -2675,13 +2841,21 @@ int iso_src_check_sb_tree(IsoDataSource *src, uint32_t start_lba, int flag)
     }
 
     /* Go on with tree */
-    for (i++; start_lba + i <= next_tag; i++) {
-        ret = src->read_block(src, start_lba + i, (uint8_t *) block);
+    LIBISO_ALLOC_MEM(chunk, char, Libisofs_dir_read_blockS * 2048);
+    for (i++; start_lba + i <= next_tag; i += n) {
+        n = next_tag - (start_lba + i) + 1;
+        if (n > Libisofs_dir_read_blockS)
+            n = Libisofs_dir_read_blockS;
+        ret = iso_data_source_read_blocks(src, start_lba + i, n,
+                                          (uint8_t *) chunk);
         if (ret < 0)
             goto ex;
-        if (start_lba + i < next_tag)
-            iso_md5_compute(ctx, block, 2048);
+        for (j = 0; j < n; j++)
+            if (start_lba + i + j < next_tag)
+                iso_md5_compute(ctx, chunk + j * 2048, 2048);
     }
+    if (n > 0)
+        memcpy(block, chunk + (n - 1) * 2048, 2048);
     ret = iso_util_eval_md5_tag(block, (1 << 3), start_lba + i - 1,
                                 ctx, start_lba, &tag_type, &next_tag, 0);
     if (ret == (int) ISO_MD5_AREA_CORRUPTED ||
@@ -2695,6 +2869,7 @@ ex:
     if (ctx != NULL)
         iso_md5_end(&ctx, md5);
     LIBISO_FREE_MEM(block);
+    LIBISO_FREE_MEM(chunk);
     return ret;
 }
 
@@ -3008,7 +3183,6 @@ int image_builder_create_node(IsoNodeBuilder *builder, IsoImage *image,
     struct stat info;
     IsoNode *new = NULL;
     IsoBoot *bootcat;
-    char *name = NULL;
     char *dest = NULL;
     ImageFileSourceData *data;
     _ImageFsData *fsdata;
@@ -3028,8 +3202,6 @@ int image_builder_create_node(IsoNodeBuilder *builder, IsoImage *image,
     data = (ImageFileSourceData*)src->data;
     fsdata = data->fs->data;
 
-    name = iso_file_source_get_name(src);
-
     /* get info about source */
     ret = iso_file_source_lstat(src, &info);
     if (ret < 0) {
@@ -3056,7 +3228,7 @@ int image_builder_create_node(IsoNodeBuilder *builder, IsoImage *image,
 
                 /* we create a placeholder for the catalog instead of
                  * a regular file */
-                new = calloc(1, sizeof(IsoBoot));
+                new = iso_node_alloc(LIBISO_BOOT);
                 if (new == NULL) {
                     ret = ISO_OUT_OF_MEM; goto ex;
                 }
@@ -3079,7 +3251,6 @@ int image_builder_create_node(IsoNodeBuilder *builder, IsoImage *image,
 
                 /* and set the image node */
                 image->bootcat->node = bootcat;
-                new->type = LIBISO_BOOT;
                 new->refcount = 1;
             } else {
                 IsoStream *stream;
@@ -3092,7 +3263,7 @@ int image_builder_create_node(IsoNodeBuilder *builder, IsoImage *image,
                 /* take a ref to the src, as stream has taken our ref */
                 iso_file_source_ref(src);
 
-                file = calloc(1, sizeof(IsoFile));
+                file = (IsoFile *) iso_node_alloc(LIBISO_FILE);
                 if (file == NULL) {
                     iso_stream_unref(stream);
                     {ret = ISO_OUT_OF_MEM; goto ex;}
@@ -3108,7 +3279,6 @@ int image_builder_create_node(IsoNodeBuilder *builder, IsoImage *image,
                 file->sort_weight = INT_MAX - data->sections[0].block;
 
                 file->stream = stream;
-                file->node.type = LIBISO_FILE;
 
 #ifdef Libisofs_with_zliB
 
@@ -3162,11 +3332,10 @@ int image_builder_create_node(IsoNodeBuilder *builder, IsoImage *image,
     case S_IFDIR:
         {
             /* source is a directory */
-            new = calloc(1, sizeof(IsoDir));
+            new = iso_node_alloc(LIBISO_DIR);
             if (new == NULL) {
                 {ret = ISO_OUT_OF_MEM; goto ex;}
             }
-            new->type = LIBISO_DIR;
             new->refcount = 0;
         }
         break;
@@ -3181,12 +3350,11 @@ int image_builder_create_node(IsoNodeBuilder *builder, IsoImage *image,
             if (ret < 0) {
                 goto ex;
             }
-            link = calloc(1, sizeof(IsoSymlink));
+            link = (IsoSymlink *) iso_node_alloc(LIBISO_SYMLINK);
             if (link == NULL) {
                 {ret = ISO_OUT_OF_MEM; goto ex;}
             }
             link->dest = strdup(dest);
-            link->node.type = LIBISO_SYMLINK;
             link->fs_id = ISO_IMAGE_FS_ID;
             link->st_dev = info.st_dev;
             link->st_ino = info.st_ino;
@@ -3201,12 +3369,11 @@ int image_builder_create_node(IsoNodeBuilder *builder, IsoImage *image,
         {
             /* source is an special file */
             IsoSpecial *special;
-            special = calloc(1, sizeof(IsoSpecial));
+            special = (IsoSpecial *) iso_node_alloc(LIBISO_SPECIAL);
             if (special == NULL) {
                 ret = ISO_OUT_OF_MEM; goto ex;
             }
             special->dev = info.st_rdev;
-            special->node.type = LIBISO_SPECIAL;
             special->fs_id = ISO_IMAGE_FS_ID;
             special->st_dev = info.st_dev;
             special->st_ino = info.st_ino;
@@ -3219,7 +3386,7 @@ int image_builder_create_node(IsoNodeBuilder *builder, IsoImage *image,
     }
     /* fill fields */
     new->refcount++;
-    new->name = name; name = NULL;
+    new->name = iso_str_intern_ref(data->name);
     new->mode = info.st_mode;
     new->uid = info.st_uid;
     new->gid = info.st_gid;
@@ -3249,8 +3416,6 @@ int image_builder_create_node(IsoNodeBuilder *builder, IsoImage *image,
     {ret = ISO_SUCCESS; goto ex;}
 
 ex:;
-    if (name != NULL)
-        free(name);
     if (new != NULL)
         iso_node_unref(new);
     LIBISO_FREE_MEM(dest);
@@ -3325,7 +3490,7 @@ int create_boot_img_filesrc(IsoImageFilesystem *fs, IsoImage *image, int idx,
     atts.st_blocks = DIV_UP(atts.st_size, BLOCK_SIZE);
 
     /* ok, we can now create the file source */
-    ifsdata = calloc(1, sizeof(ImageFileSourceData));
+    ifsdata = iso_pool_alloc(sizeof(ImageFileSourceData));
     if (ifsdata == NULL) {
         ret = ISO_OUT_OF_MEM;
         goto boot_fs_cleanup;
@@ -3346,7 +3511,7 @@ int create_boot_img_filesrc(IsoImageFilesystem *fs, IsoImage *image, int idx,
     ifsdata->fs = fs;
     iso_filesystem_ref(fs);
     ifsdata->parent = NULL;
-    ifsdata->info = atts;
+    ifs_stat_set(ifsdata, &atts);
     ifsdata->name = NULL;
     ifsdata->sections[0].block = fsdata->bootblocks[idx];
     ifsdata->sections[0].size = BLOCK_SIZE;
@@ -3360,7 +3525,7 @@ int create_boot_img_filesrc(IsoImageFilesystem *fs, IsoImage *image, int idx,
     return ISO_SUCCESS;
 
 boot_fs_cleanup: ;
-    free(ifsdata);
+    iso_pool_free(ifsdata, sizeof(ImageFileSourceData));
     free(ifsrc);
     return ret;
 }
@@ -3480,6 +3645,223 @@ ex:;
     return ret;
 }
 
+/* ------------- Lazy loading of directories ------------- */
+
+/* Shared by the image and all directories which are not loaded yet
+*/
+struct iso_lazy_import
+{
+    int refcount;
+
+    /* Not referenced. Set to NULL when the image gets disposed or imports
+       another tree.
+     */
+    IsoImage *image;
+
+    /* The builder of iso_image_import() with image_builder_create_node() */
+    IsoNodeBuilder *builder;
+
+    /* The filesystem which reads the directory records */
+    IsoImageFilesystem *fs;
+
+    /* Number of directories which are not loaded yet */
+    int pending;
+
+    /* Whether the inode numbers have been completed after all directories
+       were loaded */
+    int inos_done;
+
+    /* The first error with which a directory failed to load. Such a
+       directory stays empty or incomplete, so the tree must not get written.
+       Reported by iso_image_load_lazy_dirs().
+     */
+    int error;
+};
+
+struct iso_lazy_dir
+{
+    IsoFileSource *src;
+    struct iso_lazy_import *ctx;
+};
+
+static
+int iso_lazy_import_new(IsoImage *image, IsoImageFilesystem *fs,
+                        struct iso_lazy_import **ctx)
+{
+    struct iso_lazy_import *o;
+
+    o = calloc(1, sizeof(struct iso_lazy_import));
+    if (o == NULL)
+        return ISO_OUT_OF_MEM;
+    o->refcount = 1;
+    o->image = image;
+    o->builder = image->builder;
+    iso_node_builder_ref(o->builder);
+    o->fs = fs;
+    iso_filesystem_ref(fs);
+    *ctx = o;
+    return ISO_SUCCESS;
+}
+
+static
+void iso_lazy_import_unref(struct iso_lazy_import *ctx)
+{
+    if (ctx == NULL)
+        return;
+    if (--ctx->refcount > 0)
+        return;
+    iso_node_builder_unref(ctx->builder);
+    iso_filesystem_unref(ctx->fs);
+    free(ctx);
+}
+
+int iso_dir_set_lazy(IsoImage *image, IsoDir *dir, IsoFileSource *src)
+{
+    struct iso_lazy_dir *lazy;
+
+    if (image->lazy == NULL)
+        return ISO_ASSERT_FAILURE;
+    lazy = calloc(1, sizeof(struct iso_lazy_dir));
+    if (lazy == NULL)
+        return ISO_OUT_OF_MEM;
+    lazy->src = src;
+    iso_file_source_ref(src);
+    lazy->ctx = image->lazy;
+    lazy->ctx->refcount++;
+    lazy->ctx->pending++;
+    dir->lazy = lazy;
+    return ISO_SUCCESS;
+}
+
+void iso_dir_free_lazy(IsoDir *dir)
+{
+    if (dir->lazy == NULL)
+        return;
+    iso_file_source_unref(dir->lazy->src);
+    dir->lazy->ctx->pending--;
+    iso_lazy_import_unref(dir->lazy->ctx);
+    free(dir->lazy);
+    dir->lazy = NULL;
+}
+
+/* Give inode numbers to the nodes which have none, as iso_image_import()
+   does after loading the whole tree. Only now the maximum PX inode number
+   is known.
+*/
+static
+int iso_lazy_import_complete(IsoImage *image, struct iso_lazy_import *ctx)
+{
+    int ret;
+    _ImageFsData *fsdata;
+
+    if (ctx->inos_done)
+        return ISO_SUCCESS;
+    ctx->inos_done = 1;
+    fsdata = ctx->fs->data;
+    if (!fsdata->make_new_ino && (fsdata->px_ino_status & (2 | 4 | 8))) {
+        ret = img_make_inos(image, image->root, 2 | 4 | 8);
+        if (ret < 0)
+            return ret;
+    }
+    return ISO_SUCCESS;
+}
+
+int iso_dir_load_lazy(IsoDir *dir, int flag)
+{
+    int ret = 0;
+    struct iso_lazy_dir *lazy;
+    struct iso_lazy_import *ctx_back;
+    IsoImage *image;
+    IsoNodeBuilder *builder_back;
+    IsoNode *pos;
+    _ImageFsData *fsdata;
+
+    lazy = dir->lazy;
+    if (lazy != NULL) {
+        /* Detach first, so that the insertion of the children does not
+           come back here */
+        dir->lazy = NULL;
+        image = lazy->ctx->image;
+        if (image == NULL) {
+            /* The image is gone. Nothing can be added any more. */
+            ret = ISO_SUCCESS;
+            goto loaded;
+        }
+        fsdata = lazy->ctx->fs->data;
+
+        builder_back = image->builder;
+        ctx_back = image->lazy;
+        image->builder = lazy->ctx->builder;
+        image->lazy = lazy->ctx;
+        ret = iso_add_dir_src_rec(image, dir, lazy->src, 1);
+        image->builder = builder_back;
+        image->lazy = ctx_back;
+        if (ret < 0)
+            goto loaded;
+
+        /* Inode numbers as iso_image_import() would have set them */
+        if (fsdata->make_new_ino) {
+            ret = img_make_inos(image, dir, 1 | 16);
+            if (ret < 0)
+                goto loaded;
+        } else if (image->inode_counter < fsdata->inode_counter) {
+            image->inode_counter = fsdata->inode_counter;
+        }
+        ret = ISO_SUCCESS;
+        if (lazy->ctx->pending == 1 && image->lazy == lazy->ctx)
+            ret = iso_lazy_import_complete(image, lazy->ctx);
+loaded:;
+        if (ret < 0 && lazy->ctx->error == 0)
+            lazy->ctx->error = ret;
+        iso_file_source_unref(lazy->src);
+        lazy->ctx->pending--;
+        iso_lazy_import_unref(lazy->ctx);
+        free(lazy);
+        if (ret < 0)
+            return ret;
+    }
+    if (flag & 1) {
+        for (pos = dir->children; pos != NULL; pos = pos->next) {
+            if (pos->type != LIBISO_DIR)
+        continue;
+            ret = iso_dir_load_lazy((IsoDir *) pos, flag);
+            if (ret < 0)
+                return ret;
+        }
+    }
+    return ISO_SUCCESS;
+}
+
+int iso_image_load_lazy_dirs(IsoImage *image, int flag)
+{
+    int ret;
+
+    if (image->lazy == NULL)
+        return 0;
+    ret = iso_dir_load_lazy(image->root, 1);
+    if (ret < 0)
+        return ret;
+    /* Directories which failed on earlier access are not loaded again */
+    if (image->lazy->error < 0)
+        return image->lazy->error;
+    ret = iso_lazy_import_complete(image, image->lazy);
+    if (ret < 0)
+        return ret;
+    return 1;
+}
+
+void iso_image_detach_lazy(IsoImage *image)
+{
+    if (image->lazy == NULL)
+        return;
+    image->lazy->image = NULL;
+    iso_lazy_import_unref(image->lazy);
+    image->lazy = NULL;
+}
+
+/* ------------- End of lazy loading of directories ------------- */
+
+
 int iso_image_import(IsoImage *image, IsoDataSource *src,
                      struct iso_read_opts *opts,
                      IsoReadImageFeatures **features)
@@ -3492,7 +3874,6 @@ int iso_image_import(IsoImage *image, IsoDataSource *src,
     IsoFileSource *newroot;
     _ImageFsData *data;
     struct el_torito_boot_catalog *oldbootcat;
-    uint8_t *rpt;
     IsoFileSource *boot_src;
     IsoNode *node;
     char *old_checksum_array = NULL;
@@ -3503,6 +3884,7 @@ int iso_image_import(IsoImage *image, IsoDataSource *src,
     char md5[16];
     struct el_torito_boot_catalog *catalog = NULL;
     ElToritoBootImage *boot_image = NULL;
+    struct iso_lazy_import *oldlazy;
 
     if (image == NULL || src == NULL || opts == NULL) {
         return ISO_NULL_POINTER;
@@ -3524,12 +3906,10 @@ int iso_image_import(IsoImage *image, IsoDataSource *src,
             return ISO_OUT_OF_MEM;
         image->system_area_options = 0;
         /* Read 32768 bytes */
-        for (i = 0; i < 16; i++) {
-            rpt = (uint8_t *) (image->system_area_data + i * 2048);
-            ret = src->read_block(src, opts->block + i, rpt);
-            if (ret < 0)
-                return ret;
-        }
+        ret = iso_data_source_read_blocks(src, opts->block, 16,
+                                      (uint8_t *) image->system_area_data);
+        if (ret < 0)
+            return ret;
     }
 
     /* get root from filesystem */
@@ -3546,6 +3926,8 @@ int iso_image_import(IsoImage *image, IsoDataSource *src,
     image->bootcat = NULL;
     old_checksum_array = image->checksum_array;
     image->checksum_array = NULL;
+    oldlazy = image->lazy;
+    image->lazy = NULL;
 
     /* create new builder */
     ret = iso_image_builder_new(blback, &image->builder);
@@ -3553,6 +3935,16 @@ int iso_image_import(IsoImage *image, IsoDataSource *src,
         goto import_revert;
     }
 
+    /* Boot images get recognized while the tree is read. So El Torito
+       demands to read the whole tree. */
+    if (opts->lazy_dirs && !data->eltorito) {
+        ret = iso_lazy_import_new(image, fs, &image->lazy);
+        if (ret < 0) {
+            iso_node_builder_unref(image->builder);
+            goto import_revert;
+        }
+    }
+
     image->fs = fs;
 
     /* create new root, and set root attributes from source */
@@ -3622,7 +4014,8 @@ int iso_image_import(IsoImage *image, IsoDataSource *src,
     }
 
     /* recursively add image */
-    ret = iso_add_dir_src_rec(image, image->root, newroot);
+    ret = iso_add_dir_src_rec(image, image->root, newroot,
+                              image->lazy != NULL);
 
     /* error during recursive image addition? */
     if (ret < 0) {
@@ -3643,7 +4036,19 @@ int iso_image_import(IsoImage *image, IsoDataSource *src,
             hflag = 1; /* Equip all data files with new unique inos */
         else
             hflag = 2 | 4 | 8; /* Equip any file type if it has ino == 0 */
-        ret = img_make_inos(image, image->root, hflag);
+        if (image->lazy != NULL) {
+            /* The other directories get their inos when being loaded.
+               Nodes without PX inode number have to wait until the
+               maximum PX inode number is known. */
+            if (opts->make_new_ino)
+                ret = img_make_inos(image, image->root, hflag | 16);
+            else
+                ret = 1;
+            if (image->lazy->pending == 0)
+                ret = iso_lazy_import_complete(image, image->lazy);
+        } else {
+            ret = img_make_inos(image, image->root, hflag);
+        }
         if (ret < 0) {
             iso_node_builder_unref(image->builder);
             goto import_revert;
@@ -3678,7 +4083,7 @@ int iso_image_import(IsoImage *image, IsoDataSource *src,
         if (image->bootcat->node == NULL) {
             IsoNode *node;
             IsoBoot *bootcat;
-            node = calloc(1, sizeof(IsoBoot));
+            node = iso_node_alloc(LIBISO_BOOT);
             if (node == NULL) {
                 ret = ISO_OUT_OF_MEM;
                 goto import_revert;
@@ -3695,7 +4100,6 @@ int iso_image_import(IsoImage *image, IsoDataSource *src,
                 }
                 memcpy(bootcat->content, data->catcontent, bootcat->size);
             }
-            node->type = LIBISO_BOOT;
             node->mode = S_IFREG;
             node->refcount = 1;
             image->bootcat->node = (IsoBoot*)node;
@@ -3751,12 +4155,11 @@ int iso_image_import(IsoImage *image, IsoDataSource *src,
             }
 
             /* Load from image->checksum_end_lba */;
-            for (i = 0; i < (int) size; i++) {
-                rpt = (uint8_t *) (image->checksum_array + i * 2048);
-                ret = src->read_block(src, image->checksum_end_lba + i, rpt);
-                if (ret <= 0)
-                    goto import_cleanup;
-            }
+            ret = iso_data_source_read_blocks(src, image->checksum_end_lba,
+                                              size,
+                                        (uint8_t *) image->checksum_array);
+            if (ret <= 0)
+                goto import_cleanup;
 
             /* Compute MD5 and compare with recorded MD5 */
             ret = iso_md5_start(&ctx);
@@ -3791,6 +4194,9 @@ int iso_image_import(IsoImage *image, IsoDataSource *src,
 
     import_revert:;
 
+    iso_image_detach_lazy(image);
+    image->lazy = oldlazy;
+    oldlazy = NULL;
     iso_node_unref((IsoNode*)image->root);
     el_torito_boot_catalog_free(image->bootcat);
     image->root = oldroot;
@@ -3802,6 +4208,12 @@ int iso_image_import(IsoImage *image, IsoDataSource *src,
 
     import_cleanup:;
 
+    /* The tree of a previous import is gone */
+    if (oldlazy != NULL) {
+        oldlazy->image = NULL;
+        iso_lazy_import_unref(oldlazy);
+    }
+
     /* recover backed fs and builder */
     image->fs = fsback;
     image->builder = blback;
@@ -3983,6 +4395,15 @@ int iso_read_opts_set_new_inos(IsoReadOpts *opts, int new_inos)
     return ISO_SUCCESS;
 }
 
+int iso_read_opts_set_lazy_dirs(IsoReadOpts *opts, int lazy_dirs)
+{
+    if (opts == NULL) {
+        return ISO_NULL_POINTER;
+    }
+    opts->lazy_dirs = lazy_dirs ? 1 : 0;
+    return ISO_SUCCESS;
+}
+
 int iso_read_opts_set_preferjoliet(IsoReadOpts *opts, int preferjoliet)
 {
     if (opts == NULL) {
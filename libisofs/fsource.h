@@ -45,4 +45,13 @@ int iso_ifs_source_clone(IsoFileSource *old_source, IsoFileSource **new_source,
                          int flag);
 
 
+/* Read count consecutive blocks of 2048 bytes from an IsoDataSource.
+   Uses its method read_blocks() if available, else read_block() for each
+   block. (Implemented in data_source.c)
+   @return 1 success, < 0 error
+*/
+int iso_data_source_read_blocks(IsoDataSource *src, uint32_t lba,
+                                uint32_t count, uint8_t *buffer);
+
+
 #endif /*LIBISO_FSOURCE_H_*/
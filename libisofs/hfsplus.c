@@ -1563,10 +1563,9 @@ int mangle_leafs(Ecma119Image *target, int flag)
     return ISO_SUCCESS;
 }
 
-int hfsplus_writer_create(Ecma119Image *target)
+int hfsplus_tree_create(Ecma119Image *target)
 {
     int ret;
-    IsoImageWriter *writer;
     int max_levels;
     int level = 0;
     IsoNode *pos;
@@ -1574,36 +1573,15 @@ int hfsplus_writer_create(Ecma119Image *target)
     int i;
     uint32_t cat_node_size;
 
-    writer = calloc(1, sizeof(IsoImageWriter));
-    if (writer == NULL) {
-        return ISO_OUT_OF_MEM;
-    }
-
-    make_hfsplus_decompose_pages();
-    make_hfsplus_class_pages();
-
-    if (target->hfsp_block_size == 0)
-        target->hfsp_block_size = HFSPLUS_DEFAULT_BLOCK_SIZE;
-    target->hfsp_cat_node_size = 2 * target->hfsp_block_size;
-    target->hfsp_iso_block_fac = 2048 / target->hfsp_block_size;
     cat_node_size = target->hfsp_cat_node_size;
 
-    writer->compute_data_blocks = hfsplus_writer_compute_data_blocks;
-    writer->write_vol_desc = nop_writer_write_vol_desc;
-    writer->write_data = hfsplus_writer_write_data;
-    writer->free_data = hfsplus_writer_free_data;
-    writer->data = NULL;
-    writer->target = target;
-
     iso_msg_debug(target->image->id, "Creating HFS+ tree...");
     target->hfsp_nfiles = 0;
     target->hfsp_ndirs = 0;
     target->hfsp_cat_id = 16;
     ret = hfsplus_count_tree(target, (IsoNode*)target->image->root);
-    if (ret < 0) {
-        free((char *) writer);
+    if (ret < 0)
         return ret;
-    }
 
     for (i = 0; i < ISO_HFSPLUS_BLESS_MAX; i++)
       target->hfsp_bless_id[i] = 0;
@@ -1775,6 +1753,42 @@ int hfsplus_writer_create(Ecma119Image *target)
 	return ISO_MANGLE_TOO_MUCH_FILES;
       }
 
+    return ISO_SUCCESS;
+}
+
+int hfsplus_writer_create(Ecma119Image *target)
+{
+    int ret;
+    IsoImageWriter *writer;
+
+    writer = calloc(1, sizeof(IsoImageWriter));
+    if (writer == NULL) {
+        return ISO_OUT_OF_MEM;
+    }
+
+    make_hfsplus_decompose_pages();
+    make_hfsplus_class_pages();
+
+    if (target->hfsp_block_size == 0)
+        target->hfsp_block_size = HFSPLUS_DEFAULT_BLOCK_SIZE;
+    target->hfsp_cat_node_size = 2 * target->hfsp_block_size;
+    target->hfsp_iso_block_fac = 2048 / target->hfsp_block_size;
+
+    writer->compute_data_blocks = hfsplus_writer_compute_data_blocks;
+    writer->write_vol_desc = nop_writer_write_vol_desc;
+    writer->write_data = hfsplus_writer_write_data;
+    writer->free_data = hfsplus_writer_free_data;
+    writer->data = NULL;
+    writer->target = target;
+
+    if (!target->trees_parallel) {
+        ret = hfsplus_tree_create(target);
+        if (ret <= 0) {
+            free((char *) writer);
+            return ret;
+        }
+    }
+
     /* add this writer to image */
     target->writers[target->nwriters++] = writer;
 
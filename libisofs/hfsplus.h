@@ -67,6 +67,12 @@ struct hfsplus_node
 };
 
 int hfsplus_writer_create(Ecma119Image *target);
+
+/* Create the HFS+ catalog tree. Normally done by hfsplus_writer_create(),
+   but by ecma119_build_trees() if target->trees_parallel is set.
+*/
+int hfsplus_tree_create(Ecma119Image *target);
+
 int hfsplus_tail_writer_create(Ecma119Image *target);
 
 struct hfsplus_extent
@@ -132,6 +132,7 @@ void iso_image_unref(IsoImage *image)
         for (i = 0; i < ISO_HFSPLUS_BLESS_MAX; i++)
             if (image->hfsplus_blessed[i] != NULL)
                 iso_node_unref(image->hfsplus_blessed[i]);
+        iso_image_detach_lazy(image);
         iso_node_unref((IsoNode*)image->root);
         iso_node_builder_unref(image->builder);
         iso_filesystem_unref(image->fs);
@@ -391,10 +392,17 @@ int iso_image_get_system_area(IsoImage *img, char system_area_data[32768],
 static
 int dir_update_size(IsoImage *image, IsoDir *dir)
 {
+    int ret;
     IsoNode *pos;
+
+    if (dir->lazy != NULL) {
+        ret = iso_dir_load_lazy(dir, 0);
+        if (ret < 0)
+            return ret;
+    }
     pos = dir->children;
     while (pos) {
-        int ret = 1;
+        ret = 1;
         if (pos->type == LIBISO_FILE) {
             ret = iso_stream_update_size(ISO_FILE(pos)->stream);
         } else if (pos->type == LIBISO_DIR) {
@@ -597,6 +605,7 @@ int img_update_ino(IsoImage *image, IsoNode *node, int flag)
                bit1= install inode with non-data, non-directory files
                bit2= install inode with directories
                bit3= with bit2: install inode on parameter dir
+               bit4= do not descend into sub directories
 */
 int img_make_inos(IsoImage *image, IsoDir *dir, int flag)
 {
@@ -618,7 +627,7 @@ int img_make_inos(IsoImage *image, IsoDir *dir, int flag)
         ret = img_update_ino(image, node, flag & 7);
         if (ret < 0)
             goto ex;
-        if (iso_node_get_type(node) == LIBISO_DIR) {
+        if (iso_node_get_type(node) == LIBISO_DIR && !(flag & 16)) {
             subdir = (IsoDir *) node;
             ret = img_make_inos(image, subdir, flag & ~8);
             if (ret < 0)
@@ -195,6 +195,14 @@ struct Iso_Image
      */
     IsoNode *hfsplus_blessed[ISO_HFSPLUS_BLESS_MAX];
 
+    /**
+     * Shared state of the directories which iso_image_import() left
+     * unloaded. NULL if the last import loaded the whole tree or if all
+     * directories have been loaded meanwhile.
+     * See iso_read_opts_set_lazy_dirs().
+     */
+    struct iso_lazy_import *lazy;
+
 };
 
 
@@ -225,10 +233,22 @@ ino_t img_give_ino_number(IsoImage *image, int flag);
                bit1= install inode with non-data, non-directory files
                bit2= install inode with directories
                bit3= with bit2: install inode on parameter dir
+               bit4= do not descend into sub directories
 */
 int img_make_inos(IsoImage *image, IsoDir *dir, int flag);
 
 
+/* Load all directories which iso_image_import() left unloaded.
+   Implemented in fs_image.c.
+*/
+int iso_image_load_lazy_dirs(IsoImage *image, int flag);
+
+/* Cut the connection between an image and the directories which are not
+   loaded yet. Implemented in fs_image.c.
+*/
+void iso_image_detach_lazy(IsoImage *image);
+
+
 /* Free the checksum array of an image and reset its layout parameters
 */
 int iso_image_free_checksums(IsoImage *image, int flag);
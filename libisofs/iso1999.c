@@ -161,7 +161,9 @@ int create_node(Ecma119Image *t, IsoNode *iso, Iso1999Node **node)
 
     /* take a ref to the IsoNode */
     n->node = iso;
+    ecma119_trees_lock(t);
     iso_node_ref(iso);
+    ecma119_trees_unlock(t);
 
     *node = n;
     return ISO_SUCCESS;
@@ -224,7 +226,9 @@ int create_tree(Ecma119Image *t, IsoNode *iso, Iso1999Node **tree, int pathlen)
                 cret = create_tree(t, pos, &child, max_path);
                 if (cret < 0) {
                     /* error */
+                    ecma119_trees_lock(t);
                     iso1999_node_free(node);
+                    ecma119_trees_unlock(t);
                     ret = cret;
                     break;
                 } else if (cret == ISO_SUCCESS) {
@@ -508,7 +512,6 @@ int mangle_tree(Ecma119Image *t, Iso1999Node *dir)
     return ISO_SUCCESS;
 }
 
-static
 int iso1999_tree_create(Ecma119Image *t)
 {
     int ret;
@@ -1046,12 +1049,14 @@ int iso1999_writer_create(Ecma119Image *target)
     writer->data = NULL;
     writer->target = target;
 
-    iso_msg_debug(target->image->id,
-                  "Creating low level ISO 9660:1999 tree...");
-    ret = iso1999_tree_create(target);
-    if (ret < 0) {
-        free((char *) writer);
-        return ret;
+    if (!target->trees_parallel) {
+        iso_msg_debug(target->image->id,
+                      "Creating low level ISO 9660:1999 tree...");
+        ret = iso1999_tree_create(target);
+        if (ret < 0) {
+            free((char *) writer);
+            return ret;
+        }
     }
 
     /* add this writer to image */
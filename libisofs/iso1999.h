@@ -57,4 +57,14 @@ struct iso1999_node
  */
 int iso1999_writer_create(Ecma119Image *target);
 
+/**
+ * Create the low level ISO 9660:1999 tree. Normally done by
+ * iso1999_writer_create(), but by ecma119_build_trees() if
+ * target->trees_parallel is set.
+ *
+ * @return
+ *      1 on success, < 0 on error
+ */
+int iso1999_tree_create(Ecma119Image *target);
+
 #endif /* LIBISO_ISO1999_H */
@@ -156,7 +156,9 @@ int create_node(Ecma119Image *t, IsoNode *iso, JolietNode **node)
 
     /* take a ref to the IsoNode */
     joliet->node = iso;
+    ecma119_trees_lock(t);
     iso_node_ref(iso);
+    ecma119_trees_unlock(t);
 
     *node = joliet;
     return ISO_SUCCESS;
@@ -222,7 +224,9 @@ int create_tree(Ecma119Image *t, IsoNode *iso, JolietNode **tree, int pathlen)
                 cret = create_tree(t, pos, &child, max_path);
                 if (cret < 0) {
                     /* error */
+                    ecma119_trees_lock(t);
                     joliet_node_free(node);
+                    ecma119_trees_unlock(t);
                     ret = cret;
                     break;
                 } else if (cret == ISO_SUCCESS) {
@@ -554,8 +558,11 @@ int mangle_tree(Ecma119Image *t, JolietNode *dir)
     return ISO_SUCCESS;
 }
 
-static
-int joliet_tree_create(Ecma119Image *t)
+/**
+ * @param flag
+ *      bit0= create the tree for the partition at t->partition_offset
+ */
+int joliet_tree_create(Ecma119Image *t, int flag)
 {
     int ret;
     JolietNode *root;
@@ -574,7 +581,7 @@ int joliet_tree_create(Ecma119Image *t)
     }
 
     /* the Joliet tree is stored in Ecma119Image target */
-    if (t->eff_partition_offset > 0) {
+    if (flag & 1) {
         t->j_part_root = root;
     } else {
         t->joliet_root = root;
@@ -1199,24 +1206,25 @@ int joliet_writer_create(Ecma119Image *target)
     writer->data = NULL;
     writer->target = target;
 
-    iso_msg_debug(target->image->id, "Creating low level Joliet tree...");
-    ret = joliet_tree_create(target);
-    if (ret < 0) {
-        free((char *) writer);
-        return ret;
+    if (!target->trees_parallel) {
+        iso_msg_debug(target->image->id,
+                      "Creating low level Joliet tree...");
+        ret = joliet_tree_create(target, 0);
+        if (ret < 0) {
+            free((char *) writer);
+            return ret;
+        }
     }
 
     /* add this writer to image */
     target->writers[target->nwriters++] = writer;
 
-    if(target->partition_offset > 0) {
+    if (target->partition_offset > 0 && !target->trees_parallel) {
         /* Create second tree */
-        target->eff_partition_offset = target->partition_offset;
-        ret = joliet_tree_create(target);
+        ret = joliet_tree_create(target, 1);
         if (ret < 0) {
             return ret;
         }
-        target->eff_partition_offset = 0;
     }
 
     /* we need the volume descriptor */
@@ -58,6 +58,17 @@ struct joliet_node
  */
 int joliet_writer_create(Ecma119Image *target);
 
+/**
+ * Create the low level Joliet tree. Normally done by joliet_writer_create(),
+ * but by ecma119_build_trees() if target->trees_parallel is set.
+ *
+ * @param flag
+ *      bit0= create the tree for the partition at target->partition_offset
+ * @return
+ *      1 on success, < 0 on error
+ */
+int joliet_tree_create(Ecma119Image *target, int flag);
+
 
 /* Not to be called but only for comparison with target->writers[i]
 */
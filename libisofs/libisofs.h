@@ -402,7 +402,11 @@ typedef struct iso_data_source IsoDataSource;
 struct iso_data_source
 {
 
-    /* reserved for future usage, set to 0 */
+    /**
+     * Version of the struct: 0 or 1.
+     * 1 tells that member read_blocks is present.
+     * @since 1.3.2 version 1
+     */
     int version;
 
     /**
@@ -457,6 +461,29 @@ struct iso_data_source
 
     /** Source specific data */
     void *data;
+
+    /**
+     * Read a sequence of consecutive blocks (2048 bytes each) from the source.
+     * This is an optional accelerated alternative to calling read_block()
+     * for each of the blocks. It is only inspected if version is 1 or higher.
+     * If it is NULL, then libisofs uses read_block().
+     *
+     * @param lba
+     *     First block to be read.
+     * @param count
+     *     Number of blocks to be read.
+     * @param buffer
+     *     Buffer where the data will be written. It must have at least
+     *     count * 2048 bytes.
+     * @return
+     *      1 if success, all blocks were read
+     *    < 0 if error. The same error codes as with read_block() apply.
+     *        The content of buffer is undefined in this case.
+     *
+     * @since 1.3.2
+     */
+    int (*read_blocks)(IsoDataSource *src, uint32_t lba, uint32_t count,
+                       uint8_t *buffer);
 };
 
 /**
@@ -1875,6 +1902,17 @@ int iso_write_opts_set_sort_files(IsoWriteOpts *opts, int sort);
  *                   time point when the last block was read for writing.
  *                   So there is high risk that the image stream was fed from
  *                   changing and possibly inconsistent file content.
+ *      If bit2 set: Check content stability (only with bit0) without reading
+ *                   the content twice. @since 1.3.2
+ *                   The size, the modification time, the inode change time
+ *                   and the inode number of the disk file get recorded before
+ *                   copying and compared with their values after copying.
+ *                   If they differ, then the MISHAP event of bit1 is issued.
+ *                   If the file was changed during the second in which the
+ *                   recording happened, then its timestamps cannot tell
+ *                   about further changes. Only such files get read for a
+ *                   MD5 as with bit1.
+ *                   Bit2 overrides bit1.
  *                   
  * @since 0.6.22
  */
@@ -2126,6 +2164,56 @@ int iso_write_opts_set_overwrite_buf(IsoWriteOpts *opts, uint8_t *overwrite);
  */
 int iso_write_opts_set_fifo_size(IsoWriteOpts *opts, size_t fifo_size);
 
+/**
+ * Let a pool of threads open, read and filter the content of data files
+ * ahead of the writer thread. This overlaps the latency of opening and
+ * reading the next files with the output of the current one. The content
+ * gets handed to the writer thread in the order of the image layout, so
+ * that the resulting image is the same as with serial reading.
+ * Data files from imported ISO images, files which are processed by
+ * external filter programs, and files which share their data source with
+ * another file in the pool are read by the writer thread itself.
+ *
+ * @param opts
+ *      The option set to be manipulated.
+ * @param num_readers
+ *      Number of reader threads. 0 disables read-ahead. Maximum is 64.
+ * @param prefetch_files
+ *      Number of data files which may be read ahead at the same time.
+ *      Values smaller than num_readers get raised to num_readers.
+ *      Maximum is 1024.
+ *      Each of these files may occupy up to 256 KiB of buffer memory.
+ * @return
+ *      1 success, < 0 error
+ *
+ * @since 1.3.2
+ */
+int iso_write_opts_set_file_readers(IsoWriteOpts *opts, int num_readers,
+                                    int prefetch_files);
+
+/**
+ * Write the content of data files with identical content only once and let
+ * all of them point to the same extents. This detects identity of content
+ * regardless of the disk file or stream which delivers the data.
+ * Candidates are grouped by size, then by the MD5 of their first 64 KiB,
+ * and finally compared by the MD5 of their full content. So each candidate
+ * with a size twin gets read once more before the image is written.
+ * Files from the old session of an appended image, El Torito boot images,
+ * and files which are claimed as partitions are not considered.
+ *
+ * @param opts
+ *      The option set to be manipulated.
+ * @param mode
+ *      0 = off (default): only files with the same data source share
+ *                         their extents
+ *      1 = on: files with identical content share their extents
+ * @return
+ *      1 success, < 0 error
+ *
+ * @since 1.3.2
+ */
+int iso_write_opts_set_dedup_content(IsoWriteOpts *opts, int mode);
+
 /*
  * Attach 32 kB of binary data which shall get written to the first 32 kB 
  * of the ISO image, the ECMA-119 System Area. This space is intended for
@@ -2668,6 +2756,31 @@ int iso_read_opts_set_no_md5(IsoReadOpts *opts, int no_md5);
  */
 int iso_read_opts_set_new_inos(IsoReadOpts *opts, int new_inos);
 
+/**
+ * Control whether iso_image_import() reads the whole directory tree or only
+ * the top level directory.
+ * With lazy loading, the other directories get read from the data source
+ * when their children are needed for the first time. This happens by
+ * iso_dir_get_children(), iso_dir_get_node(), iso_dir_add_node(),
+ * iso_tree_path_to_node(), and others. iso_image_create_burn_source()
+ * reads all directories which are still unread.
+ * So the data source has to stay readable as long as the image is in use.
+ * This is needed anyway for the content of the imported data files.
+ * Exclusion and hiding settings of the image get applied when a directory
+ * is read. Images with El Torito boot records get always loaded completely.
+ *
+ * @param opts
+ *       The option set to be manipulated
+ * @param lazy_dirs
+ *     1 = Read directories on demand.
+ *     0 = Read the whole tree by iso_image_import().
+ * @return
+ *     1 success, < 0 error
+ *
+ * @since 1.3.2
+ */
+int iso_read_opts_set_lazy_dirs(IsoReadOpts *opts, int lazy_dirs);
+
 /**
  * Whether to prefer Joliet over RR. libisofs usually prefers RR over
  * Joliet, as it give us much more info about files. So, if both extensions
@@ -6592,7 +6705,11 @@ int iso_zisofs_get_refcounts(off_t *ziso_count, off_t *osiz_count, int flag);
  */
 struct iso_zisofs_ctrl {
 
-    /* Set to 0 for this version of the structure */
+    /* Set to 0 or 1 for this version of the structure
+     * 0= only members up to .block_size_log2 are valid
+     * 1= members up to .compress_threads are valid
+     * @since 1.3.2
+     */
     int version;
 
     /* Compression level for zlib function compress2(). From <zlib.h>:
@@ -6607,12 +6724,26 @@ struct iso_zisofs_ctrl {
      */
     uint8_t block_size_log2;
 
+    /* ------------------- Only valid with .version >= 1 ------------------- */
+
+    /* Number of threads which compress the blocks of a data file
+     * concurrently. The compressed blocks get delivered in their original
+     * order, so that the filter output does not depend on this number.
+     * 1 lets the thread which reads the filter stream compress all blocks.
+     * Allowed values are 1 to 64. Default is 1.
+     * This may be changed while compression filters are installed.
+     * @since 1.3.2
+     */
+    int compress_threads;
+
 };
 
 /**
  * Set the global parameters for zisofs filtering.
  * This is only allowed while no zisofs compression filters are installed.
  * i.e. ziso_count returned by iso_zisofs_get_refcounts() has to be 0.
+ * Since 1.3.2 this restriction applies only if .compression_level or
+ * .block_size_log2 get changed.
  * @param params
  *      Pointer to a structure with the intended settings.
  * @param flag
@@ -6712,6 +6843,60 @@ int iso_file_add_gzip_filter(IsoFile *file, int flag);
 int iso_gzip_get_refcounts(off_t *gzip_count, off_t *gunzip_count, int flag);
 
 
+/**
+ * Set the global parameters for keeping the output of filters.
+ * The size of the output of zisofs, gzip and external filters is determined
+ * by a run of the filter over the whole input. If keeping is enabled, then
+ * this output gets stored in memory and in a temporary file, so that image
+ * writing can deliver it without running the filter a second time.
+ * The stored output of a stream is released when it has been read to its end
+ * once, or when the stream gets disposed.
+ * Streams which do not fit into the remaining budget get filtered twice,
+ * as without keeping.
+ * Note that the stored output does not notice changes of the input files
+ * after the size was determined.
+ * @param mem_limit
+ *      Maximum number of bytes to keep in memory for all streams together.
+ *      Default is 0.
+ * @param disk_limit
+ *      Maximum size of the temporary file for all streams together.
+ *      Default is 0. If both limits are 0, then keeping is disabled.
+ * @param tmp_dir
+ *      Directory where to create the temporary file. The file gets deleted
+ *      immediately after creation. NULL means the directory from
+ *      environment variable TMPDIR or "/tmp".
+ * @param flag
+ *      Bitfield for control purposes, unused yet, submit 0
+ * @return
+ *      1 on success, <0 on error
+ *
+ * @since 1.3.2
+ */
+int iso_filter_set_spill_params(off_t mem_limit, off_t disk_limit,
+                                char *tmp_dir, int flag);
+
+/**
+ * Get the current global parameters for keeping the output of filters and
+ * the amount of currently kept output.
+ * @param mem_limit
+ *      Will return the maximum number of bytes to keep in memory.
+ * @param disk_limit
+ *      Will return the maximum size of the temporary file.
+ * @param mem_used
+ *      Will return the number of bytes of memory which is in use.
+ * @param disk_used
+ *      Will return the current size of the temporary file.
+ * @param flag
+ *      Bitfield for control purposes, unused yet, submit 0
+ * @return
+ *      1 on success, <0 on error
+ *
+ * @since 1.3.2
+ */
+int iso_filter_get_spill_params(off_t *mem_limit, off_t *disk_limit,
+                                off_t *mem_used, off_t *disk_used, int flag);
+
+
 /* ---------------------------- MD5 Checksums --------------------------- */
 
 /* Production and loading of MD5 checksums is controlled by calls
@@ -7674,6 +7859,7 @@ struct burn_source {
 	    Versions:
 	     0  has .(*read)() != NULL, not even .version is present.
              1  has .version, .(*read_xt)(), .(*cancel)()
+             2  has .(*lend)(), .(*release)()
 	*/
 	int version;
 
@@ -7685,6 +7871,31 @@ struct burn_source {
 	    before (*free_data)() is called.
 	*/
 	int (*cancel)(struct burn_source *source);
+
+
+	/* @since 1.3.2 */
+	/** Valid only if .version is 2 or higher.
+	    Lend the consumer a pointer to the next data of the source instead
+	    of copying them into a buffer of the consumer. This saves a memory
+	    copy pass if the consumer can use the data where they are.
+	    The number of bytes lent may be smaller than size. It will not be
+	    larger. The data stay valid until (*release)() gets called.
+	    Only one lending may be active at a time. Between (*lend)() and
+	    (*release)() no (*read_xt)() shall be called.
+	    May be NULL if the source cannot lend. Then use (*read_xt)().
+	    @return  > 0 number of bytes lent at *buffer,
+	               0 end of data, -1 failure
+	*/
+	int (*lend)(struct burn_source *source, unsigned char **buffer,
+	            int size);
+
+	/** Valid only if .version is 2 or higher and (*lend)() is not NULL.
+	    End the most recent lending. The first size bytes of the lent data
+	    count as consumed. Any remaining lent bytes will be lent or read
+	    again by the next call.
+	    @return  1 success, <= 0 failure
+	*/
+	int (*release)(struct burn_source *source, int size);
 };
 
 #endif /* LIBISOFS_WITHOUT_LIBBURN */
@@ -194,6 +194,171 @@ static int md5__transform (uint32_t state[4], unsigned char block[64])
 }
 
 
+/* Transform two states based on the same block. The two dependency chains
+   are interleaved so that the processor can work on both at once.
+ */
+static int md5__transform_2(uint32_t state1[4], uint32_t state2[4],
+                            unsigned char block[64])
+{
+ uint32_t a1 = state1[0], b1 = state1[1], c1 = state1[2], d1 = state1[3];
+ uint32_t a2 = state2[0], b2 = state2[1], c2 = state2[2], d2 = state2[3];
+ uint32_t x[16];
+ unsigned int i, j;
+
+ for (i = 0, j = 0; j < 64; i++, j += 4)
+   x[i] = ((uint32_t)block[j]) | (((uint32_t)block[j+1]) << 8) |
+    (((uint32_t)block[j+2]) << 16) | (((uint32_t)block[j+3]) << 24);
+
+  /* Round 1 */
+  Libisofs_md5_FF (a1, b1, c1, d1, x[ 0], Libisofs_md5_S11, 0xd76aa478);
+  Libisofs_md5_FF (a2, b2, c2, d2, x[ 0], Libisofs_md5_S11, 0xd76aa478);
+  Libisofs_md5_FF (d1, a1, b1, c1, x[ 1], Libisofs_md5_S12, 0xe8c7b756);
+  Libisofs_md5_FF (d2, a2, b2, c2, x[ 1], Libisofs_md5_S12, 0xe8c7b756);
+  Libisofs_md5_FF (c1, d1, a1, b1, x[ 2], Libisofs_md5_S13, 0x242070db);
+  Libisofs_md5_FF (c2, d2, a2, b2, x[ 2], Libisofs_md5_S13, 0x242070db);
+  Libisofs_md5_FF (b1, c1, d1, a1, x[ 3], Libisofs_md5_S14, 0xc1bdceee);
+  Libisofs_md5_FF (b2, c2, d2, a2, x[ 3], Libisofs_md5_S14, 0xc1bdceee);
+  Libisofs_md5_FF (a1, b1, c1, d1, x[ 4], Libisofs_md5_S11, 0xf57c0faf);
+  Libisofs_md5_FF (a2, b2, c2, d2, x[ 4], Libisofs_md5_S11, 0xf57c0faf);
+  Libisofs_md5_FF (d1, a1, b1, c1, x[ 5], Libisofs_md5_S12, 0x4787c62a);
+  Libisofs_md5_FF (d2, a2, b2, c2, x[ 5], Libisofs_md5_S12, 0x4787c62a);
+  Libisofs_md5_FF (c1, d1, a1, b1, x[ 6], Libisofs_md5_S13, 0xa8304613);
+  Libisofs_md5_FF (c2, d2, a2, b2, x[ 6], Libisofs_md5_S13, 0xa8304613);
+  Libisofs_md5_FF (b1, c1, d1, a1, x[ 7], Libisofs_md5_S14, 0xfd469501);
+  Libisofs_md5_FF (b2, c2, d2, a2, x[ 7], Libisofs_md5_S14, 0xfd469501);
+  Libisofs_md5_FF (a1, b1, c1, d1, x[ 8], Libisofs_md5_S11, 0x698098d8);
+  Libisofs_md5_FF (a2, b2, c2, d2, x[ 8], Libisofs_md5_S11, 0x698098d8);
+  Libisofs_md5_FF (d1, a1, b1, c1, x[ 9], Libisofs_md5_S12, 0x8b44f7af);
+  Libisofs_md5_FF (d2, a2, b2, c2, x[ 9], Libisofs_md5_S12, 0x8b44f7af);
+  Libisofs_md5_FF (c1, d1, a1, b1, x[10], Libisofs_md5_S13, 0xffff5bb1);
+  Libisofs_md5_FF (c2, d2, a2, b2, x[10], Libisofs_md5_S13, 0xffff5bb1);
+  Libisofs_md5_FF (b1, c1, d1, a1, x[11], Libisofs_md5_S14, 0x895cd7be);
+  Libisofs_md5_FF (b2, c2, d2, a2, x[11], Libisofs_md5_S14, 0x895cd7be);
+  Libisofs_md5_FF (a1, b1, c1, d1, x[12], Libisofs_md5_S11, 0x6b901122);
+  Libisofs_md5_FF (a2, b2, c2, d2, x[12], Libisofs_md5_S11, 0x6b901122);
+  Libisofs_md5_FF (d1, a1, b1, c1, x[13], Libisofs_md5_S12, 0xfd987193);
+  Libisofs_md5_FF (d2, a2, b2, c2, x[13], Libisofs_md5_S12, 0xfd987193);
+  Libisofs_md5_FF (c1, d1, a1, b1, x[14], Libisofs_md5_S13, 0xa679438e);
+  Libisofs_md5_FF (c2, d2, a2, b2, x[14], Libisofs_md5_S13, 0xa679438e);
+  Libisofs_md5_FF (b1, c1, d1, a1, x[15], Libisofs_md5_S14, 0x49b40821);
+  Libisofs_md5_FF (b2, c2, d2, a2, x[15], Libisofs_md5_S14, 0x49b40821);
+
+  /* Round 2 */
+  Libisofs_md5_GG (a1, b1, c1, d1, x[ 1], Libisofs_md5_S21, 0xf61e2562);
+  Libisofs_md5_GG (a2, b2, c2, d2, x[ 1], Libisofs_md5_S21, 0xf61e2562);
+  Libisofs_md5_GG (d1, a1, b1, c1, x[ 6], Libisofs_md5_S22, 0xc040b340);
+  Libisofs_md5_GG (d2, a2, b2, c2, x[ 6], Libisofs_md5_S22, 0xc040b340);
+  Libisofs_md5_GG (c1, d1, a1, b1, x[11], Libisofs_md5_S23, 0x265e5a51);
+  Libisofs_md5_GG (c2, d2, a2, b2, x[11], Libisofs_md5_S23, 0x265e5a51);
+  Libisofs_md5_GG (b1, c1, d1, a1, x[ 0], Libisofs_md5_S24, 0xe9b6c7aa);
+  Libisofs_md5_GG (b2, c2, d2, a2, x[ 0], Libisofs_md5_S24, 0xe9b6c7aa);
+  Libisofs_md5_GG (a1, b1, c1, d1, x[ 5], Libisofs_md5_S21, 0xd62f105d);
+  Libisofs_md5_GG (a2, b2, c2, d2, x[ 5], Libisofs_md5_S21, 0xd62f105d);
+  Libisofs_md5_GG (d1, a1, b1, c1, x[10], Libisofs_md5_S22, 0x2441453);
+  Libisofs_md5_GG (d2, a2, b2, c2, x[10], Libisofs_md5_S22, 0x2441453);
+  Libisofs_md5_GG (c1, d1, a1, b1, x[15], Libisofs_md5_S23, 0xd8a1e681);
+  Libisofs_md5_GG (c2, d2, a2, b2, x[15], Libisofs_md5_S23, 0xd8a1e681);
+  Libisofs_md5_GG (b1, c1, d1, a1, x[ 4], Libisofs_md5_S24, 0xe7d3fbc8);
+  Libisofs_md5_GG (b2, c2, d2, a2, x[ 4], Libisofs_md5_S24, 0xe7d3fbc8);
+  Libisofs_md5_GG (a1, b1, c1, d1, x[ 9], Libisofs_md5_S21, 0x21e1cde6);
+  Libisofs_md5_GG (a2, b2, c2, d2, x[ 9], Libisofs_md5_S21, 0x21e1cde6);
+  Libisofs_md5_GG (d1, a1, b1, c1, x[14], Libisofs_md5_S22, 0xc33707d6);
+  Libisofs_md5_GG (d2, a2, b2, c2, x[14], Libisofs_md5_S22, 0xc33707d6);
+  Libisofs_md5_GG (c1, d1, a1, b1, x[ 3], Libisofs_md5_S23, 0xf4d50d87);
+  Libisofs_md5_GG (c2, d2, a2, b2, x[ 3], Libisofs_md5_S23, 0xf4d50d87);
+  Libisofs_md5_GG (b1, c1, d1, a1, x[ 8], Libisofs_md5_S24, 0x455a14ed);
+  Libisofs_md5_GG (b2, c2, d2, a2, x[ 8], Libisofs_md5_S24, 0x455a14ed);
+  Libisofs_md5_GG (a1, b1, c1, d1, x[13], Libisofs_md5_S21, 0xa9e3e905);
+  Libisofs_md5_GG (a2, b2, c2, d2, x[13], Libisofs_md5_S21, 0xa9e3e905);
+  Libisofs_md5_GG (d1, a1, b1, c1, x[ 2], Libisofs_md5_S22, 0xfcefa3f8);
+  Libisofs_md5_GG (d2, a2, b2, c2, x[ 2], Libisofs_md5_S22, 0xfcefa3f8);
+  Libisofs_md5_GG (c1, d1, a1, b1, x[ 7], Libisofs_md5_S23, 0x676f02d9);
+  Libisofs_md5_GG (c2, d2, a2, b2, x[ 7], Libisofs_md5_S23, 0x676f02d9);
+  Libisofs_md5_GG (b1, c1, d1, a1, x[12], Libisofs_md5_S24, 0x8d2a4c8a);
+  Libisofs_md5_GG (b2, c2, d2, a2, x[12], Libisofs_md5_S24, 0x8d2a4c8a);
+
+  /* Round 3 */
+  Libisofs_md5_HH (a1, b1, c1, d1, x[ 5], Libisofs_md5_S31, 0xfffa3942);
+  Libisofs_md5_HH (a2, b2, c2, d2, x[ 5], Libisofs_md5_S31, 0xfffa3942);
+  Libisofs_md5_HH (d1, a1, b1, c1, x[ 8], Libisofs_md5_S32, 0x8771f681);
+  Libisofs_md5_HH (d2, a2, b2, c2, x[ 8], Libisofs_md5_S32, 0x8771f681);
+  Libisofs_md5_HH (c1, d1, a1, b1, x[11], Libisofs_md5_S33, 0x6d9d6122);
+  Libisofs_md5_HH (c2, d2, a2, b2, x[11], Libisofs_md5_S33, 0x6d9d6122);
+  Libisofs_md5_HH (b1, c1, d1, a1, x[14], Libisofs_md5_S34, 0xfde5380c);
+  Libisofs_md5_HH (b2, c2, d2, a2, x[14], Libisofs_md5_S34, 0xfde5380c);
+  Libisofs_md5_HH (a1, b1, c1, d1, x[ 1], Libisofs_md5_S31, 0xa4beea44);
+  Libisofs_md5_HH (a2, b2, c2, d2, x[ 1], Libisofs_md5_S31, 0xa4beea44);
+  Libisofs_md5_HH (d1, a1, b1, c1, x[ 4], Libisofs_md5_S32, 0x4bdecfa9);
+  Libisofs_md5_HH (d2, a2, b2, c2, x[ 4], Libisofs_md5_S32, 0x4bdecfa9);
+  Libisofs_md5_HH (c1, d1, a1, b1, x[ 7], Libisofs_md5_S33, 0xf6bb4b60);
+  Libisofs_md5_HH (c2, d2, a2, b2, x[ 7], Libisofs_md5_S33, 0xf6bb4b60);
+  Libisofs_md5_HH (b1, c1, d1, a1, x[10], Libisofs_md5_S34, 0xbebfbc70);
+  Libisofs_md5_HH (b2, c2, d2, a2, x[10], Libisofs_md5_S34, 0xbebfbc70);
+  Libisofs_md5_HH (a1, b1, c1, d1, x[13], Libisofs_md5_S31, 0x289b7ec6);
+  Libisofs_md5_HH (a2, b2, c2, d2, x[13], Libisofs_md5_S31, 0x289b7ec6);
+  Libisofs_md5_HH (d1, a1, b1, c1, x[ 0], Libisofs_md5_S32, 0xeaa127fa);
+  Libisofs_md5_HH (d2, a2, b2, c2, x[ 0], Libisofs_md5_S32, 0xeaa127fa);
+  Libisofs_md5_HH (c1, d1, a1, b1, x[ 3], Libisofs_md5_S33, 0xd4ef3085);
+  Libisofs_md5_HH (c2, d2, a2, b2, x[ 3], Libisofs_md5_S33, 0xd4ef3085);
+  Libisofs_md5_HH (b1, c1, d1, a1, x[ 6], Libisofs_md5_S34, 0x4881d05);
+  Libisofs_md5_HH (b2, c2, d2, a2, x[ 6], Libisofs_md5_S34, 0x4881d05);
+  Libisofs_md5_HH (a1, b1, c1, d1, x[ 9], Libisofs_md5_S31, 0xd9d4d039);
+  Libisofs_md5_HH (a2, b2, c2, d2, x[ 9], Libisofs_md5_S31, 0xd9d4d039);
+  Libisofs_md5_HH (d1, a1, b1, c1, x[12], Libisofs_md5_S32, 0xe6db99e5);
+  Libisofs_md5_HH (d2, a2, b2, c2, x[12], Libisofs_md5_S32, 0xe6db99e5);
+  Libisofs_md5_HH (c1, d1, a1, b1, x[15], Libisofs_md5_S33, 0x1fa27cf8);
+  Libisofs_md5_HH (c2, d2, a2, b2, x[15], Libisofs_md5_S33, 0x1fa27cf8);
+  Libisofs_md5_HH (b1, c1, d1, a1, x[ 2], Libisofs_md5_S34, 0xc4ac5665);
+  Libisofs_md5_HH (b2, c2, d2, a2, x[ 2], Libisofs_md5_S34, 0xc4ac5665);
+
+  /* Round 4 */
+  Libisofs_md5_II (a1, b1, c1, d1, x[ 0], Libisofs_md5_S41, 0xf4292244);
+  Libisofs_md5_II (a2, b2, c2, d2, x[ 0], Libisofs_md5_S41, 0xf4292244);
+  Libisofs_md5_II (d1, a1, b1, c1, x[ 7], Libisofs_md5_S42, 0x432aff97);
+  Libisofs_md5_II (d2, a2, b2, c2, x[ 7], Libisofs_md5_S42, 0x432aff97);
+  Libisofs_md5_II (c1, d1, a1, b1, x[14], Libisofs_md5_S43, 0xab9423a7);
+  Libisofs_md5_II (c2, d2, a2, b2, x[14], Libisofs_md5_S43, 0xab9423a7);
+  Libisofs_md5_II (b1, c1, d1, a1, x[ 5], Libisofs_md5_S44, 0xfc93a039);
+  Libisofs_md5_II (b2, c2, d2, a2, x[ 5], Libisofs_md5_S44, 0xfc93a039);
+  Libisofs_md5_II (a1, b1, c1, d1, x[12], Libisofs_md5_S41, 0x655b59c3);
+  Libisofs_md5_II (a2, b2, c2, d2, x[12], Libisofs_md5_S41, 0x655b59c3);
+  Libisofs_md5_II (d1, a1, b1, c1, x[ 3], Libisofs_md5_S42, 0x8f0ccc92);
+  Libisofs_md5_II (d2, a2, b2, c2, x[ 3], Libisofs_md5_S42, 0x8f0ccc92);
+  Libisofs_md5_II (c1, d1, a1, b1, x[10], Libisofs_md5_S43, 0xffeff47d);
+  Libisofs_md5_II (c2, d2, a2, b2, x[10], Libisofs_md5_S43, 0xffeff47d);
+  Libisofs_md5_II (b1, c1, d1, a1, x[ 1], Libisofs_md5_S44, 0x85845dd1);
+  Libisofs_md5_II (b2, c2, d2, a2, x[ 1], Libisofs_md5_S44, 0x85845dd1);
+  Libisofs_md5_II (a1, b1, c1, d1, x[ 8], Libisofs_md5_S41, 0x6fa87e4f);
+  Libisofs_md5_II (a2, b2, c2, d2, x[ 8], Libisofs_md5_S41, 0x6fa87e4f);
+  Libisofs_md5_II (d1, a1, b1, c1, x[15], Libisofs_md5_S42, 0xfe2ce6e0);
+  Libisofs_md5_II (d2, a2, b2, c2, x[15], Libisofs_md5_S42, 0xfe2ce6e0);
+  Libisofs_md5_II (c1, d1, a1, b1, x[ 6], Libisofs_md5_S43, 0xa3014314);
+  Libisofs_md5_II (c2, d2, a2, b2, x[ 6], Libisofs_md5_S43, 0xa3014314);
+  Libisofs_md5_II (b1, c1, d1, a1, x[13], Libisofs_md5_S44, 0x4e0811a1);
+  Libisofs_md5_II (b2, c2, d2, a2, x[13], Libisofs_md5_S44, 0x4e0811a1);
+  Libisofs_md5_II (a1, b1, c1, d1, x[ 4], Libisofs_md5_S41, 0xf7537e82);
+  Libisofs_md5_II (a2, b2, c2, d2, x[ 4], Libisofs_md5_S41, 0xf7537e82);
+  Libisofs_md5_II (d1, a1, b1, c1, x[11], Libisofs_md5_S42, 0xbd3af235);
+  Libisofs_md5_II (d2, a2, b2, c2, x[11], Libisofs_md5_S42, 0xbd3af235);
+  Libisofs_md5_II (c1, d1, a1, b1, x[ 2], Libisofs_md5_S43, 0x2ad7d2bb);
+  Libisofs_md5_II (c2, d2, a2, b2, x[ 2], Libisofs_md5_S43, 0x2ad7d2bb);
+  Libisofs_md5_II (b1, c1, d1, a1, x[ 9], Libisofs_md5_S44, 0xeb86d391);
+  Libisofs_md5_II (b2, c2, d2, a2, x[ 9], Libisofs_md5_S44, 0xeb86d391);
+
+  state1[0] += a1;
+  state1[1] += b1;
+  state1[2] += c1;
+  state1[3] += d1;
+  state2[0] += a2;
+  state2[1] += b2;
+  state2[2] += c2;
+  state2[3] += d2;
+
+  memset ((char *) x, 0, sizeof (x));
+  return(1);
+}
+
+
 static int md5__encode(unsigned char *output, uint32_t *input,
                        unsigned int len)
 {
@@ -257,6 +422,50 @@ static int md5_update(libisofs_md5_ctx *ctx, unsigned char *data,
 }
 
 
+/* Update two contexts by the same data. If both are at the same position
+   within their 64 byte blocks, then the full blocks get transformed for
+   both contexts in one pass.
+ */
+static int md5_update_2(libisofs_md5_ctx *ctx1, libisofs_md5_ctx *ctx2,
+                        unsigned char *data, int datalen, int flag)
+{
+ int i, index, partlen;
+
+ index = ((ctx1->count[0] >> 3) & 0x3F);
+ if (index != (int) ((ctx2->count[0] >> 3) & 0x3F) || datalen < 128) {
+   md5_update(ctx1, data, datalen, 0);
+   md5_update(ctx2, data, datalen, 0);
+   return(1);
+ }
+ if ((ctx1->count[0] += ((uint32_t) datalen << 3)) <
+     ((uint32_t) datalen << 3))
+   ctx1->count[1]++;
+ ctx1->count[1] += ((uint32_t) datalen >> 29);
+ if ((ctx2->count[0] += ((uint32_t) datalen << 3)) <
+     ((uint32_t) datalen << 3))
+   ctx2->count[1]++;
+ ctx2->count[1] += ((uint32_t) datalen >> 29);
+ partlen = 64 - index;
+
+ /* datalen >= 128 > partlen */
+ if (index > 0) {
+   memcpy((char *) &ctx1->buffer[index], (char *) data, partlen);
+   memcpy((char *) &ctx2->buffer[index], (char *) data, partlen);
+   md5__transform(ctx1->state, ctx1->buffer);
+   md5__transform(ctx2->state, ctx2->buffer);
+   i = partlen;
+ } else {
+   i = 0;
+ }
+ for (; i + 63 < datalen; i += 64)
+   md5__transform_2(ctx1->state, ctx2->state, &data[i]);
+
+ memcpy((char *) ctx1->buffer, (char *) &data[i], datalen - i);
+ memcpy((char *) ctx2->buffer, (char *) &data[i], datalen - i);
+ return(1);
+}
+
+
 static int md5_final(libisofs_md5_ctx *ctx, char result[16], int flag)
 {
  unsigned char bits[8], *respt;
@@ -373,6 +582,19 @@ int iso_md5_compute(void *md5_context, char *data, int datalen)
 }
 
 
+int iso_md5_compute_2(void *md5_context_1, void *md5_context_2,
+                      char *data, int datalen)
+{
+    if (md5_context_1 == NULL || md5_context_2 == NULL)
+        return ISO_NULL_POINTER;
+    if (datalen > 0)
+        md5_update_2((libisofs_md5_ctx *) md5_context_1,
+                     (libisofs_md5_ctx *) md5_context_2,
+                     (unsigned char *) data, datalen, 0);
+    return 1;
+}
+
+
 /* API */
 int iso_md5_clone(void *old_md5_context, void **new_md5_context)
 {
@@ -14,6 +14,16 @@
 /* The MD5 computation API is in libisofs.h : iso_md5_start() et.al. */
 
 
+/* Add the same data to two MD5 contexts, like two calls of
+   iso_md5_compute() would do, but in a single pass over the data.
+   Used when file content goes into the file checksum and the session
+   checksum at the same time.
+   @return 1 on success, ISO_NULL_POINTER if a context is missing
+*/
+int iso_md5_compute_2(void *md5_context_1, void *md5_context_2,
+                      char *data, int datalen);
+
+
 /** Create a writer object for checksums and add it to the writer list of
     the given Ecma119Image.
 */
@@ -38,6 +38,7 @@
 
 #include "util.h"
 #include "node.h"
+#include "filter.h"
 
 
 /*
@@ -231,6 +232,8 @@ void iso_finish()
 {
     libiso_msgs_destroy(&libiso_msgr, 0);
     iso_node_xinfo_dispose_cloners(0);
+    iso_iconv_cache_dispose(0);
+    ziso_pool_dispose(0);
 }
 
 int iso_set_abort_severity(char *severity)
@@ -40,6 +40,68 @@ struct dir_iter_data
     int flag;
 };
 
+/* Directories with at least this number of children get an index for
+   looking up children by name. Smaller ones are searched along the list.
+*/
+#define Libisofs_dir_index_thresholD 64
+
+
+static
+int iso_dir_index_cmp(const void *a, const void *b)
+{
+    return strcmp(((IsoNode *) a)->name, ((IsoNode *) b)->name);
+}
+
+static
+void iso_dir_drop_index(IsoDir *dir)
+{
+    if (dir->index == NULL)
+        return;
+    iso_rbtree_destroy(dir->index, NULL);
+    dir->index = NULL;
+}
+
+/* The index is only an accelerator. If it cannot be maintained, it gets
+   dropped and the list gets searched.
+*/
+static
+void iso_dir_make_index(IsoDir *dir)
+{
+    int ret;
+    IsoNode *pos;
+
+    ret = iso_rbtree_new(iso_dir_index_cmp, &dir->index);
+    if (ret < 0) {
+        dir->index = NULL;
+        return;
+    }
+    for (pos = dir->children; pos != NULL; pos = pos->next) {
+        ret = iso_rbtree_insert(dir->index, pos, NULL);
+        if (ret < 0) {
+            iso_dir_drop_index(dir);
+            return;
+        }
+    }
+}
+
+static
+void iso_dir_index_add(IsoDir *dir, IsoNode *node)
+{
+    if (dir->index == NULL)
+        return;
+    if (iso_rbtree_insert(dir->index, node, NULL) < 0)
+        iso_dir_drop_index(dir);
+}
+
+static
+void iso_dir_index_remove(IsoDir *dir, IsoNode *node)
+{
+    if (dir->index == NULL)
+        return;
+    if (iso_rbtree_remove(dir->index, node, NULL) < 0)
+        iso_dir_drop_index(dir);
+}
+
 /**
  * Increments the reference counting of the given node.
  */
@@ -62,6 +124,8 @@ void iso_node_unref(IsoNode *node)
         case LIBISO_DIR:
             {
                 IsoNode *child = ((IsoDir*)node)->children;
+                iso_dir_drop_index((IsoDir*)node);
+                iso_dir_free_lazy((IsoDir*)node);
                 while (child != NULL) {
                     IsoNode *tmp = child->next;
                     child->parent = NULL;
@@ -105,8 +169,8 @@ void iso_node_unref(IsoNode *node)
                 info = tmp;
             }
         }
-        free(node->name);
-        free(node);
+        iso_str_release(node->name);
+        iso_pool_free(node, iso_node_struct_size(node->type));
     }
 }
 
@@ -350,22 +414,26 @@ int iso_node_set_name(IsoNode *node, const char *name)
         }
     }
 
-    new = strdup(name);
+    new = iso_str_intern(name);
     if (new == NULL) {
         return ISO_OUT_OF_MEM;
     }
-    free(node->name);
-    node->name = new;
     if (node->parent != NULL) {
         IsoDir *parent;
         int res;
-        /* take and add again to ensure correct children order */
+        /* take and add again to ensure correct children order.
+           The node has to be taken under its old name. */
         parent = node->parent;
         iso_node_take(node);
+        iso_str_release(node->name);
+        node->name = new;
         res = iso_dir_add_node(parent, node, 0);
         if (res < 0) {
             return res;
         }
+    } else {
+        iso_str_release(node->name);
+        node->name = new;
     }
     return ISO_SUCCESS;
 }
@@ -620,9 +688,16 @@ int iso_dir_get_node(IsoDir *dir, const char *name, IsoNode **node)
  */
 int iso_dir_get_children_count(IsoDir *dir)
 {
+    int ret;
+
     if (dir == NULL) {
         return ISO_NULL_POINTER;
     }
+    if (dir->lazy != NULL) {
+        ret = iso_dir_load_lazy(dir, 0);
+        if (ret < 0)
+            return ret;
+    }
     return dir->nchildren;
 }
 
@@ -713,6 +788,12 @@ void iter_free(IsoDirIter *iter)
 static IsoNode** iso_dir_find_node(IsoDir *dir, IsoNode *node)
 {
     IsoNode **pos;
+
+    if (dir->index != NULL) {
+        iso_dir_find(dir, node->name, &pos);
+        if (*pos == node)
+            return pos;
+    }
     pos = &(dir->children);
     while (*pos != NULL && *pos != node) {
         pos = &((*pos)->next);
@@ -754,6 +835,7 @@ int iso_node_take(IsoNode *node)
     iso_notify_dir_iters(node, 0);
 
     *pos = node->next;
+    iso_dir_index_remove(dir, node);
     node->parent = NULL;
     node->next = NULL;
     dir->nchildren--;
@@ -922,12 +1004,18 @@ struct iso_dir_iter_iface iter_class = {
 
 int iso_dir_get_children(const IsoDir *dir, IsoDirIter **iter)
 {
+    int ret;
     IsoDirIter *it;
     struct dir_iter_data *data;
 
     if (dir == NULL || iter == NULL) {
         return ISO_NULL_POINTER;
     }
+    if (dir->lazy != NULL) {
+        ret = iso_dir_load_lazy((IsoDir *) dir, 0);
+        if (ret < 0)
+            return ret;
+    }
     it = malloc(sizeof(IsoDirIter));
     if (it == NULL) {
         return ISO_OUT_OF_MEM;
@@ -1041,7 +1129,13 @@ int iso_symlink_set_dest(IsoSymlink *link, const char *dest)
 void iso_node_set_sort_weight(IsoNode *node, int w)
 {
     if (node->type == LIBISO_DIR) {
-        IsoNode *child = ((IsoDir*)node)->children;
+        IsoNode *child;
+
+        /* A load error gets recorded and reported when the image is
+           written */
+        if (((IsoDir*)node)->lazy != NULL)
+            iso_dir_load_lazy((IsoDir*)node, 0);
+        child = ((IsoDir*)node)->children;
         while (child) {
             iso_node_set_sort_weight(child, w);
             child = child->next;
@@ -1239,6 +1333,24 @@ int iso_node_is_valid_link_dest(const char *dest)
 
 void iso_dir_find(IsoDir *dir, const char *name, IsoNode ***pos)
 {
+    IsoNode key, *lower;
+
+    /* A load error gets recorded and reported when the image is written */
+    if (dir->lazy != NULL)
+        iso_dir_load_lazy(dir, 0);
+    if (dir->index == NULL && dir->nchildren >= Libisofs_dir_index_thresholD)
+        iso_dir_make_index(dir);
+    if (dir->index != NULL) {
+        /* The list is sorted like the index. So the node goes after the
+           greatest node with a smaller name. */
+        key.name = (char *) name;
+        iso_rbtree_find(dir->index, &key, NULL, (void **) &lower);
+        if (lower == NULL)
+            *pos = &(dir->children);
+        else
+            *pos = &(lower->next);
+        return;
+    }
     *pos = &(dir->children);
     while (**pos != NULL && strcmp((**pos)->name, name) < 0) {
         *pos = &((**pos)->next);
@@ -1290,18 +1402,21 @@ int iso_dir_insert(IsoDir *dir, IsoNode *node, IsoNode **pos,
         }
 
         /* if we are reach here we have to replace */
+        iso_dir_index_remove(dir, *pos);
         node->next = (*pos)->next;
         (*pos)->parent = NULL;
         (*pos)->next = NULL;
         iso_node_unref(*pos);
         *pos = node;
         node->parent = dir;
+        iso_dir_index_add(dir, node);
         return dir->nchildren;
     }
 
     node->next = *pos;
     *pos = node;
     node->parent = dir;
+    iso_dir_index_add(dir, node);
 
     return ++dir->nchildren;
 }
@@ -1363,16 +1478,59 @@ void iso_notify_dir_iters(IsoNode *node, int flag)
     }
 }
 
+size_t iso_node_struct_size(enum IsoNodeType type)
+{
+    switch (type) {
+    case LIBISO_DIR:
+        return sizeof(IsoDir);
+    case LIBISO_FILE:
+        return sizeof(IsoFile);
+    case LIBISO_SYMLINK:
+        return sizeof(IsoSymlink);
+    case LIBISO_SPECIAL:
+        return sizeof(IsoSpecial);
+    case LIBISO_BOOT:
+        return sizeof(IsoBoot);
+    }
+    return sizeof(IsoNode);
+}
+
+IsoNode *iso_node_alloc(enum IsoNodeType type)
+{
+    IsoNode *node;
+
+    node = iso_pool_alloc(iso_node_struct_size(type));
+    if (node == NULL)
+        return NULL;
+    node->type = type;
+    return node;
+}
+
+/*
+ * Replace the malloc()ed name which was handed over to one of the
+ * iso_node_new_*() functions by its shared copy.
+ */
+static
+int iso_node_adopt_name(IsoNode *node, char *name)
+{
+    node->name = iso_str_intern(name);
+    if (node->name == NULL) {
+        iso_pool_free(node, iso_node_struct_size(node->type));
+        return ISO_OUT_OF_MEM;
+    }
+    free(name);
+    return ISO_SUCCESS;
+}
+
 int iso_node_new_root(IsoDir **root)
 {
     IsoDir *dir;
 
-    dir = calloc(1, sizeof(IsoDir));
+    dir = (IsoDir *) iso_node_alloc(LIBISO_DIR);
     if (dir == NULL) {
         return ISO_OUT_OF_MEM;
     }
     dir->node.refcount = 1;
-    dir->node.type = LIBISO_DIR;
     dir->node.atime = dir->node.ctime = dir->node.mtime = time(NULL);
     dir->node.mode = S_IFDIR | 0555;
 
@@ -1396,13 +1554,14 @@ int iso_node_new_dir(char *name, IsoDir **dir)
     if (ret < 0)
         return ret;
 
-    new = calloc(1, sizeof(IsoDir));
+    new = (IsoDir *) iso_node_alloc(LIBISO_DIR);
     if (new == NULL) {
         return ISO_OUT_OF_MEM;
     }
+    ret = iso_node_adopt_name((IsoNode *) new, name);
+    if (ret < 0)
+        return ret;
     new->node.refcount = 1;
-    new->node.type = LIBISO_DIR;
-    new->node.name = name;
     new->node.mode = S_IFDIR;
     *dir = new;
     return ISO_SUCCESS;
@@ -1422,13 +1581,14 @@ int iso_node_new_file(char *name, IsoStream *stream, IsoFile **file)
     if (ret < 0)
         return ret;
 
-    new = calloc(1, sizeof(IsoFile));
+    new = (IsoFile *) iso_node_alloc(LIBISO_FILE);
     if (new == NULL) {
         return ISO_OUT_OF_MEM;
     }
+    ret = iso_node_adopt_name((IsoNode *) new, name);
+    if (ret < 0)
+        return ret;
     new->node.refcount = 1;
-    new->node.type = LIBISO_FILE;
-    new->node.name = name;
     new->node.mode = S_IFREG;
     new->sort_weight = 0;
     new->stream = stream;
@@ -1456,13 +1616,14 @@ int iso_node_new_symlink(char *name, char *dest, IsoSymlink **link)
     if (ret < 0) 
         return ret;
 
-    new = calloc(1, sizeof(IsoSymlink));
+    new = (IsoSymlink *) iso_node_alloc(LIBISO_SYMLINK);
     if (new == NULL) {
         return ISO_OUT_OF_MEM;
     }
+    ret = iso_node_adopt_name((IsoNode *) new, name);
+    if (ret < 0)
+        return ret;
     new->node.refcount = 1;
-    new->node.type = LIBISO_SYMLINK;
-    new->node.name = name;
     new->dest = dest;
     new->node.mode = S_IFLNK;
     new->fs_id = 0;
@@ -1490,13 +1651,14 @@ int iso_node_new_special(char *name, mode_t mode, dev_t dev,
     if (ret < 0)
         return ret;
 
-    new = calloc(1, sizeof(IsoSpecial));
+    new = (IsoSpecial *) iso_node_alloc(LIBISO_SPECIAL);
     if (new == NULL) {
         return ISO_OUT_OF_MEM;
     }
+    ret = iso_node_adopt_name((IsoNode *) new, name);
+    if (ret < 0)
+        return ret;
     new->node.refcount = 1;
-    new->node.type = LIBISO_SPECIAL;
-    new->node.name = name;
 
     new->node.mode = mode;
     new->dev = dev;
@@ -2393,6 +2555,11 @@ int iso_node_zf_by_magic(IsoNode *node, int flag)
         return 0;
 
     dir = (IsoDir *) node;
+    if (dir->lazy != NULL) {
+        ret = iso_dir_load_lazy(dir, 0);
+        if (ret < 0)
+            return ret;
+    }
     pos = dir->children;
     while (pos) {
         ret = 1;
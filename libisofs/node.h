@@ -142,6 +142,18 @@ struct Iso_Dir
 
     size_t nchildren; /**< The number of children of this directory. */
     IsoNode *children; /**< list of children. ptr to first child */
+
+    /**
+     * Index of the children by name. It gets created on demand when the
+     * directory has many children. The list stays the owner of the nodes.
+     */
+    struct iso_rbtree *index;
+
+    /**
+     * Not NULL if the children were not read yet from the imported ISO
+     * image. See iso_read_opts_set_lazy_dirs().
+     */
+    struct iso_lazy_dir *lazy;
 };
 
 /* IMPORTANT: Any change must be reflected by iso_tree_clone_file. */
@@ -221,6 +233,21 @@ struct Iso_Dir_Iter
     void *data;
 };
 
+/**
+ * Get the size of the struct which represents a node of the given type.
+ */
+size_t iso_node_struct_size(enum IsoNodeType type);
+
+/**
+ * Get zeroed memory for a node of the given type from the pool of small
+ * objects and set its type. The name has to be set by iso_str_intern().
+ * The node gets freed by iso_node_unref().
+ *
+ * @return
+ *      The new node or NULL if out of memory
+ */
+IsoNode *iso_node_alloc(enum IsoNodeType type);
+
 int iso_node_new_root(IsoDir **root);
 
 /**
@@ -228,9 +255,8 @@ int iso_node_new_root(IsoDir **root);
  * default (0) values. You must set them.
  *
  * @param name
- *      Name for the node. It is not strdup() so you shouldn't use this
- *      reference when this function returns successfully. NULL is not
- *      allowed.
+ *      Name for the node. It gets replaced by its shared copy and freed
+ *      when this function returns successfully. NULL is not allowed.
  * @param dir
  *
  * @return
@@ -243,9 +269,8 @@ int iso_node_new_dir(char *name, IsoDir **dir);
  * default (0) values. You must set them.
  *
  * @param name
- *      Name for the node. It is not strdup() so you shouldn't use this
- *      reference when this function returns successfully. NULL is not
- *      allowed.
+ *      Name for the node. It gets replaced by its shared copy and freed
+ *      when this function returns successfully. NULL is not allowed.
  * @param stream
  *      Source for file contents. The reference is taken by the node,
  *      you must call iso_stream_ref() if you need your own ref.
@@ -259,9 +284,8 @@ int iso_node_new_file(char *name, IsoStream *stream, IsoFile **file);
  * to default (0) values. You must set them.
  *
  * @param name
- *      name for the new symlink. It is not strdup() so you shouldn't use this
- *      reference when this function returns successfully. NULL is not
- *      allowed.
+ *      name for the new symlink. It gets replaced by its shared copy and
+ *      freed when this function returns successfully. NULL is not allowed.
  * @param dest
  *      destination of the link. It is not strdup() so you shouldn't use this
  *      reference when this function returns successfully. NULL is not
@@ -287,8 +311,8 @@ int iso_node_new_symlink(char *name, char *dest, IsoSymlink **link);
  * later.
  *
  * @param name
- *      name for the new special file. It is not strdup() so you shouldn't use
- *      this reference when this function returns successfully. NULL is not
+ *      name for the new special file. It gets replaced by its shared copy
+ *      and freed when this function returns successfully. NULL is not
  *      allowed.
  * @param mode
  *      file type and permissions for the new node. Note that you can't
@@ -536,4 +560,34 @@ int zisofs_zf_xinfo_func(void *data, int flag);
 int zisofs_zf_xinfo_cloner(void *old_data, void **new_data, int flag);
 
 
+/* Lazy loading of imported directories. Implemented in fs_image.c. */
+
+/**
+ * Read the children of a directory which was imported by
+ * iso_image_import() with iso_read_opts_set_lazy_dirs() enabled.
+ * Directories among the children get marked as not loaded yet.
+ * The functions which look at the children of a directory call this
+ * before they do.
+ *
+ * @param flag
+ *      bit0= also load all directories underneath
+ * @return
+ *      1 success, 0 nothing to do, < 0 error
+ */
+int iso_dir_load_lazy(IsoDir *dir, int flag);
+
+/**
+ * Mark a directory as not loaded yet. Its children will be read from the
+ * given directory file source on first access.
+ * To be called only while iso_add_dir_src_rec() runs with flag bit0.
+ */
+int iso_dir_set_lazy(IsoImage *image, IsoDir *dir, IsoFileSource *src);
+
+/**
+ * Release the reference to the file source of a directory which never
+ * got loaded.
+ */
+void iso_dir_free_lazy(IsoDir *dir);
+
+
 #endif /*LIBISO_NODE_H_*/
@@ -51,20 +51,40 @@ int susp_append(Ecma119Image *t, struct susp_info *susp, uint8_t *data)
     return ISO_SUCCESS;
 }
 
+/* Copy a field to the end of the CE area buffer. data stays owned by the
+   caller.
+*/
 static
-int susp_append_ce(Ecma119Image *t, struct susp_info *susp, uint8_t *data)
+int susp_copy_ce(Ecma119Image *t, struct susp_info *susp, uint8_t *data)
 {
-    susp->n_ce_susp_fields++;
-    susp->ce_susp_fields = realloc(susp->ce_susp_fields, sizeof(void*)
-                                   * susp->n_ce_susp_fields);
-    if (susp->ce_susp_fields == NULL) {
-        return ISO_OUT_OF_MEM;
+    size_t new_size;
+    uint8_t *new_buf;
+
+    if (susp->ce_len + data[2] > susp->ce_buf_size) {
+        new_size = susp->ce_buf_size * 2;
+        if (new_size < susp->ce_len + data[2])
+            new_size = ROUND_UP(susp->ce_len + data[2], BLOCK_SIZE);
+        new_buf = realloc(susp->ce_buf, new_size);
+        if (new_buf == NULL)
+            return ISO_OUT_OF_MEM;
+        susp->ce_buf = new_buf;
+        susp->ce_buf_size = new_size;
     }
-    susp->ce_susp_fields[susp->n_ce_susp_fields - 1] = data;
+    memcpy(susp->ce_buf + susp->ce_len, data, data[2]);
     susp->ce_len += data[2];
     return ISO_SUCCESS;
 }
 
+static
+int susp_append_ce(Ecma119Image *t, struct susp_info *susp, uint8_t *data)
+{
+    int ret;
+
+    ret = susp_copy_ce(t, susp, data);
+    free(data);
+    return ret;
+}
+
 static
 uid_t px_get_uid(Ecma119Image *t, Ecma119Node *n)
 {
@@ -536,7 +556,7 @@ int rrip_add_SL(Ecma119Image *t, struct susp_info *susp, uint8_t **comp,
 */
 static
 int aaip_add_AL(Ecma119Image *t, struct susp_info *susp,
-                uint8_t **data, size_t num_data,
+                uint8_t *data, size_t num_data,
                 size_t *sua_free, size_t *ce_len, int flag)
 {
     int ret, done = 0, len, es_extra = 0;
@@ -558,36 +578,24 @@ int aaip_add_AL(Ecma119Image *t, struct susp_info *susp,
         if (ret < 0)
             return ret;
     }
-    aapt = *data;
-    if (!(aapt[4] & 1)) {
-        /* Single field can be handed over directly */
-        if (*ce_len > 0) {
-            ret = susp_append_ce(t, susp, aapt);
-        } else {
-            ret = susp_append(t, susp, aapt);
-        }
-        *data = NULL;
-        return ISO_SUCCESS;
-    }
-
-    /* Multiple fields have to be handed over as single field copies */
-    for (aapt = *data; !done; aapt += aapt[2]) {
+    /* The fields get copied from data. Those for the CE area go directly
+       into its buffer, those for the SUA need a copy each.
+    */
+    for (aapt = data; !done; aapt += aapt[2]) {
         done = !(aapt[4] & 1);
-        len = aapt[2];
-        cpt = calloc(aapt[2], 1);
-        if (cpt == NULL)
-            return ISO_OUT_OF_MEM;
-        memcpy(cpt, aapt, len);
         if (*ce_len > 0) {
-            ret = susp_append_ce(t, susp, cpt);
+            ret = susp_copy_ce(t, susp, aapt);
         } else {
+            len = aapt[2];
+            cpt = calloc(aapt[2], 1);
+            if (cpt == NULL)
+                return ISO_OUT_OF_MEM;
+            memcpy(cpt, aapt, len);
             ret = susp_append(t, susp, cpt);
         }
-        if (ret == -1)
+        if (ret < 0)
             return ret;
     }
-    free(*data);
-    *data = NULL;
     return ISO_SUCCESS;
 }
 
@@ -1156,7 +1164,6 @@ int add_aa_string(Ecma119Image *t, Ecma119Node *n, struct susp_info *info,
                   size_t *sua_free, size_t *ce_len, int flag)
 {
     int ret;
-    uint8_t *aapt;
     void *xipt;
     size_t num_aapt= 0;
 
@@ -1170,16 +1177,11 @@ int add_aa_string(Ecma119Image *t, Ecma119Node *n, struct susp_info *info,
             if (flag & 1) {
                 ret = aaip_add_AL(t, NULL,NULL, num_aapt, sua_free, ce_len, 1);
             } else {
-                aapt = malloc(num_aapt);
-                if (aapt == NULL)
-                    return ISO_OUT_OF_MEM;
-                memcpy(aapt, xipt, num_aapt);
-                ret = aaip_add_AL(t, info, &aapt, num_aapt, sua_free, ce_len,
-                                  0);
+                ret = aaip_add_AL(t, info, (uint8_t *) xipt, num_aapt,
+                                  sua_free, ce_len, 0);
             }
             if (ret < 0) 
                 return ret;
-            /* aapt is NULL now and the memory is owned by t */
         }
     }
     return 1;
@@ -1262,14 +1264,24 @@ size_t rrip_calc_len(Ecma119Image *t, Ecma119Node *n, int type, size_t used_up,
     }
 
     if (type == 0) {
+        size_t su_mem = su_size;
+        int ce_used = 0;
 
         /* Try without CE */
         ret = susp_calc_nm_sl_al(t, n, space, &su_size, ce, 0);
-        if (ret == 0) /* Retry with CE */
+        if (ret == 0) { /* Retry with CE */
             ret = susp_calc_nm_sl_al(t, n, space, &su_size, ce, 1);
+            ce_used = 1;
+        }
         if (ret == -2)
            return ISO_OUT_OF_MEM;
 
+        /* Remember the prediction for rrip_get_susp_fields() */
+        n->rr_pred_space = (*ce < 0x8000) ? space : 0;
+        n->rr_pred_su_len = su_mem;
+        n->rr_pred_ce_used = ce_used;
+        n->rr_pred_ce_len = *ce & 0x7fff;
+
     } else {
 
         /* "." or ".." entry */
@@ -1323,10 +1335,7 @@ void susp_info_free(struct susp_info* susp)
     }
     free(susp->susp_fields);
 
-    for (i = 0; i < susp->n_ce_susp_fields; ++i) {
-        free(susp->ce_susp_fields[i]);
-    }
-    free(susp->ce_susp_fields);
+    free(susp->ce_buf);
 }
 
 
@@ -1342,7 +1351,7 @@ void susp_info_free(struct susp_info* susp)
  * @param info
  *      Pointer to the struct susp_info where the entries will be stored.
  *      If some entries need to go to a Continuation Area, they will be added
- *      to the existing ce_susp_fields, and ce_len will be incremented
+ *      to the existing ce_buf, and ce_len will be incremented
  *      propertly. Please ensure ce_block is initialized propertly.
  * @return
  *      1 success, < 0 error
@@ -1481,21 +1490,30 @@ int rrip_get_susp_fields(Ecma119Image *t, Ecma119Node *n, int type,
 
         sua_free = space - info->suf_len;
 
-        /* Try whether NM, SL, AL will fit into SUA */
-        su_size_pd = info->suf_len;
-        ce_len_pd = ce_len;
-        ret = susp_calc_nm_sl_al(t, n, (size_t) space,
-                                 &su_size_pd, &ce_len_pd, 0);
-        if (ret == 0) { /* Have to use CA. 28 bytes of CE are necessary */
+        /* Try whether NM, SL, AL will fit into SUA.
+           rrip_calc_len() already found out if it had the same conditions.
+        */
+        if (n->rr_pred_space == space &&
+            n->rr_pred_su_len == info->suf_len) {
+            ce_is_predicted = n->rr_pred_ce_used;
+            ce_len_pd = n->rr_pred_ce_len;
+        } else {
+            su_size_pd = info->suf_len;
+            ce_len_pd = ce_len;
             ret = susp_calc_nm_sl_al(t, n, (size_t) space,
-                                     &su_size_pd, &ce_len_pd, 1);
-            sua_free -= 28;
-            ce_is_predicted = 1;
-        }
-        if (ret == -2) {
-           ret = ISO_OUT_OF_MEM;
-           goto add_susp_cleanup;
+                                     &su_size_pd, &ce_len_pd, 0);
+            if (ret == 0) { /* Have to use CA */
+                ret = susp_calc_nm_sl_al(t, n, (size_t) space,
+                                         &su_size_pd, &ce_len_pd, 1);
+                ce_is_predicted = 1;
+            }
+            if (ret == -2) {
+               ret = ISO_OUT_OF_MEM;
+               goto add_susp_cleanup;
+            }
         }
+        if (ce_is_predicted) /* 28 bytes of CE are necessary */
+            sua_free -= 28;
 
         /* NM entry */
         if (5 + namelen <= sua_free) {
@@ -1872,45 +1890,29 @@ void rrip_write_susp_fields(Ecma119Image *t, struct susp_info *info,
 /**
  * Write the Continuation Area entries for the given struct susp_info, using
  * the iso_write() function.
- * After written, the ce_susp_fields array will be freed.
+ * After written, the ce_buf will be freed.
  */
 int rrip_write_ce_fields(Ecma119Image *t, struct susp_info *info)
 {
-    size_t i;
-    uint8_t *padding = NULL;
+    size_t len;
     int ret= ISO_SUCCESS;
 
-    if (info->n_ce_susp_fields == 0) {
+    if (info->ce_len == 0) {
         goto ex;
     }
-    LIBISO_ALLOC_MEM(padding, uint8_t, BLOCK_SIZE);
-
-    for (i = 0; i < info->n_ce_susp_fields; i++) {
-        ret = iso_write(t, info->ce_susp_fields[i], 
-                        info->ce_susp_fields[i][2]);
-        if (ret < 0) {
-            goto write_ce_field_cleanup;
-        }
-    }
 
-    /* pad continuation area until block size */
-    i = BLOCK_SIZE - (info->ce_len % BLOCK_SIZE);
-    if (i > 0 && i < BLOCK_SIZE) {
-        memset(padding, 0, i);
-        ret = iso_write(t, padding, i);
-    }
+    /* pad continuation area until block size and write it at once.
+       The buffer is allocated in multiples of the block size.
+    */
+    len = ROUND_UP(info->ce_len, BLOCK_SIZE);
+    memset(info->ce_buf + info->ce_len, 0, len - info->ce_len);
+    ret = iso_write(t, info->ce_buf, len);
 
-    write_ce_field_cleanup: ;
-    /* free ce_susp_fields */
-    for (i = 0; i < info->n_ce_susp_fields; ++i) {
-        free(info->ce_susp_fields[i]);
-    }
-    free(info->ce_susp_fields);
-    info->ce_susp_fields = NULL;
-    info->n_ce_susp_fields = 0;
+    free(info->ce_buf);
+    info->ce_buf = NULL;
+    info->ce_buf_size = 0;
     info->ce_len = 0;
 ex:;
-    LIBISO_FREE_MEM(padding);
     return ret;
 }
 
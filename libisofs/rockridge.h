@@ -63,8 +63,12 @@ struct susp_info
     uint32_t ce_block;
     uint32_t ce_len;
 
-    size_t n_ce_susp_fields;
-    uint8_t **ce_susp_fields;
+    /**
+     * The CE area fields of the whole directory, recorded one after the
+     * other as they will be written. ce_len bytes are in use.
+     */
+    uint8_t *ce_buf;
+    size_t ce_buf_size;
 };
 
 /* SUSP 5.1 */
@@ -204,7 +208,7 @@ size_t rrip_calc_len(Ecma119Image *t, Ecma119Node *n, int type, size_t space,
  * @param info
  *      Pointer to the struct susp_info where the entries will be stored.
  *      If some entries need to go to a Continuation Area, they will be added
- *      to the existing ce_susp_fields, and ce_len will be incremented
+ *      to the existing ce_buf, and ce_len will be incremented
  *      propertly. Please ensure ce_block is initialized propertly.
  * @return
  *      1 success, < 0 error
@@ -225,7 +229,7 @@ void rrip_write_susp_fields(Ecma119Image *t, struct susp_info *info,
 /**
  * Write the Continuation Area entries for the given struct susp_info, using
  * the iso_write() function.
- * After written, the ce_susp_fields array will be freed.
+ * After written, the ce_buf will be freed.
  */
 int rrip_write_ce_fields(Ecma119Image *t, struct susp_info *info);
 
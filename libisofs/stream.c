@@ -933,6 +933,21 @@ ex:;
     return path;
 }
 
+int iso_stream_get_src_stat(IsoStream *stream, struct stat *info, int flag)
+{
+    IsoFileSource *src;
+
+    if (stream->class == &fsrc_stream_class) {
+        src = ((FSrcStreamData *) stream->data)->src;
+    } else if (stream->class == &cut_out_stream_class) {
+        src = ((struct cut_out_stream *) stream->data)->src;
+    } else {
+        return 0;
+    }
+    return iso_file_source_stat(src, info);
+}
+
+
 /* @return 1 = ok , 0 = not an ISO image stream , <0 = error */
 int iso_stream_set_image_ino(IsoStream *stream, ino_t ino, int flag)
 {
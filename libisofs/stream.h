@@ -69,6 +69,13 @@ int iso_stream_get_src_zf(IsoStream *stream, int *header_size_div4,
                           int *block_size_log2, uint32_t *uncompressed_size,
                           int flag);
 
+/**
+ * Inquire the current attributes of the file source underneath a stream
+ * which reads from a file source, i.e. from disk or from a loaded ISO image.
+ * @return  1= *info is valid, 0= stream has no file source, <0 error
+ */
+int iso_stream_get_src_stat(IsoStream *stream, struct stat *info, int flag);
+
 /**
  * Set the inode number of a stream that is based on FSrcStreamData, i.e.
  * stems from the imported ISO image.
@@ -748,7 +748,8 @@ int check_special(IsoImage *image, mode_t mode)
  * @return
  *      1 continue, < 0 error (ISO_CANCELED stop)
  */
-int iso_add_dir_src_rec(IsoImage *image, IsoDir *parent, IsoFileSource *dir)
+int iso_add_dir_src_rec(IsoImage *image, IsoDir *parent, IsoFileSource *dir,
+                        int flag)
 {
     int ret;
     IsoNodeBuilder *builder;
@@ -872,7 +873,10 @@ int iso_add_dir_src_rec(IsoImage *image, IsoDir *parent, IsoFileSource *dir)
 
         /* finally, if the node is a directory we need to recurse */
         if (new->type == LIBISO_DIR && S_ISDIR(info.st_mode)) {
-            ret = iso_add_dir_src_rec(image, (IsoDir*)new, file);
+            if (flag & 1)
+                ret = iso_dir_set_lazy(image, (IsoDir*)new, file);
+            else
+                ret = iso_add_dir_src_rec(image, (IsoDir*)new, file, flag);
         }
 
 dir_rec_continue:;
@@ -920,7 +924,7 @@ int iso_tree_add_dir_rec(IsoImage *image, IsoDir *parent, const char *dir)
         iso_file_source_unref(file);
         return ISO_FILE_IS_NOT_DIR;
     }
-    result = iso_add_dir_src_rec(image, parent, file);
+    result = iso_add_dir_src_rec(image, parent, file, 0);
     iso_file_source_unref(file);
     return result;
 }
@@ -1243,6 +1247,11 @@ int iso_tree_resolve_symlink(IsoImage *img, IsoSymlink *sym, IsoNode **res,
         }
 
         /* Search node in cur_dir */
+        if (cur_dir->lazy != NULL) {
+            ret = iso_dir_load_lazy(cur_dir, 0);
+            if (ret < 0)
+                return ret;
+        }
         for (n = cur_dir->children; n != NULL; n = n->next)
             if (strncmp(dest_start, n->name, comp_len) == 0 &&
                 strlen(n->name) == comp_len)
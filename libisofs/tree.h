@@ -14,9 +14,13 @@
 /**
  * Recursively add a given directory to the image tree.
  * 
+ * @param flag
+ *      bit0= do not descend into sub directories but mark them for lazy
+ *            loading by iso_dir_set_lazy()
  * @return
  *      1 continue, 0 stop, < 0 error
  */
-int iso_add_dir_src_rec(IsoImage *image, IsoDir *parent, IsoFileSource *dir);
+int iso_add_dir_src_rec(IsoImage *image, IsoDir *parent, IsoFileSource *dir,
+                        int flag);
 
 #endif /*LIBISO_IMAGE_TREE_H_*/
@@ -20,6 +20,7 @@
 #include "../version.h"
 
 #include <stdlib.h>
+#include <stddef.h>
 #include <wchar.h>
 #include <string.h>
 #include <errno.h>
@@ -29,6 +30,7 @@
 #include <iconv.h>
 #include <locale.h>
 #include <langinfo.h>
+#include <pthread.h>
 
 #include <unistd.h>
 
@@ -45,11 +47,105 @@ static int iso_iconv_debug = 0;
 
 
 struct iso_iconv_handle {
-    int status;  /* bit0= open , bit1= identical mapping */
+    int status;  /* bit0= open , bit1= identical mapping ,
+                    bit2= descr is borrowed from iso_iconv_cache */
     iconv_t descr;
+    int cache_slot;
 };
 
 
+/* Cache of iconv descriptors which are not in use.
+   Opening a converter costs far more than converting a file name. So
+   iso_iconv_close() does not really close descriptors which were registered
+   here but only marks them as free for the next iso_iconv_open() with the
+   same pair of character set names.
+   A descriptor is used by only one thread at a time.
+*/
+#define ISO_ICONV_CACHE_SIZE      16
+#define ISO_ICONV_CACHE_NAME_MAX  64
+
+struct iso_iconv_cache_slot {
+    char tocode[ISO_ICONV_CACHE_NAME_MAX];
+    char fromcode[ISO_ICONV_CACHE_NAME_MAX];
+    iconv_t descr;
+    int in_use;
+};
+
+static struct iso_iconv_cache_slot iso_iconv_cache[ISO_ICONV_CACHE_SIZE];
+static int iso_iconv_cache_filled = 0;
+static pthread_mutex_t iso_iconv_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+/* @return 1= got a cached descriptor , 0= none available
+*/
+static
+int iso_iconv_cache_get(struct iso_iconv_handle *handle,
+                        char *tocode, char *fromcode, int flag)
+{
+    int i;
+    struct iso_iconv_cache_slot *slot;
+
+    pthread_mutex_lock(&iso_iconv_cache_mutex);
+    for (i = 0; i < iso_iconv_cache_filled; i++) {
+        slot = iso_iconv_cache + i;
+        if (slot->in_use || strcmp(slot->tocode, tocode) != 0 ||
+            strcmp(slot->fromcode, fromcode) != 0)
+    continue;
+        slot->in_use = 1;
+        handle->descr = slot->descr;
+        handle->cache_slot = i;
+        pthread_mutex_unlock(&iso_iconv_cache_mutex);
+
+        /* Bring the descriptor back into its initial shift state */
+        iconv(handle->descr, NULL, NULL, NULL, NULL);
+        handle->status = 1 | 4;
+        return 1;
+    }
+    pthread_mutex_unlock(&iso_iconv_cache_mutex);
+    return 0;
+}
+
+
+/* Register a freshly opened descriptor if there is room in the cache.
+*/
+static
+void iso_iconv_cache_add(struct iso_iconv_handle *handle,
+                         char *tocode, char *fromcode, int flag)
+{
+    struct iso_iconv_cache_slot *slot;
+
+    if (strlen(tocode) >= ISO_ICONV_CACHE_NAME_MAX ||
+        strlen(fromcode) >= ISO_ICONV_CACHE_NAME_MAX)
+        return;
+    pthread_mutex_lock(&iso_iconv_cache_mutex);
+    if (iso_iconv_cache_filled < ISO_ICONV_CACHE_SIZE) {
+        handle->cache_slot = iso_iconv_cache_filled;
+        slot = iso_iconv_cache + iso_iconv_cache_filled;
+        strcpy(slot->tocode, tocode);
+        strcpy(slot->fromcode, fromcode);
+        slot->descr = handle->descr;
+        slot->in_use = 1;
+        iso_iconv_cache_filled++;
+        handle->status |= 4;
+    }
+    pthread_mutex_unlock(&iso_iconv_cache_mutex);
+}
+
+
+/* To be called by iso_finish() when no conversions are going on any more.
+*/
+void iso_iconv_cache_dispose(int flag)
+{
+    int i;
+
+    pthread_mutex_lock(&iso_iconv_cache_mutex);
+    for (i = 0; i < iso_iconv_cache_filled; i++)
+        iconv_close(iso_iconv_cache[i].descr);
+    iso_iconv_cache_filled = 0;
+    pthread_mutex_unlock(&iso_iconv_cache_mutex);
+}
+
+
 /*
    @param flag    bit0= shortcut by identical mapping is not allowed
 */
@@ -59,11 +155,14 @@ int iso_iconv_open(struct iso_iconv_handle *handle,
 {
     handle->status = 0;
     handle->descr = (iconv_t) -1;
+    handle->cache_slot = -1;
 
     if (strcmp(tocode, fromcode) == 0 && !(flag & 1)) {
         handle->status = 1 | 2;
         return 1;
     }
+    if (iso_iconv_cache_get(handle, tocode, fromcode, 0) > 0)
+        return 1;
     handle->descr = iconv_open(tocode, fromcode);
     if (handle->descr == (iconv_t) -1) {
         if (strlen(tocode) + strlen(fromcode) <= 160 && iso_iconv_debug)
@@ -73,6 +172,7 @@ int iso_iconv_open(struct iso_iconv_handle *handle,
         return 0;
     }
     handle->status = 1;
+    iso_iconv_cache_add(handle, tocode, fromcode, 0);
     return 1;
 }
 
@@ -143,6 +243,13 @@ int iso_iconv_close(struct iso_iconv_handle *handle, int flag)
     handle->status &= ~1;
     if (handle->status & 2)
         return 0;
+    if (handle->status & 4) {
+        pthread_mutex_lock(&iso_iconv_cache_mutex);
+        iso_iconv_cache[handle->cache_slot].in_use = 0;
+        pthread_mutex_unlock(&iso_iconv_cache_mutex);
+        handle->status &= ~4;
+        return 0;
+    }
 
     ret = iconv_close(handle->descr);
     if (ret == -1) {
@@ -189,6 +296,80 @@ char *iso_get_local_charset(int flag)
    return nl_langinfo(CODESET);
 }
 
+
+/* Compare a character set name case-insensitively with a name or,
+   if bit0 of flag is set, with a name prefix.
+*/
+static
+int iso_charset_name_is(const char *name, const char *model, int flag)
+{
+    for (; *model != 0; name++, model++)
+        if (toupper((unsigned char) *name) != *model)
+            return 0;
+    return (*name == 0 || (flag & 1));
+}
+
+/* @return 0= unknown or not a superset of ASCII
+           1= single byte superset of ASCII
+           2= UTF-8
+*/
+static
+int iso_charset_is_ascii_based(const char *name)
+{
+    if (iso_charset_name_is(name, "UTF-8", 0) ||
+        iso_charset_name_is(name, "UTF8", 0))
+        return 2;
+    if (iso_charset_name_is(name, "ASCII", 0) ||
+        iso_charset_name_is(name, "US-ASCII", 0) ||
+        iso_charset_name_is(name, "ANSI_X3.4-1968", 0) ||
+        iso_charset_name_is(name, "ISO-8859-", 1) ||
+        iso_charset_name_is(name, "ISO8859-", 1) ||
+        iso_charset_name_is(name, "ISO_8859-", 1))
+        return 1;
+    return 0;
+}
+
+/* Check whether the first len bytes of str are all 7-bit characters.
+   Eight bytes are tested at once.
+*/
+static
+int iso_bytes_are_ascii(const char *str, size_t len)
+{
+    size_t i;
+    uint64_t word;
+
+    for (i = 0; i + 8 <= len; i += 8) {
+        memcpy(&word, str + i, 8);
+        if (word & 0x8080808080808080ULL)
+            return 0;
+    }
+    for (; i < len; i++)
+        if (((unsigned char) str[i]) & 0x80)
+            return 0;
+    return 1;
+}
+
+/* Shortcut for the frequent case that a name is plain ASCII and both
+   character sets map ASCII onto itself. Then no conversion is needed.
+   @return 1= *output is set , 0= iconv is needed , < 0 error
+*/
+static
+int iso_ascii_shortcut(const char *str, const char *icharset,
+                       const char *ocharset, size_t len, char **output)
+{
+    if (!iso_charset_is_ascii_based(icharset) ||
+        !iso_charset_is_ascii_based(ocharset))
+        return 0;
+    if (!iso_bytes_are_ascii(str, len))
+        return 0;
+    *output = malloc(len + 1);
+    if (*output == NULL)
+        return ISO_OUT_OF_MEM;
+    memcpy(*output, str, len);
+    (*output)[len] = 0;
+    return 1;
+}
+
 int strconv(const char *str, const char *icharset, const char *ocharset,
             char **output)
 {
@@ -204,6 +385,9 @@ int strconv(const char *str, const char *icharset, const char *ocharset,
     int retval;
 
     inbytes = strlen(str);
+    retval = iso_ascii_shortcut(str, icharset, ocharset, inbytes, output);
+    if (retval != 0)
+        return retval;
     outbytes = (inbytes + 1) * MB_LEN_MAX;
     out = calloc(outbytes, 1);
     if (out == NULL) {
@@ -255,6 +439,9 @@ int strnconv(const char *str, const char *icharset, const char *ocharset,
     int retval;
 
     inbytes = len;
+    retval = iso_ascii_shortcut(str, icharset, ocharset, inbytes, output);
+    if (retval != 0)
+        return retval;
     outbytes = (inbytes + 1) * MB_LEN_MAX;
     out = calloc(outbytes, 1);
     if (out == NULL) {
@@ -406,6 +593,11 @@ int str2ascii(const char *icharset, const char *input, char **output)
         return ISO_NULL_POINTER;
     }
 
+    result = iso_ascii_shortcut(input, icharset, "ASCII", strlen(input),
+                                output);
+    if (result != 0)
+        return result;
+
     /* First try the traditional way via intermediate character set WCHAR_T.
      * Up to August 2011 this was the only way. But it will not work if
      * there is no character set "WCHAR_T". E.g. on Solaris.
@@ -542,6 +734,68 @@ int cmp_ucsbe(const uint16_t *ucs, char c)
     }
 }
 
+/* Convert ASCII or valid UTF-8 of the Basic Multilingual Plane directly
+   to UCS-2BE.
+   Anything else is left to iconv, so that replacement of unconvertible
+   characters by '_' stays as it was.
+   @return 1= *output is set , 0= iconv is needed , < 0 error
+*/
+static
+int iso_str2ucs_shortcut(const char *icharset, const char *input,
+                         uint16_t **output)
+{
+    int based;
+    size_t len, i;
+    unsigned int c, c1, c2;
+    const unsigned char *in;
+    unsigned char *out;
+
+    based = iso_charset_is_ascii_based(icharset);
+    if (based == 0)
+        return 0;
+    len = strlen(input);
+    if (based == 1 && !iso_bytes_are_ascii(input, len))
+        return 0;
+    out = malloc((len + 1) * sizeof(uint16_t));
+    if (out == NULL)
+        return ISO_OUT_OF_MEM;
+    *output = (uint16_t *) out;
+    in = (const unsigned char *) input;
+    for (i = 0; i < len; out += 2) {
+        c = in[i];
+        if (c < 0x80) {
+            i++;
+        } else if (c >= 0xc2 && c <= 0xdf && i + 1 < len) {
+            c1 = in[i + 1];
+            if ((c1 & 0xc0) != 0x80)
+                goto need_iconv;
+            c = ((c & 0x1f) << 6) | (c1 & 0x3f);
+            i += 2;
+        } else if (c >= 0xe0 && c <= 0xef && i + 2 < len) {
+            c1 = in[i + 1];
+            c2 = in[i + 2];
+            if ((c1 & 0xc0) != 0x80 || (c2 & 0xc0) != 0x80)
+                goto need_iconv;
+            c = ((c & 0x0f) << 12) | ((c1 & 0x3f) << 6) | (c2 & 0x3f);
+            /* Overlong forms, surrogates, non-characters */
+            if (c < 0x800 || (c >= 0xd800 && c <= 0xdfff) || c >= 0xfffe)
+                goto need_iconv;
+            i += 3;
+        } else {
+            goto need_iconv;
+        }
+        out[0] = c >> 8;
+        out[1] = c & 0xff;
+    }
+    out[0] = out[1] = 0;
+    return 1;
+
+need_iconv:;
+    free(*output);
+    *output = NULL;
+    return 0;
+}
+
 int str2ucs(const char *icharset, const char *input, uint16_t **output)
 {
     int result;
@@ -565,6 +819,10 @@ int str2ucs(const char *icharset, const char *input, uint16_t **output)
         return ISO_NULL_POINTER;
     }
 
+    result = iso_str2ucs_shortcut(icharset, input, output);
+    if (result != 0)
+        return result;
+
     /* convert the string to a wide character string. Note: outbytes
      * is in fact the number of characters in the string and doesn't
      * include the last NULL character.
@@ -2078,6 +2336,265 @@ void *iso_alloc_mem(size_t size, size_t count, int flag)
 }
 
 
+/* ------------------------- Pool of small objects ------------------------- */
+
+/* Large trees consist of millions of small objects which all live about
+   as long as the tree. Getting them one by one from malloc() costs time
+   and the per-allocation overhead of malloc(). So objects up to
+   ISO_POOL_MAX_SIZE bytes get carved out of larger chunks. Each size class
+   of ISO_POOL_GRANULARITY bytes has its own list of freed objects for
+   re-use. The chunks are returned to the system when the last object is
+   freed.
+*/
+#define ISO_POOL_GRANULARITY  16
+#define ISO_POOL_MAX_SIZE     512
+#define ISO_POOL_CLASSES      (ISO_POOL_MAX_SIZE / ISO_POOL_GRANULARITY)
+#define ISO_POOL_CHUNK_SIZE   (32 * 1024)
+
+struct iso_pool_chunk {
+    struct iso_pool_chunk *next;
+};
+
+static struct iso_pool_chunk *iso_pool_chunks = NULL;
+static void *iso_pool_free_list[ISO_POOL_CLASSES];
+static char *iso_pool_fill[ISO_POOL_CLASSES];
+static size_t iso_pool_fill_left[ISO_POOL_CLASSES];
+static size_t iso_pool_in_use = 0;
+static pthread_mutex_t iso_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+void *iso_pool_alloc(size_t size)
+{
+    int cls;
+    size_t obj_size;
+    void *obj = NULL;
+    struct iso_pool_chunk *chunk;
+
+    if (size == 0)
+        size = 1;
+    if (size > ISO_POOL_MAX_SIZE)
+        return calloc(1, size);
+    cls = (size - 1) / ISO_POOL_GRANULARITY;
+    obj_size = (cls + 1) * ISO_POOL_GRANULARITY;
+
+    pthread_mutex_lock(&iso_pool_mutex);
+    if (iso_pool_free_list[cls] != NULL) {
+        obj = iso_pool_free_list[cls];
+        iso_pool_free_list[cls] = *((void **) obj);
+    } else {
+        if (iso_pool_fill_left[cls] < obj_size) {
+            chunk = malloc(ISO_POOL_CHUNK_SIZE);
+            if (chunk == NULL)
+                goto ex;
+            chunk->next = iso_pool_chunks;
+            iso_pool_chunks = chunk;
+            /* The header occupies one granule, so objects stay aligned
+               like the chunk itself */
+            iso_pool_fill[cls] = ((char *) chunk) + ISO_POOL_GRANULARITY;
+            iso_pool_fill_left[cls] = ISO_POOL_CHUNK_SIZE -
+                                      ISO_POOL_GRANULARITY;
+        }
+        obj = iso_pool_fill[cls];
+        iso_pool_fill[cls] += obj_size;
+        iso_pool_fill_left[cls] -= obj_size;
+    }
+    iso_pool_in_use++;
+ex:;
+    pthread_mutex_unlock(&iso_pool_mutex);
+    if (obj != NULL)
+        memset(obj, 0, size);
+    return obj;
+}
+
+
+void iso_pool_free(void *obj, size_t size)
+{
+    int cls, i;
+    struct iso_pool_chunk *chunk;
+
+    if (obj == NULL)
+        return;
+    if (size == 0)
+        size = 1;
+    if (size > ISO_POOL_MAX_SIZE) {
+        free(obj);
+        return;
+    }
+    cls = (size - 1) / ISO_POOL_GRANULARITY;
+
+    pthread_mutex_lock(&iso_pool_mutex);
+    *((void **) obj) = iso_pool_free_list[cls];
+    iso_pool_free_list[cls] = obj;
+    iso_pool_in_use--;
+    if (iso_pool_in_use == 0) {
+        while (iso_pool_chunks != NULL) {
+            chunk = iso_pool_chunks;
+            iso_pool_chunks = chunk->next;
+            free(chunk);
+        }
+        for (i = 0; i < ISO_POOL_CLASSES; i++) {
+            iso_pool_free_list[i] = NULL;
+            iso_pool_fill[i] = NULL;
+            iso_pool_fill_left[i] = 0;
+        }
+    }
+    pthread_mutex_unlock(&iso_pool_mutex);
+}
+
+
+/* ---------------------------- Interned names ----------------------------- */
+
+/* File names repeat a lot in large trees: README, index.html, Makefile, ...
+   Also the file sources of an imported image and the nodes made from them
+   carry the same names. So each distinct name is stored only once, with a
+   reference count.
+*/
+struct iso_istr {
+    struct iso_istr *next;
+    uint32_t hash;
+    uint32_t refcount;
+    char text[1];
+};
+
+#define ISO_ISTR_HEAD_SIZE  (offsetof(struct iso_istr, text))
+#define ISO_ISTR_MIN_BUCKETS  1024
+
+static struct iso_istr **iso_istr_table = NULL;
+static size_t iso_istr_buckets = 0;
+static size_t iso_istr_count = 0;
+static pthread_mutex_t iso_istr_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+static
+uint32_t iso_istr_hash(const char *str, size_t *len)
+{
+    uint32_t hash = 2166136261u;
+    const unsigned char *rpt;
+
+    for (rpt = (const unsigned char *) str; *rpt; rpt++) {
+        hash ^= *rpt;
+        hash *= 16777619u;
+    }
+    *len = ((const char *) rpt) - str;
+    return hash;
+}
+
+
+/* Double the number of buckets. Failure is harmless, the chains just get
+   longer.
+*/
+static
+void iso_istr_grow(void)
+{
+    size_t i, new_buckets;
+    struct iso_istr **new_table, *entry, *next;
+
+    new_buckets = iso_istr_buckets * 2;
+    if (new_buckets < ISO_ISTR_MIN_BUCKETS)
+        new_buckets = ISO_ISTR_MIN_BUCKETS;
+    new_table = calloc(new_buckets, sizeof(struct iso_istr *));
+    if (new_table == NULL)
+        return;
+    for (i = 0; i < iso_istr_buckets; i++) {
+        for (entry = iso_istr_table[i]; entry != NULL; entry = next) {
+            next = entry->next;
+            entry->next = new_table[entry->hash & (new_buckets - 1)];
+            new_table[entry->hash & (new_buckets - 1)] = entry;
+        }
+    }
+    if (iso_istr_table != NULL)
+        free(iso_istr_table);
+    iso_istr_table = new_table;
+    iso_istr_buckets = new_buckets;
+}
+
+
+char *iso_str_intern(const char *str)
+{
+    uint32_t hash;
+    size_t len;
+    struct iso_istr *entry;
+    char *ret = NULL;
+
+    if (str == NULL)
+        return NULL;
+    hash = iso_istr_hash(str, &len);
+
+    pthread_mutex_lock(&iso_istr_mutex);
+    if (iso_istr_count >= iso_istr_buckets)
+        iso_istr_grow();
+    if (iso_istr_buckets == 0)
+        goto ex;
+    for (entry = iso_istr_table[hash & (iso_istr_buckets - 1)];
+         entry != NULL; entry = entry->next) {
+        if (entry->hash == hash && strcmp(entry->text, str) == 0) {
+            entry->refcount++;
+            ret = entry->text;
+            goto ex;
+        }
+    }
+    entry = iso_pool_alloc(ISO_ISTR_HEAD_SIZE + len + 1);
+    if (entry == NULL)
+        goto ex;
+    entry->hash = hash;
+    entry->refcount = 1;
+    memcpy(entry->text, str, len + 1);
+    entry->next = iso_istr_table[hash & (iso_istr_buckets - 1)];
+    iso_istr_table[hash & (iso_istr_buckets - 1)] = entry;
+    iso_istr_count++;
+    ret = entry->text;
+ex:;
+    pthread_mutex_unlock(&iso_istr_mutex);
+    return ret;
+}
+
+
+char *iso_str_intern_ref(char *str)
+{
+    struct iso_istr *entry;
+
+    if (str == NULL)
+        return NULL;
+    entry = (struct iso_istr *) (str - ISO_ISTR_HEAD_SIZE);
+    pthread_mutex_lock(&iso_istr_mutex);
+    entry->refcount++;
+    pthread_mutex_unlock(&iso_istr_mutex);
+    return str;
+}
+
+
+void iso_str_release(char *str)
+{
+    struct iso_istr *entry, **pos;
+    size_t size;
+
+    if (str == NULL)
+        return;
+    entry = (struct iso_istr *) (str - ISO_ISTR_HEAD_SIZE);
+    size = ISO_ISTR_HEAD_SIZE + strlen(str) + 1;
+
+    pthread_mutex_lock(&iso_istr_mutex);
+    if (--entry->refcount > 0)
+        goto ex;
+    for (pos = &iso_istr_table[entry->hash & (iso_istr_buckets - 1)];
+         *pos != NULL; pos = &((*pos)->next)) {
+        if (*pos == entry) {
+            *pos = entry->next;
+            break;
+        }
+    }
+    iso_pool_free(entry, size);
+    iso_istr_count--;
+    if (iso_istr_count == 0) {
+        free(iso_istr_table);
+        iso_istr_table = NULL;
+        iso_istr_buckets = 0;
+    }
+ex:;
+    pthread_mutex_unlock(&iso_istr_mutex);
+}
+
+
 uint16_t iso_ntohs(uint16_t v)
 {
     return iso_read_msb((uint8_t *) &v, 2);
@@ -88,6 +88,12 @@ int str2ascii(const char *icharset, const char *input, char **output);
  */
 int str2ucs(const char *icharset, const char *input, uint16_t **output);
 
+/**
+ * Close the iconv descriptors which are kept open for re-use by the
+ * character set conversion functions. To be called by iso_finish().
+ */
+void iso_iconv_cache_dispose(int flag);
+
 /**
  * Create a level 1 directory identifier.
  * 
@@ -344,6 +350,35 @@ void iso_rbtree_destroy(IsoRBTree *tree, void (*free_data)(void *));
  */
 int iso_rbtree_insert(IsoRBTree *tree, void *data, void **item);
 
+/**
+ * Look up an element and its predecessor in a Red-Black tree.
+ *
+ * @param data
+ *     element to be compared with the tree elements. It is not inserted.
+ * @param item
+ *     if not NULL, will be set to the tree element that is equal to data,
+ *     or to NULL if there is no such element.
+ * @param lower
+ *     if not NULL, will be set to the greatest tree element that is less
+ *     than data, or to NULL if there is no such element.
+ * @return
+ *     1 equal element found, 0 not found, < 0 error
+ */
+int iso_rbtree_find(IsoRBTree *tree, void *data, void **item, void **lower);
+
+/**
+ * Removes an element from a Red-Black tree. The element itself is not freed.
+ *
+ * @param data
+ *     element to be compared with the tree elements
+ * @param item
+ *     if not NULL, will be set to the removed tree element that was equal
+ *     to data, or to NULL if no element was removed.
+ * @return
+ *     1 element removed, 0 no such element, < 0 error
+ */
+int iso_rbtree_remove(IsoRBTree *tree, void *data, void **item);
+
 /**
  * Get the number of elements in a given tree.
  */
@@ -577,6 +612,42 @@ void *iso_alloc_mem(size_t size, size_t count, int flag);
         }
 
 
+/**
+ * Get zeroed memory for a small object which will be freed by
+ * iso_pool_free() with the same size. Objects of up to 512 bytes are taken
+ * from a shared pool.
+ *
+ * @return
+ *     The new object or NULL if out of memory
+ */
+void *iso_pool_alloc(size_t size);
+
+/**
+ * Give back an object which was obtained by iso_pool_alloc(size).
+ */
+void iso_pool_free(void *obj, size_t size);
+
+/**
+ * Get the shared copy of a string. It must not be altered and has to be
+ * given back by iso_str_release().
+ *
+ * @return
+ *     The shared string or NULL if out of memory
+ */
+char *iso_str_intern(const char *str);
+
+/**
+ * Take another reference to a string which was obtained by iso_str_intern().
+ */
+char *iso_str_intern_ref(char *str);
+
+/**
+ * Give back a reference to a string which was obtained by iso_str_intern()
+ * or iso_str_intern_ref(). NULL is allowed.
+ */
+void iso_str_release(char *str);
+
+
 /* ------------------------------------------------------------------------- */
 
 
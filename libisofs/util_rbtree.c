@@ -244,6 +244,153 @@ int iso_rbtree_insert(IsoRBTree *tree, void *data, void **item)
     }
 }
 
+/**
+ * Look up an element and its predecessor in a Red-Black tree.
+ *
+ * @param data
+ *     element to be compared with the tree elements. It is not inserted.
+ * @param item
+ *     if not NULL, will be set to the tree element that is equal to data,
+ *     or to NULL if there is no such element.
+ * @param lower
+ *     if not NULL, will be set to the greatest tree element that is less
+ *     than data, or to NULL if there is no such element.
+ * @return
+ *     1 equal element found, 0 not found, < 0 error
+ */
+int iso_rbtree_find(IsoRBTree *tree, void *data, void **item, void **lower)
+{
+    struct iso_rbnode *q;
+    void *found = NULL, *low = NULL;
+    int comp;
+
+    if (tree == NULL || data == NULL) {
+        return ISO_NULL_POINTER;
+    }
+    q = tree->root;
+    while (q != NULL) {
+        comp = tree->compare(q->data, data);
+        if (comp < 0) {
+            low = q->data;
+            q = q->ch[1];
+        } else {
+            if (comp == 0)
+                found = q->data;
+            q = q->ch[0];
+        }
+    }
+    if (item != NULL) {
+        *item = found;
+    }
+    if (lower != NULL) {
+        *lower = low;
+    }
+    return found != NULL;
+}
+
+/**
+ * Removes an element from a Red-Black tree. This is the top-down deletion
+ * of Julienne Walker.
+ *
+ * @param data
+ *     element to be compared with the tree elements
+ * @param item
+ *     if not NULL, will be set to the removed tree element that was equal
+ *     to data, or to NULL if no element was removed.
+ * @return
+ *     1 element removed, 0 no such element, < 0 error
+ */
+int iso_rbtree_remove(IsoRBTree *tree, void *data, void **item)
+{
+    struct iso_rbnode head = { 0, {NULL, NULL}, 0 }; /* False tree root */
+    struct iso_rbnode *q, *p, *g, *s; /* Helpers */
+    struct iso_rbnode *f = NULL; /* Found item */
+    void *removed = NULL;
+    int dir = 1, last, dir2, comp;
+
+    if (tree == NULL || data == NULL) {
+        return ISO_NULL_POINTER;
+    }
+    if (item != NULL) {
+        *item = NULL;
+    }
+    if (tree->root == NULL) {
+        return 0;
+    }
+
+    /* Set up helpers */
+    q = &head;
+    g = p = NULL;
+    q->ch[1] = tree->root;
+
+    /* Search and push a red node down */
+    while (q->ch[dir] != NULL) {
+        last = dir;
+
+        /* Update helpers */
+        g = p, p = q;
+        q = q->ch[dir];
+        comp = tree->compare(q->data, data);
+        dir = (comp < 0);
+
+        /* Save found node */
+        if (comp == 0) {
+            f = q;
+        }
+
+        /* Push the red node down */
+        if (is_red(q) || is_red(q->ch[dir])) {
+            continue;
+        }
+        if (is_red(q->ch[!dir])) {
+            p = p->ch[last] = iso_rbtree_single(q, dir);
+            continue;
+        }
+        s = p->ch[!last];
+        if (s == NULL) {
+            continue;
+        }
+        if (!is_red(s->ch[!last]) && !is_red(s->ch[last])) {
+            /* Color flip */
+            p->red = 0;
+            s->red = 1;
+            q->red = 1;
+        } else {
+            dir2 = (g->ch[1] == p);
+            if (is_red(s->ch[last])) {
+                g->ch[dir2] = iso_rbtree_double(p, last);
+            } else {
+                g->ch[dir2] = iso_rbtree_single(p, last);
+            }
+
+            /* Ensure correct coloring */
+            q->red = g->ch[dir2]->red = 1;
+            g->ch[dir2]->ch[0]->red = 0;
+            g->ch[dir2]->ch[1]->red = 0;
+        }
+    }
+
+    /* Replace and remove if found */
+    if (f != NULL) {
+        removed = f->data;
+        f->data = q->data;
+        p->ch[p->ch[1] == q] = q->ch[q->ch[0] == NULL];
+        free(q);
+        tree->size--;
+    }
+
+    /* Update root and make it black */
+    tree->root = head.ch[1];
+    if (tree->root != NULL) {
+        tree->root->red = 0;
+    }
+
+    if (item != NULL) {
+        *item = removed;
+    }
+    return f != NULL;
+}
+
 /**
  * Get the number of elements in a given tree.
  */
@@ -39,6 +39,17 @@ struct Iso_Image_Writer
  */
 int iso_write(Ecma119Image *target, void *buf, size_t count);
 
+/**
+ * Like iso_write() but also add the first md5_len bytes of buf to the
+ * MD5 context md5_ctx. If the image checksum is active too, then both
+ * checksums get computed in one pass over the data.
+ *
+ * @return
+ *      1 on sucess, < 0 error
+ */
+int iso_write_md5(Ecma119Image *target, void *buf, size_t count,
+                  void *md5_ctx, size_t md5_len);
+
 int ecma119_writer_create(Ecma119Image *target);
 
 #endif /*LIBISO_IMAGE_WRITER_H_*/
@@ -42,6 +42,8 @@
 #endif
 
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <stdio.h>
 #include <ctype.h>
 #include <errno.h>
 #include "jte.h"
@@ -84,6 +86,24 @@ static char *file_base_name(char *path)
     return endptr;
 }
 
+/* FNV-1a over the size and the basename of a file */
+static uint32_t md5_hash_value(uint64_t size, char *base_name)
+{
+    uint32_t h = 2166136261u;
+    unsigned char *p;
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        h ^= (size >> (8 * i)) & 0xff;
+        h *= 16777619u;
+    }
+    for (p = (unsigned char *) base_name; *p != 0; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
 static void exit_if_enabled(struct libjte_env *o, int value)
 {
     if (!(o->error_behavior & 2))
@@ -254,8 +274,8 @@ static int check_md5_file_match(struct libjte_env *o, char *filename)
 extern int list_file_in_jigdo(struct libjte_env *o,
             char *filename, off_t size, char **realname, unsigned char md5[16])
 {
-    char *matched_rule;
-    md5_list_entry_t *entry = o->md5_list;
+    char *matched_rule, *base_name;
+    md5_list_entry_t *entry;
     int md5sum_done = 0, ret;
     
     if (o->jtemplate_out == NULL)
@@ -294,13 +314,20 @@ extern int list_file_in_jigdo(struct libjte_env *o,
 
        If we get a match for all three, include the file and return
        the full path to the file that we have gleaned from the mirror.
+       Only the index chain of size and basename needs to be inspected.
     */
 
+    base_name = file_base_name(filename);
+    if (o->md5_hash != NULL)
+        entry = o->md5_hash[md5_hash_value((uint64_t) size, base_name) &
+                            (o->md5_hash_size - 1)];
+    else
+        entry = o->md5_list;
     while (entry)
     {
         if (size == (off_t) entry->size)
         {
-            if (!strcmp(file_base_name(filename), file_base_name(entry->filename)))
+            if (!strcmp(base_name, file_base_name(entry->filename)))
             {
                 if (!md5sum_done)
                 {
@@ -321,7 +348,10 @@ extern int list_file_in_jigdo(struct libjte_env *o,
                 }
             }
         }
-        entry = entry->next;
+        if (o->md5_hash != NULL)
+            entry = entry->hash_next;
+        else
+            entry = entry->next;
     }
 
     /* We haven't found an entry in our MD5 list to match this
@@ -532,13 +562,238 @@ int libjte_destroy_md5_list(struct libjte_env *o, int flag)
 {
     md5_list_entry_t *s, *s_next;
 
-    for (s = o->md5_list; s != NULL; s = s_next) {
-        s_next = s->next;
-        free(s->filename);
-        free(s);
+    if (o->md5_pool != NULL) {
+        /* Entries and filenames are parts of two memory objects */
+        free(o->md5_pool);
+        free(o->md5_pool_data);
+        o->md5_pool = NULL;
+        o->md5_pool_data = NULL;
+    } else {
+        for (s = o->md5_list; s != NULL; s = s_next) {
+            s_next = s->next;
+            free(s->filename);
+            free(s);
+        }
     }
     o->md5_list = o->md5_last = NULL;
+    free(o->md5_hash);
+    o->md5_hash = NULL;
+    o->md5_hash_size = 0;
+    return 1;
+}
+
+/* Build the lookup index of md5_list by size and basename.
+   The chains keep the order of md5_list, so that the first matching entry
+   is found first, as with the plain list.
+   Without the index, list_file_in_jigdo() falls back to walking the list.
+*/
+static int index_md5_list(struct libjte_env *o)
+{
+    md5_list_entry_t *s, **tails = NULL;
+    uint32_t count = 0, size = 16, idx;
+
+    free(o->md5_hash);
+    o->md5_hash = NULL;
+    o->md5_hash_size = 0;
+
+    for (s = o->md5_list; s != NULL; s = s->next)
+        count++;
+    while (size < count && size < 0x40000000)
+        size *= 2;
+    o->md5_hash = calloc(size, sizeof(md5_list_entry_t *));
+    tails = calloc(size, sizeof(md5_list_entry_t *));
+    if (o->md5_hash == NULL || tails == NULL) {
+        free(o->md5_hash);
+        o->md5_hash = NULL;
+        free(tails);
+        return 0;
+    }
+    o->md5_hash_size = size;
+    for (s = o->md5_list; s != NULL; s = s->next) {
+        s->hash_next = NULL;
+        idx = md5_hash_value(s->size, file_base_name(s->filename)) &
+              (size - 1);
+        if (tails[idx] == NULL)
+            o->md5_hash[idx] = s;
+        else
+            tails[idx]->hash_next = s;
+        tails[idx] = s;
+    }
+    free(tails);
+    return 1;
+}
+
+/* Binary cache of the parsed MD5 list, all numbers little-endian:
+
+   Header of 64 bytes:
+      0  16  Magic "libjte md5cache1"
+     16   8  Byte size of the MD5 list file
+     24   8  Modification time of the MD5 list file
+     32   8  Inode number of the MD5 list file
+     40   8  Number of entries
+     48   8  Number of bytes in the name area
+     56   8  Reserved, 0
+   Entries of 32 bytes:
+      0  16  MD5
+     16   8  File size
+     24   8  Offset of the 0-terminated filename in the name area
+   Name area
+*/
+#define JTE_MD5_CACHE_MAGIC "libjte md5cache1"
+#define JTE_MD5_CACHE_HEAD  64
+#define JTE_MD5_CACHE_ENTRY 32
+
+/* Load the cache if it matches the MD5 list file.
+   @return 1 = loaded, 0 = not usable
+*/
+static int load_md5_cache(struct libjte_env *o)
+{
+    FILE *cache_file = NULL;
+    struct stat stbuf;
+    unsigned char head[JTE_MD5_CACHE_HEAD], *rec, *names;
+    uint64_t count, names_size, offset, i;
+    md5_list_entry_t *pool = NULL;
+    unsigned char *data = NULL;
+    size_t data_size;
+
+    if (o->jmd5_cache == NULL || o->jmd5_cache[0] == 0)
+        return 0;
+    if (stat(o->jmd5_list, &stbuf) == -1)
+        return 0;
+    cache_file = fopen(o->jmd5_cache, "rb");
+    if (cache_file == NULL)
+        return 0;
+    if (fread(head, JTE_MD5_CACHE_HEAD, 1, cache_file) != 1)
+        goto not_usable;
+    if (memcmp(head, JTE_MD5_CACHE_MAGIC, 16) != 0 ||
+        read_le64(head + 16) != (uint64_t) stbuf.st_size ||
+        read_le64(head + 24) != (uint64_t) stbuf.st_mtime ||
+        read_le64(head + 32) != (uint64_t) stbuf.st_ino)
+        goto not_usable;
+    count = read_le64(head + 40);
+    names_size = read_le64(head + 48);
+    if (count == 0 || count > 0x40000000 || names_size > 0x40000000 ||
+        names_size < count)
+        goto not_usable;
+
+    data_size = count * JTE_MD5_CACHE_ENTRY + names_size;
+    data = malloc(data_size);
+    pool = calloc(count, sizeof(md5_list_entry_t));
+    if (data == NULL || pool == NULL)
+        goto not_usable;
+    if (fread(data, data_size, 1, cache_file) != 1)
+        goto not_usable;
+    names = data + count * JTE_MD5_CACHE_ENTRY;
+    if (names[names_size - 1] != 0)
+        goto not_usable;
+    for (i = 0; i < count; i++) {
+        rec = data + i * JTE_MD5_CACHE_ENTRY;
+        offset = read_le64(rec + 24);
+        if (offset >= names_size)
+            goto not_usable;
+        memcpy(pool[i].MD5, rec, sizeof(pool[i].MD5));
+        pool[i].size = read_le64(rec + 16);
+        pool[i].filename = (char *) names + offset;
+        if (i + 1 < count)
+            pool[i].next = pool + i + 1;
+    }
+    fclose(cache_file);
+
+    o->md5_list = pool;
+    o->md5_last = pool + count - 1;
+    o->md5_pool = pool;
+    o->md5_pool_data = data;
+    if (o->verbose > 0) {
+        sprintf(o->message_buffer,
+              "parse_md5_list: loaded MD5 checksums for %.f files from cache '%1.1024s'",
+              (double) count, o->jmd5_cache);
+        libjte_add_msg_entry(o, o->message_buffer, 0);
+    }
     return 1;
+
+not_usable:;
+    fclose(cache_file);
+    free(data);
+    free(pool);
+    return 0;
+}
+
+/* Write the parsed MD5 list to the cache file.
+   Failure is not fatal. It only costs the next run a parse of the list.
+*/
+static int write_md5_cache(struct libjte_env *o)
+{
+    FILE *cache_file = NULL;
+    struct stat stbuf;
+    unsigned char buf[JTE_MD5_CACHE_HEAD];
+    md5_list_entry_t *s;
+    uint64_t count = 0, names_size = 0;
+    char *tmp_path = NULL;
+    size_t len;
+
+    if (o->jmd5_cache == NULL || o->jmd5_cache[0] == 0)
+        return 0;
+    if (stat(o->jmd5_list, &stbuf) == -1)
+        return 0;
+    for (s = o->md5_list; s != NULL; s = s->next) {
+        count++;
+        names_size += strlen(s->filename) + 1;
+    }
+    if (count == 0)
+        return 0;
+
+    tmp_path = malloc(strlen(o->jmd5_cache) + 5);
+    if (tmp_path == NULL)
+        return -1;
+    strcpy(tmp_path, o->jmd5_cache);
+    strcat(tmp_path, ".tmp");
+    cache_file = fopen(tmp_path, "wb");
+    if (cache_file == NULL)
+        goto failed;
+
+    memset(buf, 0, sizeof(buf));
+    memcpy(buf, JTE_MD5_CACHE_MAGIC, 16);
+    write_le64((uint64_t) stbuf.st_size, buf + 16);
+    write_le64((uint64_t) stbuf.st_mtime, buf + 24);
+    write_le64((uint64_t) stbuf.st_ino, buf + 32);
+    write_le64(count, buf + 40);
+    write_le64(names_size, buf + 48);
+    if (fwrite(buf, JTE_MD5_CACHE_HEAD, 1, cache_file) != 1)
+        goto failed;
+    names_size = 0;
+    for (s = o->md5_list; s != NULL; s = s->next) {
+        memcpy(buf, s->MD5, sizeof(s->MD5));
+        write_le64(s->size, buf + 16);
+        write_le64(names_size, buf + 24);
+        if (fwrite(buf, JTE_MD5_CACHE_ENTRY, 1, cache_file) != 1)
+            goto failed;
+        names_size += strlen(s->filename) + 1;
+    }
+    for (s = o->md5_list; s != NULL; s = s->next) {
+        len = strlen(s->filename) + 1;
+        if (fwrite(s->filename, len, 1, cache_file) != 1)
+            goto failed;
+    }
+    if (fclose(cache_file) != 0) {
+        cache_file = NULL;
+        goto failed;
+    }
+    cache_file = NULL;
+    if (rename(tmp_path, o->jmd5_cache) == -1)
+        goto failed;
+    free(tmp_path);
+    return 1;
+
+failed:;
+    sprintf(o->message_buffer,
+            "cannot write MD5 list cache file '%1.1024s' : errno=%d",
+            o->jmd5_cache, errno);
+    libjte_add_msg_entry(o, o->message_buffer, 0);
+    if (cache_file != NULL)
+        fclose(cache_file);
+    remove(tmp_path);
+    free(tmp_path);
+    return 0;
 }
 
 /* Parse a 12-digit decimal number */
@@ -642,9 +897,14 @@ int write_jt_header(struct libjte_env *o,
 
     /* Load up the MD5 list if we've been given one */
     if (o->jmd5_list) {
-        ret = parse_md5_list(o);
-        if (ret <= 0)
-            return ret;
+        libjte_destroy_md5_list(o, 0);
+        if (load_md5_cache(o) <= 0) {
+            ret = parse_md5_list(o);
+            if (ret <= 0)
+                return ret;
+            write_md5_cache(o);
+        }
+        index_md5_list(o);
     }
     return 1;
 }
@@ -127,6 +127,7 @@ typedef struct _jigdo_image_entry
 typedef struct _md5_list_entry
 {
     struct _md5_list_entry *next;
+    struct _md5_list_entry *hash_next; /* Chain of the lookup index */
     unsigned char       MD5[16];
     uint64_t size;
     char               *filename;
@@ -118,6 +118,11 @@ int libjte_new(struct libjte_env **jte_handle, int flag)
     o->num_chunks = 0;
     o->md5_list = NULL;
     o->md5_last = NULL;
+    o->md5_hash = NULL;
+    o->md5_hash_size = 0;
+    o->jmd5_cache = NULL;
+    o->md5_pool = NULL;
+    o->md5_pool_data = NULL;
     o->include_in_jigdo = 0;
     memset(o->message_buffer, 0, sizeof(o->message_buffer));
     o->error_behavior = 1; /* Print to stderr, do not exit but return -1 */
@@ -140,6 +145,7 @@ int libjte_destroy(struct libjte_env **jte_handle)
     free(o->jtemplate_out);
     free(o->jjigdo_out);
     free(o->jmd5_list);
+    free(o->jmd5_cache);
     if (o->jtjigdo != NULL)
         fclose(o->jtjigdo);
     if (o->jttemplate != NULL)
@@ -196,6 +202,11 @@ int libjte_set_md5_path(struct libjte_env *o, char *jmd5_list)
     return libjte__set_string(&(o->jmd5_list), jmd5_list, 0);
 }
 
+int libjte_set_md5_cache_path(struct libjte_env *o, char *jmd5_cache)
+{
+    return libjte__set_string(&(o->jmd5_cache), jmd5_cache, 0);
+}
+
 int libjte_set_min_size(struct libjte_env *o, int jte_min_size)
 {
     o->jte_min_size = jte_min_size;
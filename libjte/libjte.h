@@ -28,7 +28,7 @@ struct libjte_env;
 */
 #define LIBJTE_VERSION_MAJOR   1
 #define LIBJTE_VERSION_MINOR   0
-#define LIBJTE_VERSION_MICRO   0
+#define LIBJTE_VERSION_MICRO   1
 
 /** Obtain the three release version numbers of the library. These are the
     numbers encountered by the application when linking with libjte
@@ -127,6 +127,21 @@ int libjte_set_jigdo_path(struct libjte_env *jte_handle, char *path);
 */
 int libjte_set_md5_path(struct libjte_env *jte_handle, char *path);
 
+/** Tell libjte the hard disk address of a binary cache file for the .md5
+    file. If the cache was made from the current .md5 file, then it gets
+    loaded instead of parsing the .md5 file. Else the .md5 file gets parsed
+    and the cache gets (re-)written.
+    The cache is recognized as outdated if size, modification time or inode
+    number of the .md5 file have changed.
+    @since 1.0.1
+    @param jte_handle  The environment to be manipulated.
+    @param path        Will be used with fopen(path, "r") and with
+                       fopen(path + ".tmp", "w"), rename(path + ".tmp", path).
+                       Empty text or NULL disable the cache.
+    @return  >0 means success, <=0 indicates failure
+*/
+int libjte_set_md5_cache_path(struct libjte_env *jte_handle, char *path);
+
 /** Define a minimum size for data files to get extracted and referred in
     the jigdo file.
     @since 0.1.0
@@ -46,6 +46,17 @@ struct libjte_env {
     md5_list_entry_t *md5_list;
     md5_list_entry_t *md5_last;
 
+    /* Lookup index of md5_list by size and file basename */
+    md5_list_entry_t **md5_hash;
+    uint32_t md5_hash_size;
+
+    /* Binary cache of the parsed md5_list */
+    char *jmd5_cache;
+    /* If md5_list was loaded from the cache: the array of entries and the
+       memory which holds their filenames */
+    md5_list_entry_t *md5_pool;
+    unsigned char *md5_pool_data;
+
     int include_in_jigdo; /* 0= put data blocks into .template, 1= do not */
 
     char message_buffer[4096];
@@ -0,0 +1,12 @@
+
+/* <<< this file is on its way out 
+#define ISOBURN_MAJOR_VERSION @ISOBURN_MAJOR_VERSION@
+#define ISOBURN_MINOR_VERSION @ISOBURN_MINOR_VERSION@
+#define ISOBURN_MICRO_VERSION @ISOBURN_MICRO_VERSION@
+*/
+#define LIBISOFS_MAJOR_VERSION 1
+#define LIBISOFS_MINOR_VERSION 3
+#define LIBISOFS_MICRO_VERSION 0
+#define BURN_MAJOR_VERSION 1
+#define BURN_MINOR_VERSION 3
+#define BURN_MICRO_VERSION 0
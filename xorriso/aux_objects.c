@@ -688,6 +688,23 @@ struct ExclusionS {
 
  /* Compiled not_leaf patterns. Caution: not char[] but  regex_t */
  struct Xorriso_lsT *not_leafs;
+
+ /* Lookup index which gets made by Exclusions_compile() on first use after
+    the lists above were changed. The arrays are sorted by strcmp().
+ */
+ int index_valid;
+
+ int path_count;
+ char **path_index;        /* Points to the texts of not_paths */
+
+ int literal_count;
+ char **literal_index;     /* not_leafs without wildcards */
+ int prefix_count;
+ char **prefix_index;      /* Copies of the text before the '*' of "text*" */
+ int suffix_count;
+ char **suffix_index;      /* The text after the '*' of "*text" */
+ int regex_count;
+ regex_t **regex_index;    /* All other not_leafs */
  
 };
 
@@ -703,6 +720,46 @@ int Exclusions_new(struct ExclusionS **o, int flag)
  m->not_paths= NULL;
  m->not_leafs_descr= NULL;
  m->not_leafs= NULL;
+ m->index_valid= 0;
+ m->path_count= 0;
+ m->path_index= NULL;
+ m->literal_count= 0;
+ m->literal_index= NULL;
+ m->prefix_count= 0;
+ m->prefix_index= NULL;
+ m->suffix_count= 0;
+ m->suffix_index= NULL;
+ m->regex_count= 0;
+ m->regex_index= NULL;
+ return(1);
+}
+
+
+static int Exclusions_destroy_index(struct ExclusionS *o, int flag)
+{
+ int i;
+
+ if(o->path_index != NULL)
+   free((char *) o->path_index);
+ o->path_index= NULL;
+ if(o->literal_index != NULL)
+   free((char *) o->literal_index);
+ o->literal_index= NULL;
+ if(o->prefix_index != NULL) {
+   for(i= 0; i < o->prefix_count; i++)
+     free(o->prefix_index[i]);
+   free((char *) o->prefix_index);
+ }
+ o->prefix_index= NULL;
+ if(o->suffix_index != NULL)
+   free((char *) o->suffix_index);
+ o->suffix_index= NULL;
+ if(o->regex_index != NULL)
+   free((char *) o->regex_index);
+ o->regex_index= NULL;
+ o->path_count= o->literal_count= o->prefix_count= o->suffix_count= 0;
+ o->regex_count= 0;
+ o->index_valid= 0;
  return(1);
 }
 
@@ -713,6 +770,7 @@ int Exclusions_destroy(struct ExclusionS **o, int flag)
 
  if((*o)==NULL)
    return(0);
+ Exclusions_destroy_index(*o, 0);
  Xorriso_lst_destroy_all(&((*o)->not_paths_descr), 0);
  Xorriso_lst_destroy_all(&((*o)->not_paths), 0);
  Xorriso_lst_destroy_all(&((*o)->not_leafs_descr), 0);
@@ -755,6 +813,7 @@ int Exclusions_add_not_paths(struct ExclusionS *o, int descrc, char **descrs,
      o->not_paths= new_s;
    s= new_s;
  }
+ o->index_valid= 0;
  return(1);
 }
 
@@ -773,33 +832,173 @@ int Exclusions_add_not_leafs(struct ExclusionS *o, char *not_leafs_descr,
  ret= Xorriso_lst_append_binary(&(o->not_leafs), (char *) re, sizeof(regex_t), 0);
  if(ret<=0)
    return(-1);
+ o->index_valid= 0;
  return(1);
 }
 
 
+static int Exclusions__strcmp(const void *p1, const void *p2)
+{
+ return(strcmp(*((char **) p1), *((char **) p2)));
+}
+
+
+/* Binary search for the string of len bytes at text in a sorted index.
+   @return 1= found , 0= not found
+*/
+static int Exclusions__lookup(char **index, int count, char *text, int len)
+{
+ int l= 0, r= count - 1, m, ret;
+
+ while(l <= r) {
+   m= l + (r - l) / 2;
+   ret= strncmp(index[m], text, len);
+   if(ret == 0)
+     ret= (index[m][len] != 0);
+   if(ret == 0)
+     return(1);
+   if(ret < 0)
+     l= m + 1;
+   else
+     r= m - 1;
+ }
+ return(0);
+}
+
+
+/* Classify a -not_leaf pattern by the way it can be matched.
+   @return 0= literal text , 1= "text*" , 2= "*text" , 3= needs regex
+*/
+static int Exclusions__leaf_class(char *descr, int flag)
+{
+ int l;
+ char *wild;
+
+ l= strlen(descr);
+ wild= strpbrk(descr, "*?[\\");
+ if(wild == NULL)
+   return(0);
+ if(descr[0] == '*' && strpbrk(descr + 1, "*?[\\") == NULL)
+   return(2);
+ if(l > 0 && wild == descr + l - 1 && *wild == '*')
+   return(1);
+ return(3);
+}
+
+
+/* Make the lookup index from the lists of paths and leaf patterns.
+   Exclusions_match() calls this automatically when needed. Call it before
+   Exclusions_match() is used by concurrent threads.
+   @return <=0 error , 1= ok
+*/
+int Exclusions_compile(struct ExclusionS *o, int flag)
+{
+ struct Xorriso_lsT *s, *d;
+ int count= 0, cls, l;
+ char *descr;
+
+ if(o->index_valid)
+   return(1);
+ Exclusions_destroy_index(o, 0);
+
+ for(s= o->not_paths; s != NULL; s= s->next)
+   count++;
+ if(count > 0) {
+   o->path_index= TSOB_FELD(char *, count);
+   if(o->path_index == NULL)
+     goto no_mem;
+   for(s= o->not_paths; s != NULL; s= s->next)
+     o->path_index[o->path_count++]= s->text;
+   qsort(o->path_index, o->path_count, sizeof(char *), Exclusions__strcmp);
+ }
+
+ count= 0;
+ for(s= o->not_leafs; s != NULL; s= s->next)
+   count++;
+ if(count > 0) {
+   o->literal_index= TSOB_FELD(char *, count);
+   o->prefix_index= TSOB_FELD(char *, count);
+   o->suffix_index= TSOB_FELD(char *, count);
+   o->regex_index= TSOB_FELD(regex_t *, count);
+   if(o->literal_index == NULL || o->prefix_index == NULL ||
+      o->suffix_index == NULL || o->regex_index == NULL)
+     goto no_mem;
+   /* not_leafs_descr and not_leafs are appended in parallel */
+   d= o->not_leafs_descr;
+   for(s= o->not_leafs; s != NULL; s= s->next) {
+     descr= NULL;
+     if(d != NULL) {
+       descr= d->text;
+       d= d->next;
+     }
+     cls= 3;
+     if(descr != NULL)
+       cls= Exclusions__leaf_class(descr, 0);
+     if(cls == 0) {
+       o->literal_index[o->literal_count++]= descr;
+     } else if(cls == 1) {
+       l= strlen(descr) - 1;
+       o->prefix_index[o->prefix_count]= calloc(1, l + 1);
+       if(o->prefix_index[o->prefix_count] == NULL)
+         goto no_mem;
+       memcpy(o->prefix_index[o->prefix_count], descr, l);
+       o->prefix_count++;
+     } else if(cls == 2) {
+       o->suffix_index[o->suffix_count++]= descr + 1;
+     } else {
+       o->regex_index[o->regex_count++]= (regex_t *) s->text;
+     }
+   }
+   qsort(o->literal_index, o->literal_count, sizeof(char *),
+         Exclusions__strcmp);
+   qsort(o->prefix_index, o->prefix_count, sizeof(char *),
+         Exclusions__strcmp);
+   qsort(o->suffix_index, o->suffix_count, sizeof(char *),
+         Exclusions__strcmp);
+ }
+ o->index_valid= 1;
+ return(1);
+no_mem:;
+ Exclusions_destroy_index(o, 0);
+ return(-1);
+}
+
+
 /* @param flag bit0= whole subtree is banned with -not_paths 
    @return 0=no match , 1=not_paths , 2=not_leafs, <0=error
 */
 int Exclusions_match(struct ExclusionS *o, char *abs_path, int flag)
 {
- struct Xorriso_lsT *s;
- char *leaf= NULL, *leaf_pt;
+ char *leaf= NULL, *leaf_pt, *cpt;
  regmatch_t match[1];
- int ret, was_non_slash, l;
+ int ret, was_non_slash, l, leaf_len, i;
+
+ if(!o->index_valid) {
+   ret= Exclusions_compile(o, 0);
+   if(ret <= 0)
+     {ret= -1; goto ex;}
+ }
 
  /* test abs_paths */
- if(flag&1) {
-   for(s= o->not_paths; s!=NULL; s= s->next) {
-     l= strlen(s->text);
-     if(strncmp(abs_path, s->text, l)==0)
+ if(o->path_count > 0) {
+   if(flag&1) {
+     /* Look up every parent path and abs_path itself */
+     for(l= 0; ; l++) {
        if(abs_path[l]=='/' || abs_path[l]==0)
-         {ret= 1; goto ex;}
-   }
- } else {
-   for(s= o->not_paths; s!=NULL; s= s->next)
-     if(strcmp(abs_path, s->text)==0)
+         if(Exclusions__lookup(o->path_index, o->path_count, abs_path, l))
+           {ret= 1; goto ex;}
+       if(abs_path[l]==0)
+     break;
+     }
+   } else {
+     if(Exclusions__lookup(o->path_index, o->path_count, abs_path,
+                           strlen(abs_path)))
        {ret= 1; goto ex;}
+   }
  }
+ if(o->literal_count + o->prefix_count + o->suffix_count + o->regex_count
+    <= 0)
+   {ret= 0; goto ex;}
 
  /* determine leafname */
  was_non_slash= 0;
@@ -812,16 +1011,41 @@ int Exclusions_match(struct ExclusionS *o, char *abs_path, int flag)
    } else if(*leaf_pt!=0)
      was_non_slash= 1;
  }
+ if(leaf_pt < abs_path)
+   leaf_pt= abs_path;
  if(strlen(leaf_pt)>=SfileadrL)
    {ret= -1; goto ex;}
- leaf= strdup(leaf_pt);
- leaf_pt= strchr(leaf, '/');
- if(leaf_pt!=NULL)
-   *leaf_pt= 0;
-
- /* test with leaf expressions */
- for(s= o->not_leafs; s!=NULL; s= s->next) {
-   ret= regexec((regex_t *) s->text, leaf, 1, match, 0);
+ cpt= strchr(leaf_pt, '/');
+ if(cpt != NULL)
+   leaf_len= cpt - leaf_pt;
+ else
+   leaf_len= strlen(leaf_pt);
+
+ /* test with leaf expressions: literal texts, "text*", "*text", others */
+ if(o->literal_count > 0)
+   if(Exclusions__lookup(o->literal_index, o->literal_count, leaf_pt,
+                         leaf_len))
+     {ret= 2; goto ex;}
+ if(o->prefix_count > 0)
+   for(i= 0; i <= leaf_len; i++)
+     if(Exclusions__lookup(o->prefix_index, o->prefix_count, leaf_pt, i))
+       {ret= 2; goto ex;}
+ if(o->suffix_count > 0)
+   for(i= 0; i <= leaf_len; i++)
+     if(Exclusions__lookup(o->suffix_index, o->suffix_count, leaf_pt + i,
+                           leaf_len - i))
+       {ret= 2; goto ex;}
+ if(o->regex_count <= 0)
+   {ret= 0; goto ex;}
+ if(cpt != NULL) {
+   leaf= strdup(leaf_pt);
+   if(leaf == NULL)
+     {ret= -1; goto ex;}
+   leaf[leaf_len]= 0;
+   leaf_pt= leaf;
+ }
+ for(i= 0; i < o->regex_count; i++) {
+   ret= regexec(o->regex_index[i], leaf_pt, 1, match, 0);
    if(ret==0)
      {ret= 2; goto ex;}
  }
@@ -156,6 +156,8 @@ int Exclusions_add_not_leafs(struct ExclusionS *o, char *not_leafs_descr,
 int Exclusions_add_not_paths(struct ExclusionS *o, int descrc, char **descrs,
                              int pathc, char **paths, int flag);
 
+int Exclusions_compile(struct ExclusionS *o, int flag);
+
 
 
 struct LinkiteM;          /* Trace of hops during symbolic link resolution */
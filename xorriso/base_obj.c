@@ -158,6 +158,8 @@ int Xorriso_new(struct XorrisO ** xorriso,char *progname, int flag)
  m->do_follow_links= 0;
  m->follow_link_limit= 100;
  m->do_follow_mount= 1;
+ m->disk_scan_threads= 0;
+ m->scan_ahead= NULL;
  m->do_global_uid= 0;
  m->global_uid= 0;
  strcpy(m->volid, "ISOIMAGE");
@@ -187,6 +189,9 @@ int Xorriso_new(struct XorrisO ** xorriso,char *progname, int flag)
  m->zlib_level_default= m->zlib_level= 6;
  m->zisofs_block_size= m->zisofs_block_size_default= (1 << 15);
  m->zisofs_by_magic= 0;
+ m->zisofs_threads= 1;
+ m->filter_cache_mem= 0;
+ m->filter_cache_disk= 0;
  m->do_overwrite= 2;
  m->do_reassure= 0;
  m->drive_blacklist= NULL;
@@ -202,6 +207,7 @@ int Xorriso_new(struct XorrisO ** xorriso,char *progname, int flag)
  m->cache_num_tiles= 0;
  m->cache_tile_blocks= 0;
  m->cache_default= 1 | 2;
+ m->lazy_dirs= 0;
  m->do_calm_drive= 1;
  m->indev[0]= 0;
  m->in_drive_handle= NULL;
@@ -228,6 +234,9 @@ int Xorriso_new(struct XorrisO ** xorriso,char *progname, int flag)
  m->do_close= 0;
  m->speed= 0;
  m->fs= 4*512; /* 4 MiB */
+ m->file_readers= 0;
+ m->file_prefetch= 0;
+ m->dedup_content= 0;
  m->padding= 300*1024;
  m->do_padding_by_libisofs= 0;
  m->alignment= 0;
@@ -401,6 +410,9 @@ int Xorriso_new(struct XorrisO ** xorriso,char *progname, int flag)
  m->hln_array= NULL; 
  m->hln_targets= NULL;
  m->hln_change_pending= 0;
+ m->hln_noted_count= 0;
+ m->hln_noted_size= 0;
+ m->hln_noted= NULL;
  m->di_do_widen= NULL;
  m->di_disk_paths= NULL;
  m->di_iso_paths= NULL;
@@ -409,6 +421,7 @@ int Xorriso_new(struct XorrisO ** xorriso,char *progname, int flag)
 
  m->di_count= 0;
  m->di_array= NULL;
+ m->di_keys= NULL;
 
  m->perm_stack= NULL;
 
@@ -598,6 +611,21 @@ int Xorriso_destroy_node_array(struct XorrisO *xorriso, int flag)
 }
 
 
+int Xorriso_destroy_hln_noted(struct XorrisO *xorriso, int flag)
+{
+ int i;
+
+ if(xorriso->hln_noted != NULL) {
+   for(i= 0; i < xorriso->hln_noted_count; i++)
+     iso_node_unref((IsoNode *) xorriso->hln_noted[i]);
+   free(xorriso->hln_noted);
+ }
+ xorriso->hln_noted= NULL;
+ xorriso->hln_noted_count= xorriso->hln_noted_size= 0;
+ return(1);
+}
+
+
 /* @param flag bit0= do not destroy hln_array but only hln_targets
 */
 int Xorriso_destroy_hln_array(struct XorrisO *xorriso, int flag)
@@ -605,6 +633,8 @@ int Xorriso_destroy_hln_array(struct XorrisO *xorriso, int flag)
  int i;
 
  
+ if(!(flag & 1))
+   Xorriso_destroy_hln_noted(xorriso, 0);
  if(xorriso->hln_array != NULL && !(flag & 1)) {
    for(i= 0; i < xorriso->hln_count; i++)
      iso_node_unref((IsoNode *) xorriso->hln_array[i]);
@@ -635,6 +665,10 @@ int Xorriso_destroy_di_array(struct XorrisO *xorriso, int flag)
    free(xorriso->di_array);
    xorriso->di_array= NULL;
  }
+ if(xorriso->di_keys != NULL) {
+   free(xorriso->di_keys);
+   xorriso->di_keys= NULL;
+ }
  if(xorriso->di_do_widen != NULL) {
    free(xorriso->di_do_widen);
    xorriso->di_do_widen= NULL;
@@ -675,6 +709,29 @@ int Xorriso_new_node_array(struct XorrisO *xorriso, off_t mem_limit,
 }
 
 
+/* Double the size of node_array, or allocate it if not yet done.
+*/
+int Xorriso_grow_node_array(struct XorrisO *xorriso, int flag)
+{
+ int i, new_size;
+ void **new_array;
+
+ new_size= 2 * xorriso->node_array_size;
+ if(new_size < 1024)
+   new_size= 1024;
+ new_array= realloc(xorriso->node_array, new_size * sizeof(IsoNode *));
+ if(new_array == NULL) {
+   Xorriso_no_malloc_memory(xorriso, NULL, 0);
+   return(-1);
+ }
+ for(i= xorriso->node_array_size; i < new_size; i++)
+   new_array[i]= NULL;
+ xorriso->node_array= new_array;
+ xorriso->node_array_size= new_size;
+ return(1);
+}
+
+
 /* @param flag bit0= do not allocate hln_array but only hln_targets
 */
 int Xorriso_new_hln_array(struct XorrisO *xorriso, off_t mem_limit, int flag)
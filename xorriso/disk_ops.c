@@ -26,6 +26,8 @@
 #include <errno.h>
 #include <pwd.h>
 #include <grp.h>
+#include <dirent.h>
+#include <pthread.h>
 
 
 #include "xorriso.h"
@@ -1248,7 +1250,7 @@ int Xorriso_findx(struct XorrisO *xorriso, struct FindjoB *job,
                   struct stat *dir_stbuf, int depth,
                   struct LinkiteM *link_stack, int flag)
 {
- int ret,is_link, no_dive;
+ int ret,is_link, no_dive, scan_started= 0;
  struct DirseQ *dirseq= NULL;
  struct stat stbuf;
  struct LinkiteM *own_link_stack;
@@ -1322,6 +1324,12 @@ int Xorriso_findx(struct XorrisO *xorriso, struct FindjoB *job,
  }
  if(ret==0)
    {ret= 2; goto ex;}
+ if(!(flag & 1)) {
+   ret= Xorriso_scan_ahead_start(xorriso, abs_dir_path, 0);
+   if(ret < 0)
+     goto ex;
+   scan_started= (ret == 1);
+ }
  
  while(!xorriso->request_to_abort) {
    Linkitem_reset_stack(&own_link_stack, link_stack, 0);
@@ -1333,6 +1341,7 @@ int Xorriso_findx(struct XorrisO *xorriso, struct FindjoB *job,
      Xorriso_msgs_submit(xorriso, 0, xorriso->info_text, 0, "FATAL", 0);
      {ret= -1; goto ex;}
    }
+   Xorriso_scan_ahead_consumed(xorriso, 0);
    ret= Xorriso_make_abs_adr(xorriso, abs_dir_path, name, abs_path, 1);
    if(ret<=0)
      goto ex;
@@ -1390,6 +1399,8 @@ ex:;
  Xorriso_free_meM(abs_dir_path_data);
  Xorriso_free_meM(abs_path);
  Dirseq_destroy(&dirseq, 0);
+ if(scan_started)
+   Xorriso_scan_ahead_stop(xorriso, 0);
  return(ret);
 }
 
@@ -1405,6 +1416,12 @@ int Xorriso_restore_sorted(struct XorrisO *xorriso, int count,
  int i, ret, with_node_array= 0, hflag= 0, hret;
 
  *problem_count= 0;
+
+ /* File content gets read in large sequences. Nothing else uses the input
+    drive until the end of this function.
+ */
+ Xorriso_set_read_ahead(xorriso, 1);
+
  if(!(((xorriso->ino_behavior & 16) && xorriso->do_restore_sort_lba) ||
       (xorriso->ino_behavior & 4) || (flag & 1))) {
    ret= Xorriso_make_hln_array(xorriso, 0);
@@ -1477,6 +1494,7 @@ int Xorriso_restore_sorted(struct XorrisO *xorriso, int count,
 
  ret= 1;
 ex:;
+ Xorriso_set_read_ahead(xorriso, 0);
  return(ret);
 }
 
@@ -1937,3 +1955,322 @@ int Xorriso_append_scdbackup_record(struct XorrisO *xorriso, int flag)
  return(1);
 }
 
+
+/* ------------------------- Disk tree scan ahead -------------------------- */
+
+/* A pool of threads walks the disk tree ahead of Xorriso_add_tree() resp.
+   Xorriso_findx() and performs opendir(), readdir() and lstat() on the
+   file objects which the single threaded tree walker will inquire soon.
+   On network filesystems this replaces many sequential round trips by
+   concurrent ones. The tree walker itself does not depend on the results
+   and thus keeps its order, exclusion and link following behavior.
+*/
+
+#define Xorriso_scan_batch_sizE 32
+
+struct Xorriso_scan_joB {
+ char *dir;                /* absolute path of the directory */
+ dev_t dev;                /* st_dev of the directory */
+ int namec;                /* 0 = read directory , >0 = lstat the names */
+ char *names[Xorriso_scan_batch_sizE];
+ struct Xorriso_scan_joB *next;
+};
+
+struct Xorriso_scan_aheaD {
+ struct XorrisO *xorriso;
+ int num_threads;
+ pthread_t *threads;
+ int threads_started;
+
+ pthread_mutex_t lock;
+ pthread_cond_t cond;
+
+ struct Xorriso_scan_joB *stack;  /* LIFO: approximates the walker's order */
+ int busy;                        /* threads which work on a job */
+ int stop;
+
+ off_t scanned;                   /* file objects inquired by the pool */
+ off_t consumed;                  /* file objects inquired by the walker */
+ off_t lead;                      /* max. scanned - consumed */
+};
+
+
+static void Xorriso_scan_job_destroy(struct Xorriso_scan_joB **job)
+{
+ int i;
+
+ if(*job == NULL)
+   return;
+ for(i= 0; i < (*job)->namec; i++)
+   if((*job)->names[i] != NULL)
+     free((*job)->names[i]);
+ if((*job)->dir != NULL)
+   free((*job)->dir);
+ free((char *) *job);
+ *job= NULL;
+}
+
+
+static struct Xorriso_scan_joB *Xorriso_scan_job_new(char *dir, dev_t dev)
+{
+ struct Xorriso_scan_joB *job;
+
+ job= calloc(1, sizeof(struct Xorriso_scan_joB));
+ if(job == NULL)
+   return(NULL);
+ job->dir= strdup(dir);
+ if(job->dir == NULL) {
+   free((char *) job);
+   return(NULL);
+ }
+ job->dev= dev;
+ return(job);
+}
+
+
+/* Push a chain of jobs so that its first job gets popped first.
+   Caller must hold o->lock.
+*/
+static void Xorriso_scan_push_chain(struct Xorriso_scan_aheaD *o,
+                                    struct Xorriso_scan_joB *first,
+                                    struct Xorriso_scan_joB *last)
+{
+ if(first == NULL)
+   return;
+ last->next= o->stack;
+ o->stack= first;
+ pthread_cond_broadcast(&(o->cond));
+}
+
+
+/* Read the directory and turn its names into lstat jobs */
+static void Xorriso_scan_read_dir(struct Xorriso_scan_aheaD *o,
+                                  struct Xorriso_scan_joB *job)
+{
+ DIR *dirpt;
+ struct dirent *entry;
+ struct Xorriso_scan_joB *first= NULL, *last= NULL, *batch= NULL;
+
+ dirpt= opendir(job->dir);
+ if(dirpt == NULL)
+   return;
+ while(!o->stop) {
+   entry= readdir(dirpt);
+   if(entry == NULL)
+ break;
+   if(strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+ continue;
+   if(batch == NULL || batch->namec >= Xorriso_scan_batch_sizE) {
+     batch= Xorriso_scan_job_new(job->dir, job->dev);
+     if(batch == NULL)
+ break;
+     if(last == NULL)
+       first= batch;
+     else
+       last->next= batch;
+     last= batch;
+   }
+   batch->names[batch->namec]= strdup(entry->d_name);
+   if(batch->names[batch->namec] == NULL)
+ break;
+   batch->namec++;
+ }
+ closedir(dirpt);
+ pthread_mutex_lock(&(o->lock));
+ Xorriso_scan_push_chain(o, first, last);
+ pthread_mutex_unlock(&(o->lock));
+}
+
+
+/* lstat() the names and create read jobs for the sub directories */
+static void Xorriso_scan_stat_names(struct Xorriso_scan_aheaD *o,
+                                    struct Xorriso_scan_joB *job)
+{
+ int i, l, excl_mode;
+ struct stat stbuf;
+ struct Xorriso_scan_joB *first= NULL, *last= NULL, *sub;
+ struct XorrisO *xorriso;
+ char *path= NULL;
+
+ xorriso= o->xorriso;
+ excl_mode= xorriso->disk_excl_mode;
+ path= calloc(1, SfileadrL);
+ if(path == NULL)
+   return;
+ l= strlen(job->dir);
+ for(i= 0; i < job->namec && !o->stop; i++) {
+   if(l + 1 + strlen(job->names[i]) >= SfileadrL)
+ continue;
+   strcpy(path, job->dir);
+   if(l == 0 || path[l - 1] != '/')
+     strcat(path, "/");
+   strcat(path, job->names[i]);
+   if(lstat(path, &stbuf) == -1)
+ continue;
+   if(!S_ISDIR(stbuf.st_mode))
+ continue;
+   if(stbuf.st_dev != job->dev && !xorriso->do_follow_mount)
+ continue;
+   if((excl_mode & 1) &&
+      Exclusions_match(xorriso->disk_exclusions, path, !!(excl_mode & 4)) > 0)
+ continue;
+   sub= Xorriso_scan_job_new(path, stbuf.st_dev);
+   if(sub == NULL)
+ break;
+   if(last == NULL)
+     first= sub;
+   else
+     last->next= sub;
+   last= sub;
+ }
+ free(path);
+ pthread_mutex_lock(&(o->lock));
+ o->scanned+= job->namec;
+ Xorriso_scan_push_chain(o, first, last);
+ pthread_mutex_unlock(&(o->lock));
+}
+
+
+static void *Xorriso_scan_worker(void *arg)
+{
+ struct Xorriso_scan_aheaD *o;
+ struct Xorriso_scan_joB *job;
+
+ o= (struct Xorriso_scan_aheaD *) arg;
+ pthread_mutex_lock(&(o->lock));
+ while(1) {
+   while(!o->stop &&
+         (o->stack == NULL || o->scanned - o->consumed > o->lead)) {
+     if(o->stack == NULL && o->busy == 0)
+       goto ex; /* The whole tree is scanned */
+     pthread_cond_wait(&(o->cond), &(o->lock));
+   }
+   if(o->stop)
+ break;
+   job= o->stack;
+   o->stack= job->next;
+   job->next= NULL;
+   o->busy++;
+   pthread_mutex_unlock(&(o->lock));
+
+   if(job->namec == 0)
+     Xorriso_scan_read_dir(o, job);
+   else
+     Xorriso_scan_stat_names(o, job);
+   Xorriso_scan_job_destroy(&job);
+
+   pthread_mutex_lock(&(o->lock));
+   o->busy--;
+   if(o->busy == 0 && o->stack == NULL)
+     pthread_cond_broadcast(&(o->cond));
+ }
+ex:;
+ pthread_mutex_unlock(&(o->lock));
+ return(NULL);
+}
+
+
+/* Start to scan the disk tree under disk_path ahead of the tree walker,
+   if -disk_scan_threads is enabled and no scan is going on yet.
+   @return 1= scan started , 2= no scan needed , <=0 error
+*/
+int Xorriso_scan_ahead_start(struct XorrisO *xorriso, char *disk_path,
+                             int flag)
+{
+ int ret, i;
+ struct stat stbuf;
+ struct Xorriso_scan_aheaD *o= NULL;
+
+ if(xorriso->disk_scan_threads <= 0 || xorriso->scan_ahead != NULL)
+   return(2);
+ if(stat(disk_path, &stbuf) == -1 || !S_ISDIR(stbuf.st_mode))
+   return(2);
+
+ /* Exclusions_match() must not compile its index in the threads */
+ ret= Exclusions_compile(xorriso->disk_exclusions, 0);
+ if(ret <= 0)
+   return(2);
+
+ o= calloc(1, sizeof(struct Xorriso_scan_aheaD));
+ if(o == NULL)
+   goto no_mem;
+ o->xorriso= xorriso;
+ o->num_threads= xorriso->disk_scan_threads;
+ o->lead= 1024 * (off_t) o->num_threads;
+ o->threads= calloc(o->num_threads, sizeof(pthread_t));
+ if(o->threads == NULL)
+   goto no_mem;
+ o->stack= Xorriso_scan_job_new(disk_path, stbuf.st_dev);
+ if(o->stack == NULL)
+   goto no_mem;
+ pthread_mutex_init(&(o->lock), NULL);
+ pthread_cond_init(&(o->cond), NULL);
+ xorriso->scan_ahead= o;
+ for(i= 0; i < o->num_threads; i++) {
+   ret= pthread_create(&(o->threads[i]), NULL, Xorriso_scan_worker, o);
+   if(ret != 0)
+ break;
+   o->threads_started++;
+ }
+ if(o->threads_started == 0) {
+   Xorriso_scan_ahead_stop(xorriso, 0);
+   return(2);
+ }
+ return(1);
+no_mem:;
+ if(o != NULL) {
+   if(o->threads != NULL)
+     free((char *) o->threads);
+   free((char *) o);
+ }
+ Xorriso_no_malloc_memory(xorriso, NULL, 0);
+ return(-1);
+}
+
+
+/* Tell the scan that the tree walker inquired a file object.
+*/
+int Xorriso_scan_ahead_consumed(struct XorrisO *xorriso, int flag)
+{
+ struct Xorriso_scan_aheaD *o;
+
+ o= xorriso->scan_ahead;
+ if(o == NULL)
+   return(0);
+ pthread_mutex_lock(&(o->lock));
+ o->consumed++;
+ if(o->scanned - o->consumed == o->lead)
+   pthread_cond_broadcast(&(o->cond));
+ pthread_mutex_unlock(&(o->lock));
+ return(1);
+}
+
+
+/* End the scan, wait for its threads, and dispose the pending jobs.
+*/
+int Xorriso_scan_ahead_stop(struct XorrisO *xorriso, int flag)
+{
+ int i;
+ struct Xorriso_scan_aheaD *o;
+ struct Xorriso_scan_joB *job, *next;
+
+ o= xorriso->scan_ahead;
+ if(o == NULL)
+   return(0);
+ pthread_mutex_lock(&(o->lock));
+ o->stop= 1;
+ pthread_cond_broadcast(&(o->cond));
+ pthread_mutex_unlock(&(o->lock));
+ for(i= 0; i < o->threads_started; i++)
+   pthread_join(o->threads[i], NULL);
+ for(job= o->stack; job != NULL; job= next) {
+   next= job->next;
+   Xorriso_scan_job_destroy(&job);
+ }
+ pthread_cond_destroy(&(o->cond));
+ pthread_mutex_destroy(&(o->lock));
+ free((char *) o->threads);
+ free((char *) o);
+ xorriso->scan_ahead= NULL;
+ return(1);
+}
@@ -112,6 +112,13 @@ int Xorriso_make_mount_cmd(struct XorrisO *xorriso, char *cmd,
 
 int Xorriso_append_scdbackup_record(struct XorrisO *xorriso, int flag);
 
+int Xorriso_scan_ahead_start(struct XorrisO *xorriso, char *disk_path,
+                             int flag);
+
+int Xorriso_scan_ahead_consumed(struct XorrisO *xorriso, int flag);
+
+int Xorriso_scan_ahead_stop(struct XorrisO *xorriso, int flag);
+
 
 #endif /* ! Xorriso_pvt_diskop_includeD */
 
@@ -498,6 +498,8 @@ int Xorriso_aquire_drive(struct XorrisO *xorriso, char *adr, char *show_adr,
    ext|= isoburn_ropt_nomd5;
  if(xorriso->do_md5 & 32)
    ext|= isoburn_ropt_nomd5tag;
+ if(xorriso->lazy_dirs)
+   ext|= isoburn_ropt_lazy_dirs;
 
  isoburn_ropt_set_extensions(ropts, ext);
 
@@ -2200,6 +2202,12 @@ struct xorriso_md5_state {
                         2= slave has reached its end
                         3= slave failed to start
                       */
+  /* Protects slave_state and chunk_state. Changes of them get signalled
+     by chunk_cond.
+  */
+  pthread_mutex_t chunk_mutex;
+  pthread_cond_t chunk_cond;
+
   int chunk_size;
   int num_chunks;
   char **chunk;
@@ -2213,8 +2221,8 @@ struct xorriso_md5_state {
   int chunk_w_idx;    /* Write index. Operated by boss */
   int chunk_r_idx;    /* Read index. Operated by MD5 slave */
 
-  off_t w_sleeps;
-  off_t r_sleeps;
+  off_t w_waits;
+  off_t r_waits;
 
 };
 
@@ -2366,36 +2374,38 @@ static void *Xorriso__md5_slave(void *state_pt)
 {
  struct xorriso_md5_state *state;
  int ret, c_state, c_idx;
- static int u_wait= 1;
 
  state= state_pt;
+ pthread_mutex_lock(&(state->chunk_mutex));
  state->slave_state= 1;
+ pthread_cond_broadcast(&(state->chunk_cond));
 
  while(1) {
    c_idx= state->chunk_r_idx;
    c_state= state->chunk_state[c_idx];
    if(c_state == 1) {
+     pthread_mutex_unlock(&(state->chunk_mutex));
      ret= Xorriso_chunk_md5(state->xorriso, state->chunk[c_idx],
                             state->chunk_fill[c_idx], state->chunk_lba[c_idx],
                             state, 0);
+     pthread_mutex_lock(&(state->chunk_mutex));
      if(ret <= 0)
        goto ex;
      state->chunk_state[c_idx]= 2;
      state->chunk_r_idx= (c_idx + 1) % state->num_chunks;
+     pthread_cond_broadcast(&(state->chunk_cond));
    } else if(c_state == 3) {
      goto ex;
    } else {
-
-     /* >>> have a timeout ? */;
-
-     if(u_wait > 0)
-       usleep(u_wait);
-     state->r_sleeps++;
+     state->r_waits++;
+     pthread_cond_wait(&(state->chunk_cond), &(state->chunk_mutex));
    }
  }
 
 ex:;
  state->slave_state= 2;
+ pthread_cond_broadcast(&(state->chunk_cond));
+ pthread_mutex_unlock(&(state->chunk_mutex));
  return NULL;
 }
 
@@ -2403,7 +2413,7 @@ ex:;
 int Xorriso_start_chunk_md5(struct XorrisO *xorriso,
                             struct xorriso_md5_state *state, int flag)
 {
- int ret, u_wait= 1000;
+ int ret;
  pthread_attr_t attr;
  pthread_attr_t *attr_pt = NULL;
  pthread_t thread;
@@ -2420,61 +2430,76 @@ int Xorriso_start_chunk_md5(struct XorrisO *xorriso,
    ret= 0; goto ex;
  }
 
- while(state->slave_state != 1) {
-
-   /* >>> have a timeout ? */;
-     /* >>> if this fails set  state->slave_state= 3 */
-
-   usleep(u_wait);
- }
+ pthread_mutex_lock(&(state->chunk_mutex));
+ while(state->slave_state == 0)
+   pthread_cond_wait(&(state->chunk_cond), &(state->chunk_mutex));
+ pthread_mutex_unlock(&(state->chunk_mutex));
  ret= 1;
 ex:;
  return(ret);
 }
 
 
-int Xorriso__wait_chunk_md5(struct xorriso_md5_state *state,
-                            int u_wait, int flag)
+/* Wait until the chunk at the write index is free for new content.
+   Waiting ends too if the slave has ended prematurely.
+*/
+int Xorriso__wait_chunk_md5(struct xorriso_md5_state *state, int flag)
 {
- while(state->chunk_state[state->chunk_w_idx] == 1) {
-
-     /* >>> have a timeout ? */;
-
-     usleep(u_wait);
-     state->w_sleeps++;
-  }
-  return(1);
+ pthread_mutex_lock(&(state->chunk_mutex));
+ while(state->chunk_state[state->chunk_w_idx] == 1 &&
+       state->slave_state == 1) {
+   state->w_waits++;
+   pthread_cond_wait(&(state->chunk_cond), &(state->chunk_mutex));
+ }
+ pthread_mutex_unlock(&(state->chunk_mutex));
+ return(1);
 }
 
 
-int Xorriso__wait_slave_md5_end(struct xorriso_md5_state *state,
-                                int u_wait, int flag)
+/* Hand over the chunk at the write index to the slave and advance the
+   write index.
+   @param c_state  1= content readable , 3= end-of-processing
+*/
+int Xorriso__put_chunk_md5(struct xorriso_md5_state *state, int c_state,
+                           int fill, uint32_t lba, int flag)
 {
- while(state->slave_state == 1) {
+ pthread_mutex_lock(&(state->chunk_mutex));
+ state->chunk_fill[state->chunk_w_idx]= fill;
+ state->chunk_lba[state->chunk_w_idx]= lba;
+ state->chunk_state[state->chunk_w_idx]= c_state;
+ state->chunk_w_idx= (state->chunk_w_idx + 1) % state->num_chunks;
+ pthread_cond_broadcast(&(state->chunk_cond));
+ pthread_mutex_unlock(&(state->chunk_mutex));
+ return(1);
+}
 
-     /* >>> have a timeout ? */;
 
-     usleep(u_wait);
-  }
-  return(1);
+int Xorriso__wait_slave_md5_end(struct xorriso_md5_state *state, int flag)
+{
+ pthread_mutex_lock(&(state->chunk_mutex));
+ while(state->slave_state == 1)
+   pthread_cond_wait(&(state->chunk_cond), &(state->chunk_mutex));
+ pthread_mutex_unlock(&(state->chunk_mutex));
+ return(1);
 }
 
 
-int Xorriso__end_slave_md5(struct xorriso_md5_state *state,
-                                int u_wait, int flag)
+int Xorriso__end_slave_md5(struct xorriso_md5_state *state, int flag)
 {
  int i, ret;
 
+ if(state->slave_state != 1 && state->slave_state != 2)
+   return(1); /* slave was never started */
+
  /* Tell slave thread to end */
  for(i= 0; i < state->num_chunks; i++) {
-   ret= Xorriso__wait_chunk_md5(state, 10000, 0);
+   ret= Xorriso__wait_chunk_md5(state, 0);
    if(ret <= 0)
      return(ret);
-   state->chunk_state[state->chunk_w_idx]= 3;
-   state->chunk_w_idx= (state->chunk_w_idx + 1) % state->num_chunks;
+   Xorriso__put_chunk_md5(state, 3, 0, 0, 0);
  }
  /* Wait for slave to end */
- ret= Xorriso__wait_slave_md5_end(state, 10000, 0);
+ ret= Xorriso__wait_slave_md5_end(state, 0);
  if(ret <= 0)
    return(ret);
  return(1);
@@ -2507,6 +2532,8 @@ int Xorriso_check_interval(struct XorrisO *xorriso, struct SpotlisT *spotlist,
  size_t data_size;
  struct xorriso_md5_state state;
  int num_chunks, async_md5;
+ int sync_init= 0; /* bit0= spot_mutex , bit1= chunk_mutex , bit2= chunk_cond
+                    */
  static off_t chunks_limit= 256 * 1024 * 1024;
 
  memset(&state, 0, sizeof(state));
@@ -2588,18 +2615,27 @@ int Xorriso_check_interval(struct XorrisO *xorriso, struct SpotlisT *spotlist,
      state.chunk_lba[i]= 0;
    }
    ret= pthread_mutex_init(&(state.spot_mutex), NULL);
+   if(ret == 0) {
+     sync_init|= 1;
+     ret= pthread_mutex_init(&(state.chunk_mutex), NULL);
+   }
+   if(ret == 0) {
+     sync_init|= 2;
+     ret= pthread_cond_init(&(state.chunk_cond), NULL);
+   }
    if(ret != 0) {
      sprintf(xorriso->info_text,
              "-check_media: Cannot initialize thread mutex");
-     Xorriso_msgs_submit(xorriso, 0, xorriso->info_text, errno, "FAILURE", 0);
-     goto ex;
+     Xorriso_msgs_submit(xorriso, 0, xorriso->info_text, ret, "FAILURE", 0);
+     ret= -1; goto ex;
    }
+   sync_init|= 4;
  } else
    state.num_chunks= 0;
  state.chunk_w_idx= 0;
  state.chunk_r_idx= 0;
- state.w_sleeps= 0;
- state.r_sleeps= 0;
+ state.w_waits= 0;
+ state.r_waits= 0;
 
  if(async_md5) {
    ret= Xorriso_start_chunk_md5(xorriso, &state, 0);
@@ -2690,7 +2726,7 @@ abort_check:;
      pre_read_time= Sfile_microtime(0);
 
      if(async_md5) {
-       ret= Xorriso__wait_chunk_md5(&state, 1, 0);
+       ret= Xorriso__wait_chunk_md5(&state, 0);
        if(ret <= 0)
          goto ex;
        data_pt= state.chunk[state.chunk_w_idx];
@@ -2744,12 +2780,9 @@ abort_check:;
      /* MD5 checksumming */
      if(ctx != NULL) {
        if(async_md5) {
-         state.chunk_fill[state.chunk_w_idx]= to_read;
-         state.chunk_lba[state.chunk_w_idx]= i + from_lba;
-         state.chunk_state[state.chunk_w_idx]= 1;
          /* The MD5 thread will call Xorriso_chunk_md5() */
-
-         state.chunk_w_idx= (state.chunk_w_idx + 1) % state.num_chunks;
+         Xorriso__put_chunk_md5(&state, 1, (int) to_read,
+                                (uint32_t) (i + from_lba), 0);
        } else {
          ret= Xorriso_chunk_md5(xorriso, data_pt, to_read,
                                 (uint32_t) (i + from_lba), &state, 0);
@@ -2820,7 +2853,7 @@ failed_to_write:;
 
  /* MD5 checksumming : register result */
  if(async_md5) {
-   ret= Xorriso__end_slave_md5(&state, 10000, 0);
+   ret= Xorriso__end_slave_md5(&state, 0);
    if(ret <= 0)
      goto ex;
  }
@@ -2844,14 +2877,18 @@ failed_to_write:;
  ret= 1;
 ex:;
  if(async_md5) {
-   Xorriso__end_slave_md5(&state, 10000, 0);
+   Xorriso__end_slave_md5(&state, 0);
    sprintf(xorriso->info_text,
-           "async_chunks=%d , chunk_size=%ds , w_sleeps: %.f , r_sleeps: %.f",
-           state.num_chunks, read_chunk, (double) state.w_sleeps,
-           (double) state.r_sleeps);
+           "async_chunks=%d , chunk_size=%ds , w_waits: %.f , r_waits: %.f",
+           state.num_chunks, read_chunk, (double) state.w_waits,
+           (double) state.r_waits);
    Xorriso_msgs_submit(xorriso, 0, xorriso->info_text, 0, "DEBUG", 0);
-   if(state.chunk != NULL)
+   if(sync_init & 1)
      pthread_mutex_destroy(&(state.spot_mutex));
+   if(sync_init & 4)
+     pthread_cond_destroy(&(state.chunk_cond));
+   if(sync_init & 2)
+     pthread_mutex_destroy(&(state.chunk_mutex));
    Xorriso_free_meM(state.chunk);
    Xorriso_free_meM(state.chunk_state);
    Xorriso_free_meM(state.chunk_fill);
@@ -425,6 +425,8 @@ int Xorriso_set_filter(struct XorrisO *xorriso, void *in_node,
  if(filter_ret < 0) {
    ret= 0; goto ex;
  }
+ if(filter_ret == 1)
+   Xorriso_hln_note_node(xorriso, node, 0);
 
  ret= filter_ret;
 ex:;
@@ -646,7 +648,7 @@ int Xorriso_set_zisofs_params(struct XorrisO *xorriso, int flag)
  int ret;
  struct iso_zisofs_ctrl ctrl;
 
- ctrl.version= 0;
+ ctrl.version= 1;
  ctrl.compression_level= xorriso->zlib_level;
  if(xorriso->zisofs_block_size == (1 << 16))
    ctrl.block_size_log2= 16;
@@ -654,6 +656,7 @@ int Xorriso_set_zisofs_params(struct XorrisO *xorriso, int flag)
    ctrl.block_size_log2= 17;
  else
    ctrl.block_size_log2= 15;
+ ctrl.compress_threads= xorriso->zisofs_threads;
  ret= iso_zisofs_set_params(&ctrl, 0);
  Xorriso_process_msg_queues(xorriso,0);
  if(ret < 0) {
@@ -665,6 +668,23 @@ int Xorriso_set_zisofs_params(struct XorrisO *xorriso, int flag)
 }
 
 
+int Xorriso_set_filter_cache(struct XorrisO *xorriso, int flag)
+{
+ int ret;
+
+ ret= iso_filter_set_spill_params((off_t) xorriso->filter_cache_mem,
+                                  (off_t) xorriso->filter_cache_disk, NULL, 0);
+ Xorriso_process_msg_queues(xorriso,0);
+ if(ret < 0) {
+   Xorriso_report_iso_error(xorriso, "", ret,
+                      "Error when setting filter cache parameters", 0,
+                      "FAILURE", 1);
+   return(0);
+ }
+ return(1);
+}
+
+
 int Xorriso_status_zisofs(struct XorrisO *xorriso, char *filter, FILE *fp,
                           int flag)
 /*
@@ -679,7 +699,7 @@ int Xorriso_status_zisofs(struct XorrisO *xorriso, char *filter, FILE *fp,
  iso_gzip_get_refcounts(&gzip_count, &gunzip_count, 0);
  if((flag & 1) && xorriso->zlib_level == xorriso->zlib_level_default &&
     xorriso->zisofs_block_size == xorriso->zisofs_block_size_default &&
-    xorriso->zisofs_by_magic == 0 &&
+    xorriso->zisofs_by_magic == 0 && xorriso->zisofs_threads == 1 &&
     ziso_count == 0 && osiz_count == 0 &&
     gzip_count == 0 && gunzip_count == 0) {
    if(filter == NULL)
@@ -688,10 +708,12 @@ int Xorriso_status_zisofs(struct XorrisO *xorriso, char *filter, FILE *fp,
      return 2;
  }
  sprintf(xorriso->result_line,
-     "-zisofs level=%d:block_size=%dk:by_magic=%s:ziso_used=%.f:osiz_used=%.f",
+     "-zisofs level=%d:block_size=%dk:by_magic=%s:threads=%d",
      xorriso->zlib_level, xorriso->zisofs_block_size / 1024,
-     xorriso->zisofs_by_magic ? "on" : "off",
-     (double) ziso_count, (double) osiz_count);
+     xorriso->zisofs_by_magic ? "on" : "off", xorriso->zisofs_threads);
+ sprintf(xorriso->result_line + strlen(xorriso->result_line),
+         ":ziso_used=%.f:osiz_used=%.f",
+         (double) ziso_count, (double) osiz_count);
  sprintf(xorriso->result_line + strlen(xorriso->result_line),
          ":gzip_used=%.f:gunzip_used=%.f\n",
          (double) gzip_count, (double) gunzip_count);
@@ -965,7 +965,9 @@ int Xorriso_change_is_pending(struct XorrisO *xorriso, int flag)
 }
 
 
-/* @param flag bit0= do not set hln_change_pending */
+/* @param flag bit0= do not set hln_change_pending
+               bit1= changed nodes were registered by Xorriso_hln_note_node()
+*/
 int Xorriso_set_change_pending(struct XorrisO *xorriso, int flag)
 {
  int ret;
@@ -977,7 +979,11 @@ int Xorriso_set_change_pending(struct XorrisO *xorriso, int flag)
  /* Do not override mark of -as mkisofs -print-size */
  if(xorriso->volset_change_pending != 2)
     xorriso->volset_change_pending= 1;
- if(!(flag & 1))
+ if(flag & 1)
+   return(1);
+ if((flag & 2) && xorriso->hln_change_pending != 1)
+   xorriso->hln_change_pending= 2; /* Xorriso_hln_note_node() did it all */
+ else
    xorriso->hln_change_pending= 1;
  return(1);
 }
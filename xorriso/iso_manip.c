@@ -70,6 +70,7 @@ int Xorriso_transfer_properties(struct XorrisO *xorriso, struct stat *stbuf,
  iso_node_set_atime(node, stbuf->st_atime);
  iso_node_set_mtime(node, stbuf->st_mtime);
  iso_node_set_ctime(node, stbuf->st_ctime);
+ Xorriso_hln_note_node(xorriso, node, 0);
 
  if((xorriso->do_aaip & 5) && !(flag & 2)) {
    ret= iso_local_get_attrs(disk_path, &num_attrs, &names, &value_lengths,
@@ -253,6 +254,7 @@ ex:;
    }
    return(ret);
  }
+ Xorriso_hln_note_node(xorriso, *node, 0);
  if(LIBISO_ISREG(*node))
    xorriso->pacifier_byte_count+= iso_file_get_size((IsoFile *) *node);
  return(1);
@@ -337,7 +339,7 @@ int Xorriso_add_tree(struct XorrisO *xorriso, IsoDir *dir,
  IsoImage *volume;
  IsoNode *node;
  int ret, source_is_dir, source_is_link, fret, was_failure= 0;
- int do_not_dive, hide_attrs;
+ int do_not_dive, hide_attrs, scan_started= 0;
  struct DirseQ *dirseq= NULL;
  char *name, *img_name, *srcpt, *stbuf_src= "";
  struct stat stbuf, hstbuf;
@@ -373,6 +375,13 @@ int Xorriso_add_tree(struct XorrisO *xorriso, IsoDir *dir,
  if(ret<=0)
    goto ex;
 
+ if(!(flag & 1)) {
+   ret= Xorriso_scan_ahead_start(xorriso, disk_dir_path, 0);
+   if(ret < 0)
+     goto ex;
+   scan_started= (ret == 1);
+ }
+
  stbuf_src= disk_dir_path;
  if(lstat(disk_dir_path, &stbuf)==-1)
    goto cannot_open_dir;
@@ -428,6 +437,7 @@ cannot_open_dir:;
      Xorriso_msgs_submit(xorriso, 0, xorriso->info_text, 0, "FATAL", 0);
      {ret= -1; goto ex;}
    }
+   Xorriso_scan_ahead_consumed(xorriso, 0);
 
    /* Compare exclusions against disk_path resp. name */
    ret= Xorriso_path_is_excluded(xorriso, disk_path, 0); /* (is never param) */
@@ -440,7 +450,7 @@ cannot_open_dir:;
    if(hide_attrs != 3) {
      ret= Xorriso_path_is_hidden(xorriso, disk_path, 0);
      if(ret<0)
-       return(ret);
+       goto ex;
      if(ret>=0)
        hide_attrs|= ret;
    }
@@ -579,7 +589,8 @@ cannot_lstat:;
      Xorriso_pacifier_callback(xorriso, "files added", xorriso->pacifier_count,
                                xorriso->pacifier_total, "", 0);
 
-   Xorriso_set_change_pending(xorriso, 0);
+   Xorriso_hln_note_node(xorriso, node, 0);
+   Xorriso_set_change_pending(xorriso, 2);
    if(source_is_dir) {
      if(do_not_dive) {
        sprintf(xorriso->info_text, "Did not follow mount point : %s",
@@ -617,6 +628,8 @@ ex:
  Xorriso_process_msg_queues(xorriso,0);
  Linkitem_reset_stack(&own_link_stack, link_stack, 0);
  Dirseq_destroy(&dirseq, 0);
+ if(scan_started)
+   Xorriso_scan_ahead_stop(xorriso, 0);
  if(ret<=0)
    return(ret);
  return(!was_failure);
@@ -719,7 +732,7 @@ int Xorriso_copy_properties(struct XorrisO *xorriso,
  }
  Xorriso_transfer_properties(xorriso, &stbuf, disk_path, node,
                            ((flag & 2) >> 1) | ((flag & 1) << 5) | (flag & 4));
- Xorriso_set_change_pending(xorriso, 0);
+ Xorriso_set_change_pending(xorriso, 2);
  return(1);
 }
 
@@ -737,7 +750,8 @@ int Xorriso_add_symlink(struct XorrisO *xorriso, IsoDir *parent,
    Xorriso_report_iso_error(xorriso, nominal_path, ret,
                             "Cannot create symbolic link", 0, "FATAL", 1);
    ret= 0;
- }
+ } else
+   Xorriso_hln_note_node(xorriso, (IsoNode *) link, 0);
  return(ret);
 }
 
@@ -953,7 +967,8 @@ int Xorriso_graft_in(struct XorrisO *xorriso, void *boss_iter,
        }
 
        dir= hdir;
-       Xorriso_set_change_pending(xorriso, 0);
+       Xorriso_hln_note_node(xorriso, (IsoNode *) dir, 0);
+       Xorriso_set_change_pending(xorriso, 2);
        iso_node_set_ctime((IsoNode *) dir, time(NULL));
        iso_node_set_uid((IsoNode *) dir, geteuid());
        iso_node_set_gid((IsoNode *) dir, getegid());
@@ -976,7 +991,7 @@ attach_source:;
        ret= Xorriso_add_symlink(xorriso, dir, disk_path, apt, img_path, 0);
        if(ret <= 0)
          goto ex;
-       Xorriso_set_change_pending(xorriso, 0);
+       Xorriso_set_change_pending(xorriso, 2);
 
      } else if(is_dir) {
        Xorriso_transfer_properties(xorriso, &stbuf, disk_path,
@@ -1018,7 +1033,7 @@ attach_source:;
          Xorriso_msgs_submit(xorriso, 0, xorriso->info_text, 0, "FAILURE", 0);
          {ret= 0; goto ex;}
        }
-       Xorriso_set_change_pending(xorriso, 0);
+       Xorriso_set_change_pending(xorriso, 2);
        iso_node_set_name(node, apt);
 
        xorriso->pacifier_count++;
@@ -1113,7 +1128,8 @@ handle_path_node:;
      }
 
      dir= hdir;
-     Xorriso_set_change_pending(xorriso, 0);
+     Xorriso_hln_note_node(xorriso, (IsoNode *) dir, 0);
+     Xorriso_set_change_pending(xorriso, 2);
      iso_node_set_ctime((IsoNode *) dir, time(NULL));
      iso_node_set_uid((IsoNode *) dir, geteuid());
      iso_node_set_gid((IsoNode *) dir, getegid());
@@ -1163,7 +1179,7 @@ attach_source:;
          Xorriso_msgs_submit(xorriso, 0, xorriso->info_text, 0, "FAILURE", 0);
          {ret= 0; goto ex;}
        }
-       Xorriso_set_change_pending(xorriso, 0);
+       Xorriso_set_change_pending(xorriso, 2);
        iso_node_set_name(node, apt);
 
        xorriso->pacifier_count++;
@@ -1546,7 +1562,8 @@ dir_not_removed:;
 
  if(flag&16)
    xorriso->pacifier_count++;
- Xorriso_set_change_pending(xorriso, 0);
+ /* Removed nodes get dropped from hln_array when it gets merged */
+ Xorriso_set_change_pending(xorriso, 2);
  ret= 1+!!is_dir;
 ex:;
  if(sfe!=NULL)
@@ -1733,7 +1750,8 @@ int Xorriso_rename(struct XorrisO *xorriso, void *boss_iter,
    Xorriso_msgs_submit(xorriso, 0, xorriso->info_text, 0, "FATAL", 0);
    {ret= -1; goto ex;}
  }
- Xorriso_set_change_pending(xorriso, 0);
+ Xorriso_hln_note_node(xorriso, node, 0);
+ Xorriso_set_change_pending(xorriso, 2);
  ret= 1;
 ex:;
  Xorriso_free_meM(eff_dest);
@@ -1840,7 +1858,8 @@ int Xorriso_clone_tree(struct XorrisO *xorriso, void *boss_iter,
    Xorriso_cannot_clone(xorriso, eff_origin, eff_dest, ret, 0);
    {ret= 0; goto ex;}
  }
- Xorriso_set_change_pending(xorriso, 0);
+ Xorriso_hln_note_node(xorriso, new_node, 1);
+ Xorriso_set_change_pending(xorriso, 2);
  if(!(flag & 2)) {
    strcpy(xorriso->info_text, "Cloned in ISO image: ");
    Text_shellsafe(eff_origin, xorriso->info_text, 1);
@@ -1910,12 +1929,13 @@ int Xorriso_clone_under(struct XorrisO *xorriso, char *origin, char *dest,
          Xorriso_cannot_clone(xorriso, eff_origin, eff_dest, ret, 0);
          ret= 0; goto ex;
        }
+       Xorriso_hln_note_node(xorriso, new_node, 1);
      }
    }   
    iso_dir_iter_free(iter);
    iter= NULL;
  }
- Xorriso_set_change_pending(xorriso, 0);
+ Xorriso_set_change_pending(xorriso, 2);
  ret= 1;
 ex:;
  if(iter != NULL)
@@ -1947,7 +1967,8 @@ int Xorriso_set_st_mode(struct XorrisO *xorriso, char *in_path,
          (unsigned int) (mode & 0xffff));
  Text_shellsafe(path, xorriso->info_text, 1);
  Xorriso_msgs_submit(xorriso, 0, xorriso->info_text, 0, "DEBUG", 0);
- Xorriso_set_change_pending(xorriso, 0);
+ Xorriso_hln_note_node(xorriso, node, 0);
+ Xorriso_set_change_pending(xorriso, 2);
  Xorriso_process_msg_queues(xorriso,0);
  ret= 1;
 ex:;
@@ -1967,7 +1988,8 @@ int Xorriso_set_uid(struct XorrisO *xorriso, char *in_path, uid_t uid,
    return(ret);
  iso_node_set_uid(node, uid);
  iso_node_set_ctime(node, time(NULL));
- Xorriso_set_change_pending(xorriso, 0);
+ Xorriso_hln_note_node(xorriso, node, 0);
+ Xorriso_set_change_pending(xorriso, 2);
  Xorriso_process_msg_queues(xorriso,0);
  return(1);
 }
@@ -1984,7 +2006,8 @@ int Xorriso_set_gid(struct XorrisO *xorriso, char *in_path, gid_t gid,
    return(ret);
  iso_node_set_gid(node, gid);
  iso_node_set_ctime(node, time(NULL));
- Xorriso_set_change_pending(xorriso, 0);
+ Xorriso_hln_note_node(xorriso, node, 0);
+ Xorriso_set_change_pending(xorriso, 2);
  Xorriso_process_msg_queues(xorriso,0);
  return(1);
 }
@@ -2008,7 +2031,8 @@ int Xorriso_set_time(struct XorrisO *xorriso, char *in_path, time_t t,
    iso_node_set_mtime(node, t);
  if(!(flag&(2|256)))
    iso_node_set_ctime(node, time(NULL));
- Xorriso_set_change_pending(xorriso, 0);
+ Xorriso_hln_note_node(xorriso, node, 0);
+ Xorriso_set_change_pending(xorriso, 2);
  Xorriso_process_msg_queues(xorriso,0);
  return(1);
 }
@@ -2030,6 +2054,7 @@ int Xorriso_mkisofs_lower_r(struct XorrisO *xorriso, IsoNode *node, int flag)
    perms|= (S_IXUSR | S_IXGRP | S_IXOTH);
  perms&= ~(S_ISUID | S_ISGID | S_ISVTX);
  iso_node_set_permissions(node, perms);
+ Xorriso_hln_note_node(xorriso, node, 0);
  return(1);
 }
 
@@ -2066,7 +2091,8 @@ int Xorriso_setfacl(struct XorrisO *xorriso, void *in_node, char *path,
    }
    ret= 0; goto ex;
  }
- Xorriso_set_change_pending(xorriso, 0);
+ Xorriso_hln_note_node(xorriso, node, 0);
+ Xorriso_set_change_pending(xorriso, 2);
  ret= 1;
 ex:;
  Xorriso_process_msg_queues(xorriso,0);
@@ -2115,7 +2141,8 @@ int Xorriso_setfattr(struct XorrisO *xorriso, void *in_node, char *path,
    }
    ret= 0; goto ex;
  }
- Xorriso_set_change_pending(xorriso, 0);
+ Xorriso_hln_note_node(xorriso, node, 0);
+ Xorriso_set_change_pending(xorriso, 2);
  ret= 1;
 ex:;
  Xorriso_process_msg_queues(xorriso,0);
@@ -2528,11 +2555,14 @@ int Xorriso_findi_action(struct XorrisO *xorriso, struct FindjoB *job,
  } else if(action == 30) { /* internal: count */
    xorriso->node_counter++;
  } else if(action == 31) { /* internal: register */
-   if(xorriso->node_counter < xorriso->node_array_size) {
-     xorriso->node_array[xorriso->node_counter++]= (void *) node;
-     iso_node_ref(node); /* In case node gets deleted from tree during
-                            the lifetime of xorriso->node_array */
+   if(xorriso->node_counter >= xorriso->node_array_size) {
+     ret= Xorriso_grow_node_array(xorriso, 0);
+     if(ret <= 0)
+       return(-1);
    }
+   xorriso->node_array[xorriso->node_counter++]= (void *) node;
+   iso_node_ref(node); /* In case node gets deleted from tree during
+                          the lifetime of xorriso->node_array */
  } else if(action == 32) { /* internal: widen_hardlinks disk_equiv */
    Findjob_get_start_path(job, &iso_prefix, 0);
    ret= Xorriso_widen_hardlink(xorriso, (void *) boss_iter, node, abs_path,
@@ -3364,7 +3394,7 @@ ex:;
 }
 
 
-int Xorriso_all_node_array(struct XorrisO *xorriso, int addon_nodes, int flag)
+int Xorriso_all_node_array(struct XorrisO *xorriso, int flag)
 {  
  int ret;
  struct FindjoB *job= NULL;
@@ -3375,15 +3405,9 @@ int Xorriso_all_node_array(struct XorrisO *xorriso, int addon_nodes, int flag)
    Xorriso_no_findjob(xorriso, "xorriso", 0);
    {ret= -1; goto ex;}
  }
- Findjob_set_action_target(job, 30, NULL, 0);
+ /* A single tree traversal. node_array grows as needed and later additions
+    of addon nodes by the caller will grow it too. */
  Xorriso_destroy_node_array(xorriso, 0);
- ret= Xorriso_findi(xorriso, job, NULL, (off_t) 0, NULL, "/",
-                    &dir_stbuf, 0, 0);
- if(ret <= 0)
-   goto ex;
- ret= Xorriso_new_node_array(xorriso, xorriso->temp_mem_limit, addon_nodes, 0);
- if(ret <= 0)
-   goto ex;
  Findjob_set_action_target(job, 31, NULL, 0);
  ret= Xorriso_findi(xorriso, job, NULL, (off_t) 0, NULL, "/",
                     &dir_stbuf, 0, 0);
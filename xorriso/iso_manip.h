@@ -62,7 +62,7 @@ int Xorriso_findi_headline(struct XorrisO *xorriso, struct FindjoB *job,
 int Xorriso_findi_sorted(struct XorrisO *xorriso, struct FindjoB *job,
                          off_t boss_mem, int filec, char **filev, int flag);
 
-int Xorriso_all_node_array(struct XorrisO *xorriso, int addon_nodes, int flag);
+int Xorriso_all_node_array(struct XorrisO *xorriso, int flag);
 
 
 int Xorriso__file_start_lba(IsoNode *node, int *lba, int flag);
@@ -119,7 +119,7 @@ int Xorriso_startup_libraries(struct XorrisO *xorriso, int flag)
 {
  int ret, major, minor, micro;
  char *queue_sev, *print_sev, reason[1024];
- struct iso_zisofs_ctrl zisofs_ctrl= {0, 6, 15};
+ struct iso_zisofs_ctrl zisofs_ctrl= {1, 6, 15, 1};
 
 
 /* First an ugly compile time check for header version compatibility.
@@ -218,6 +218,7 @@ LIBISOBURN_MISCONFIGURATION_ = 0;
        (1 << zisofs_ctrl.block_size_log2);
    xorriso->zlib_level= xorriso->zlib_level_default=
        zisofs_ctrl.compression_level;
+   xorriso->zisofs_threads= zisofs_ctrl.compress_threads;
  }
 
  iso_node_xinfo_make_clonable(Xorriso__mark_update_xinfo,
@@ -755,6 +756,11 @@ int Xorriso_jigdo_interpreter(struct XorrisO *xorriso, char *aspect, char *arg,
    if(ret <= 0)
      goto jte_failed;
    xorriso->libjte_params_given|= 16;
+ } else if(strcmp(aspect, "md5_cache_path") == 0) {
+   ret= libjte_set_md5_cache_path(jte, arg);
+   if(ret <= 0)
+     goto jte_failed;
+   xorriso->libjte_params_given|= 4096;
  } else if(strcmp(aspect, "min_size") == 0 ||
            strcmp(aspect, "-jigdo-min-file-size") == 0) {
    num= Scanf_io_size(arg, 0);
@@ -52,6 +52,22 @@ int Xorriso_option_data_cache_size(struct XorrisO *xorriso, char *num_tiles,
 }
 
 
+/* Command -dedup_content "on"|"off" */
+int Xorriso_option_dedup_content(struct XorrisO *xorriso, char *mode, int flag)
+{
+ if(strcmp(mode, "on") == 0)
+   xorriso->dedup_content= 1;
+ else if(strcmp(mode, "off") == 0)
+   xorriso->dedup_content= 0;
+ else {
+   sprintf(xorriso->info_text, "-dedup_content: unknown mode '%s'", mode);
+   Xorriso_msgs_submit(xorriso, 0, xorriso->info_text, 0, "SORRY", 0);
+   return(0);
+ }
+ return(1);
+}
+
+
 /* Options -dev , -indev, -outdev */
 /** @param flag bit0= use as indev
                 bit1= use as outdev
@@ -220,6 +236,28 @@ int Xorriso_option_disk_pattern(struct XorrisO *xorriso, char *mode, int flag)
 }
 
 
+/* Command -disk_scan_threads "off"|number */
+int Xorriso_option_disk_scan_threads(struct XorrisO *xorriso, char *mode,
+                                     int flag)
+{
+ int threads= -1;
+
+ if(strcmp(mode, "off") == 0) {
+   xorriso->disk_scan_threads= 0;
+   return(1);
+ }
+ sscanf(mode, "%d", &threads);
+ if(threads < 0 || threads > 64) {
+   sprintf(xorriso->info_text,
+           "-disk_scan_threads: wrong number of threads: '%s'", mode);
+   Xorriso_msgs_submit(xorriso, 0, xorriso->info_text, 0, "SORRY", 0);
+   return(0);
+ }
+ xorriso->disk_scan_threads= threads;
+ return(1);
+}
+
+
 /* Option -displacement [-]offset */
 int Xorriso_option_displacement(struct XorrisO *xorriso, char *value, int flag)
 {
@@ -622,6 +660,37 @@ int Xorriso_option_extract_cut(struct XorrisO *xorriso, char *iso_rr_path,
 }
 
 
+/* Option -file_readers "off"|number[":"number] */
+int Xorriso_option_file_readers(struct XorrisO *xorriso, char *mode, int flag)
+{
+ int readers= 0, prefetch= 0;
+ char *cpt;
+
+ if(strcmp(mode, "off") == 0 || strcmp(mode, "0") == 0) {
+   xorriso->file_readers= 0;
+   xorriso->file_prefetch= 0;
+   return(1);
+ }
+ sscanf(mode, "%d", &readers);
+ cpt= strchr(mode, ':');
+ if(cpt != NULL)
+   sscanf(cpt + 1, "%d", &prefetch);
+ else
+   prefetch= 2 * readers;
+ if(readers < 1 || readers > 64 || prefetch < 0 || prefetch > 1024) {
+   sprintf(xorriso->info_text,
+           "-file_readers: wrong number of threads or files: '%s'", mode);
+   Xorriso_msgs_submit(xorriso, 0, xorriso->info_text, 0, "SORRY", 0);
+   return(0);
+ }
+ if(prefetch < readers)
+   prefetch= readers;
+ xorriso->file_readers= readers;
+ xorriso->file_prefetch= prefetch;
+ return(1);
+}
+
+
 /* Option -file_size_limit */
 int Xorriso_option_file_size_limit(struct XorrisO *xorriso,
                                    int argc, char **argv, int *idx, int flag)
@@ -660,6 +729,33 @@ ex:;
 }
 
 
+/* Option -filter_cache "off"|mem_size[":"disk_size] */
+int Xorriso_option_filter_cache(struct XorrisO *xorriso, char *mode, int flag)
+{
+ double mem= 0.0, disk= 0.0;
+ char *cpt, num[80];
+
+ if(strcmp(mode, "off") != 0) {
+   strncpy(num, mode, sizeof(num) - 1);
+   num[sizeof(num) - 1]= 0;
+   cpt= strchr(num, ':');
+   if(cpt != NULL) {
+     *cpt= 0;
+     disk= Scanf_io_size(cpt + 1, 0);
+   }
+   mem= Scanf_io_size(num, 0);
+   if(mem < 0 || disk < 0) {
+     sprintf(xorriso->info_text, "-filter_cache: wrong size: '%s'", mode);
+     Xorriso_msgs_submit(xorriso, 0, xorriso->info_text, 0, "SORRY", 0);
+     return(0);
+   }
+ }
+ xorriso->filter_cache_mem= mem;
+ xorriso->filter_cache_disk= disk;
+ return(Xorriso_set_filter_cache(xorriso, 0));
+}
+
+
 /* Option -find alias -findi, and -findx */
 /* @param flag bit0= -findx rather than -findi
                bit1= do not reset pacifier, no final pacifier message
@@ -1572,7 +1668,7 @@ int Xorriso_option_help(struct XorrisO *xorriso, int flag)
 "  -disk_dev_ino \"on\"|\"ino_only\"|\"off\"",
 "                 Enable resp. disable recording of disk file dev_t and ino_t",
 "                 and their use in file comparison.",
-"  -md5 \"on\"|\"all\"|\"off\"",
+"  -md5 \"on\"|\"all\"|\"stat_check\"|\"off\"",
 "                 Enable resp. disable processing of MD5 checksums.",
 "  -scdbackup_tag list_path record_name",
 "                 Enable production of scdbackup tag with -md5 on",
@@ -1582,6 +1678,8 @@ int Xorriso_option_help(struct XorrisO *xorriso, int flag)
 "                 Classify stdio drives by effective access permissions.",
 "  -data_cache_size number_of_tiles blocks_per_tile",
 "                 Adjust size and granularity of the data read cache.",
+"  -lazy_dirs \"on\"|\"off\"",
+"                 Read ISO directories only when they get used.",
 "  -blank [\"force:\"]\"fast\"|\"all\"|\"deformat\"|\"deformat_quickest\"",
 "                 Blank medium resp. invalidate ISO image on medium.",
 "                 Prefix \"force:\" overrides medium evaluation.",
@@ -1616,7 +1714,7 @@ int Xorriso_option_help(struct XorrisO *xorriso, int flag)
 "  -jigdo \"clear\"|\"template_path\"|\"jigdo_path\"|\"md5_path\"",
 "         |\"min_size\"|\"checksum_iso\"|\"checksum_template\"",
 "         |\"compression\"|\"exclude\"|\"demand_md5\"|\"mapping\"",
-"         |\"checksum_iso\"|\"checksum_template\"",
+"         |\"checksum_iso\"|\"checksum_template\"|\"md5_cache_path\"",
 "         value",
 "                 Clear Jigdo Template Extraction parameter list or add a",
 "                 parameter with its value to that list.",
@@ -1834,6 +1932,9 @@ int Xorriso_option_help(struct XorrisO *xorriso, int flag)
 "                 Control effect of exclusion lists.",
 "  -follow \"on\"|\"pattern:param:link:mount:limit=#\"|\"default\"|\"off\"",
 "                 Follow symbolic links and mount points within disk_path.",
+"  -disk_scan_threads \"off\"|number",
+"                 Set the number of threads which inquire disk directories",
+"                 and files ahead of their insertion.",
 "  -overwrite \"on\"|\"nondir\"|\"off\"",
 "                 Allow or disallow to overwrite existing files in ISO image.",
 "  -split_size number[\"k\"|\"m\"]",
@@ -1869,6 +1970,9 @@ int Xorriso_option_help(struct XorrisO *xorriso, int flag)
 "                 Builtin filters are --gzip , --gunzip, --zisofs .",
 "  -set_filter_r name iso_rr_path [***]",
 "                 Like -set_filter but affecting all files below directories.",
+"  -filter_cache \"off\"|size[\":\"size]",
+"                 Keep filter output of size determination in memory and in",
+"                 a temporary file, so that writing need not filter again.",
 "",
 "zisofs is a compression format which is recognized by some Linux kernels.",
 "xorriso supports it by builtin filter \"--zisofs\" which is to be applied by",
@@ -1877,6 +1981,7 @@ int Xorriso_option_help(struct XorrisO *xorriso, int flag)
 "  -zisofs option[:options]",
 "                 Set global zisofs parameters:",
 "                   level=0|...|9 , block_size=32k|64k|128k , by_magic=on|off",
+"                   threads=1|...|64",
 "",
 "Write-to-media commands:",
 "  -rollback      Discard the manipulated ISO image and reload it.",
@@ -1910,6 +2015,11 @@ int Xorriso_option_help(struct XorrisO *xorriso, int flag)
 "                 pseudo drives. \"on\" is the same as 16m.",
 "  -fs number[\"k\"|\"m\"]",
 "                 Set the size of the fifo buffer. (Default is 4m)",
+"  -file_readers \"off\"|number[\":\"number]",
+"                 Set the number of threads which read data files ahead of",
+"                 the image output, and the number of files in read-ahead.",
+"  -dedup_content \"on\"|\"off\"",
+"                 Write data files with identical content only once.",
 "  -eject \"in\"|\"out\"|\"all\"",
 "                 Immediately eject the medium in -indev, resp. -outdev,",
 "                 resp. both.",
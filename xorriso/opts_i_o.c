@@ -74,6 +74,22 @@ int Xorriso_option_joliet(struct XorrisO *xorriso, char *mode, int flag)
 }
 
 
+/* Command -lazy_dirs */
+int Xorriso_option_lazy_dirs(struct XorrisO *xorriso, char *mode, int flag)
+{
+ if(strcmp(mode, "off")==0)
+   xorriso->lazy_dirs= 0;
+ else if(strcmp(mode, "on")==0)
+   xorriso->lazy_dirs= 1;
+ else {
+   sprintf(xorriso->info_text, "-lazy_dirs: unknown mode '%s'", mode);
+   Xorriso_msgs_submit(xorriso, 0, xorriso->info_text, 0, "FAILURE", 0);
+   return(0);
+ }
+ return(1);
+}
+
+
 /* Command -launch_frontend */
 int Xorriso_option_launch_frontend(struct XorrisO *xorriso,
                                    int argc, char **argv, int *idx, int flag)
@@ -737,15 +753,17 @@ int Xorriso_option_md5(struct XorrisO *xorriso, char *mode, int flag)
    if(l == 0)
  continue;
    if(l == 3 && strncmp(cpt, "off", l) == 0)
-     xorriso->do_md5&= ~31;
+     xorriso->do_md5&= ~(31 | 64);
    else if(l == 2 && strncmp(cpt, "on", l) == 0)
-     xorriso->do_md5= (xorriso->do_md5 & ~31) | 7 | 16;
+     xorriso->do_md5= (xorriso->do_md5 & ~(31 | 64)) | 7 | 16;
    else if(l == 3 && strncmp(cpt, "all", l) == 0)
-     xorriso->do_md5|= 31;
+     xorriso->do_md5= (xorriso->do_md5 & ~64) | 31;
+   else if(l == 10 && strncmp(cpt, "stat_check", l) == 0)
+     xorriso->do_md5= (xorriso->do_md5 & ~(31 | 64)) | 7 | 16 | 64;
    else if(l == 18 && strncmp(cpt, "stability_check_on", l) == 0)
-     xorriso->do_md5|= 8;
+     xorriso->do_md5= (xorriso->do_md5 & ~64) | 8;
    else if(l == 19 && strncmp(cpt, "stability_check_off", l) == 0)
-     xorriso->do_md5&= ~8;
+     xorriso->do_md5&= ~(8 | 64);
    else if(l == 13 && strncmp(cpt, "load_check_on", l) == 0)
      xorriso->do_md5&= ~32;
    else if(l == 14 && strncmp(cpt, "load_check_off", l) == 0)
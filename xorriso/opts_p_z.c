@@ -2009,12 +2009,13 @@ int Xorriso_option_xattr(struct XorrisO *xorriso, char *mode, int flag)
 /* Option -zisofs */
 int Xorriso_option_zisofs(struct XorrisO *xorriso, char *mode, int flag)
 {
- int was_level, was_blocksize, ret, l;
+ int was_level, was_blocksize, was_threads, ret, l;
  double num;
  char *cpt, *npt, text[16];
 
  was_level= xorriso->zlib_level;
  was_blocksize= xorriso->zisofs_block_size;
+ was_threads= xorriso->zisofs_threads;
  npt= cpt= mode;
  for(cpt= mode; npt!=NULL; cpt= npt+1) {
    npt= strchr(cpt,':');
@@ -2035,6 +2036,17 @@ int Xorriso_option_zisofs(struct XorrisO *xorriso, char *mode, int flag)
      }
      xorriso->zlib_level= num;
 
+   } else if(strncmp(cpt, "threads=", 8) == 0) {
+     num= 0.0;
+     sscanf(cpt + 8, "%lf", &num);
+     if(num < 1 || num > 64) {
+       sprintf(xorriso->info_text,
+               "-zisofs: Wrong number of threads '%s' (allowed 1...64)",
+               cpt + 8);
+       goto sorry_ex;
+     }
+     xorriso->zisofs_threads= num;
+
    } else if(strncmp(cpt, "ziso_used=", 10) == 0 ||
              strncmp(cpt, "osiz_used=", 10) == 0) {
      /* (ignored info from -status) */;
@@ -2063,6 +2075,7 @@ int Xorriso_option_zisofs(struct XorrisO *xorriso, char *mode, int flag)
      xorriso->zlib_level= xorriso->zlib_level_default;
      xorriso->zisofs_block_size= xorriso->zisofs_block_size_default;
      xorriso->zisofs_by_magic= 0;
+     xorriso->zisofs_threads= 1;
 
    } else {
 unknown_mode:;
@@ -2074,6 +2087,7 @@ sorry_ex:
      Xorriso_msgs_submit(xorriso, 0, xorriso->info_text, 0, "FAILURE", 0);
      xorriso->zlib_level= was_level;
      xorriso->zisofs_block_size= was_blocksize;
+     xorriso->zisofs_threads= was_threads;
      return(0);
    }
  }
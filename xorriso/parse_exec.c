@@ -504,11 +504,13 @@ int Xorriso_count_args(struct XorrisO *xorriso, int argc, char **argv,
     "backslash_codes","blank","biblio_file",
     "calm_drive","cd","cdi","cdx","changes_pending","charset",
     "close","close_damaged",
-    "commit_eject","compliance","copyright_file",
-    "dev","dialog","disk_dev_ino","disk_pattern","displacement",
-    "dummy","dvd_obs","early_stdio_test", "eject",
+    "commit_eject","compliance","copyright_file","dedup_content",
+    "dev","dialog","disk_dev_ino","disk_pattern","disk_scan_threads",
+    "displacement",
+    "dummy","dvd_obs","early_stdio_test", "eject","file_readers",
+    "filter_cache",
     "iso_rr_pattern","follow","format","fs","gid","grow_blindly","hardlinks",
-    "hfsplus","history","indev","in_charset","joliet",
+    "hfsplus","history","indev","in_charset","joliet","lazy_dirs",
     "list_delimiter","list_extras","list_profiles","local_charset",
     "mark","md5","mount_opts","not_leaf","not_list","not_mgt",
     "options_from_file","osirrox","outdev","out_charset","overwrite",
@@ -650,7 +652,7 @@ int Xorriso_cmd_sorting_rank(struct XorrisO *xorriso,
    "load", "displacement", "drive_class", "assert_volid", "in_charset",
    "auto_charset", "hardlinks", "acl", "xattr", "md5", "for_backup",
    "disk_dev_ino", "rom_toc_scan", "calm_drive", "ban_stdio_write",
-   "early_stdio_test", "data_cache_size",
+   "early_stdio_test", "data_cache_size", "lazy_dirs",
 
    "* Character sets:",
    "charset", "local_charset",
@@ -664,7 +666,8 @@ int Xorriso_cmd_sorting_rank(struct XorrisO *xorriso,
 
    "* Settings for file insertion:",
    "file_size_limit", "not_mgt", "not_paths", "not_leaf", "not_list",
-   "quoted_not_list", "follow", "pathspecs", "overwrite", "split_size",
+   "quoted_not_list", "follow", "disk_scan_threads", "pathspecs", "overwrite",
+   "split_size",
 
    "* Navigation in ISO image and disk filesystem (1):",
    "cd", "cdx", "pwd", "pwdx",
@@ -691,7 +694,7 @@ int Xorriso_cmd_sorting_rank(struct XorrisO *xorriso,
 
    "* Filters for data file content:",
    "external_filter", "unregister_filter", "close_filter_list",
-   "set_filter", "set_filter_r", 
+   "set_filter", "set_filter_r", "filter_cache",
 
    "* Tree traversal command -find:",
    "find",
@@ -708,7 +711,9 @@ int Xorriso_cmd_sorting_rank(struct XorrisO *xorriso,
    "abstract_file", "biblio_file", "preparer_id", "out_charset",
    "read_mkisofsrc",
    "uid", "gid", "zisofs", "speed", "stream_recording", "dvd_obs",
-   "stdio_sync", "dummy", "fs", "close", "padding", "write_type",
+   "stdio_sync", "dummy", "fs", "file_readers", "dedup_content", "close",
+   "padding",
+   "write_type",
    "grow_blindly", "pacifier", "scdbackup_tag",
 
    "* Bootable ISO images:",
@@ -1174,6 +1179,10 @@ next_command:;
    (*idx)+= 2;
    ret= Xorriso_option_data_cache_size(xorriso, arg1, arg2, 0);
 
+ } else if(strcmp(cmd,"dedup_content")==0) {
+   (*idx)++;
+   ret= Xorriso_option_dedup_content(xorriso, arg1, 0);
+
  } else if(strcmp(cmd,"dev")==0) {
    (*idx)++;
    ret= Xorriso_option_dev(xorriso, arg1, 3);
@@ -1192,6 +1201,10 @@ next_command:;
    (*idx)++;
    ret= Xorriso_option_disk_dev_ino(xorriso, arg1, 0);
 
+ } else if(strcmp(cmd,"disk_scan_threads")==0) {
+   (*idx)++;
+   ret= Xorriso_option_disk_scan_threads(xorriso, arg1, 0);
+
  } else if(strcmp(cmd,"displacement")==0) {
    (*idx)++;
    ret= Xorriso_option_displacement(xorriso, arg1, 0);
@@ -1268,9 +1281,17 @@ next_command:;
    (*idx)+= 2;
    ret= Xorriso_option_extract(xorriso, arg1, arg2, 32);
 
+ } else if(strcmp(cmd,"file_readers")==0) {
+   (*idx)++;
+   ret= Xorriso_option_file_readers(xorriso, arg1, 0);
+
  } else if(strcmp(cmd,"file_size_limit")==0) {
    ret= Xorriso_option_file_size_limit(xorriso, argc, argv, idx, 0);
 
+ } else if(strcmp(cmd,"filter_cache")==0) {
+   (*idx)++;
+   ret= Xorriso_option_filter_cache(xorriso, arg1, 0);
+
  } else if(strcmp(cmd,"find")==0 || strcmp(cmd,"findi")==0) {
    ret= Xorriso_option_find(xorriso, argc, argv, idx, 0);
 
@@ -1359,6 +1380,10 @@ next_command:;
  } else if(strcmp(cmd, "launch_frontend") == 0) {
    ret= Xorriso_option_launch_frontend(xorriso, argc, argv, idx, 0);
 
+ } else if(strcmp(cmd, "lazy_dirs") == 0) {
+   (*idx)++;
+   ret= Xorriso_option_lazy_dirs(xorriso, arg1, 0);
+
  } else if(strcmp(cmd, "list_arg_sorting") == 0) {
    ret= Xorriso_option_list_arg_sorting(xorriso, 0);
 
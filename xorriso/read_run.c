@@ -27,6 +27,7 @@
 
 #include <fcntl.h>
 #include <utime.h>
+#include <pthread.h>
 
 
 #include "lib_mgt.h"
@@ -416,6 +417,203 @@ ex:;
 }
 
 
+/* ---------------------------- Restore writer ---------------------------- */
+
+/* Size of the chunks in which data files get copied from ISO to disk.
+   Chunks of many blocks get read from the drive by a single transaction.
+*/
+#define Xorriso_restore_chunK (1024 * 1024)
+
+/* Number of chunks which may wait for the writer thread */
+#define Xorriso_restore_slotS 4
+
+
+/* Writes the chunks of a large data file to disk while the next chunks
+   get read from the ISO image.
+*/
+struct Xorriso_restore_writeR {
+
+ int fd;
+
+ char *bufs[Xorriso_restore_slotS];
+ int starts[Xorriso_restore_slotS];
+ int counts[Xorriso_restore_slotS];
+
+ /* Ring of filled slots: next one to write, next one to fill, number */
+ int head;
+ int tail;
+ int filled;
+
+ int eof;
+ int failed;
+ int w_errno;
+
+ off_t handed;
+ off_t written;
+
+ pthread_mutex_t lock;
+ pthread_cond_t cond;
+ pthread_t thread;
+
+};
+
+
+static void *Xorriso_restore_writer_loop(void *state_pt)
+{
+ struct Xorriso_restore_writeR *o;
+ int wret, idx;
+
+ o= (struct Xorriso_restore_writeR *) state_pt;
+ while(1) {
+   pthread_mutex_lock(&(o->lock));
+   while(o->filled == 0 && !o->eof)
+     pthread_cond_wait(&(o->cond), &(o->lock));
+   if(o->filled == 0) {
+     pthread_mutex_unlock(&(o->lock));
+ break;
+   }
+   idx= o->head;
+   pthread_mutex_unlock(&(o->lock));
+
+   wret= write(o->fd, o->bufs[idx] + o->starts[idx], o->counts[idx]);
+
+   pthread_mutex_lock(&(o->lock));
+   if(wret > 0)
+     o->written+= wret;
+   if(wret != o->counts[idx]) {
+     o->failed= 1;
+     o->w_errno= errno;
+   }
+   o->head= (o->head + 1) % Xorriso_restore_slotS;
+   o->filled--;
+   pthread_cond_broadcast(&(o->cond));
+   pthread_mutex_unlock(&(o->lock));
+   if(o->failed)
+ break;
+ }
+ return(NULL);
+}
+
+
+static int Xorriso_restore_writer_new(struct Xorriso_restore_writeR **o,
+                                      int fd, int flag)
+{
+ int i, ret;
+ struct Xorriso_restore_writeR *m;
+
+ m= *o= TSOB_FELD(struct Xorriso_restore_writeR, 1);
+ if(m == NULL)
+   return(-1);
+ m->fd= fd;
+ for(i= 0; i < Xorriso_restore_slotS; i++) {
+   m->bufs[i]= NULL;
+   m->starts[i]= m->counts[i]= 0;
+ }
+ m->head= m->tail= m->filled= 0;
+ m->eof= m->failed= m->w_errno= 0;
+ m->handed= m->written= 0;
+ for(i= 0; i < Xorriso_restore_slotS; i++) {
+   m->bufs[i]= calloc(1, Xorriso_restore_chunK);
+   if(m->bufs[i] == NULL)
+     goto failed;
+ }
+ pthread_mutex_init(&(m->lock), NULL);
+ pthread_cond_init(&(m->cond), NULL);
+ ret= pthread_create(&(m->thread), NULL, Xorriso_restore_writer_loop,
+                     (void *) m);
+ if(ret != 0) {
+   pthread_cond_destroy(&(m->cond));
+   pthread_mutex_destroy(&(m->lock));
+   goto failed;
+ }
+ return(1);
+failed:;
+ for(i= 0; i < Xorriso_restore_slotS; i++)
+   if(m->bufs[i] != NULL)
+     free(m->bufs[i]);
+ free((char *) m);
+ *o= NULL;
+ return(0);
+}
+
+
+/* Wait for a free slot.
+   @return 1= *buf is ready to take Xorriso_restore_chunK bytes
+           0= writing failed, the slot shall not be used
+*/
+static int Xorriso_restore_writer_slot(struct Xorriso_restore_writeR *o,
+                                       char **buf, int flag)
+{
+ int ret;
+
+ pthread_mutex_lock(&(o->lock));
+ while(o->filled >= Xorriso_restore_slotS && !o->failed)
+   pthread_cond_wait(&(o->cond), &(o->lock));
+ ret= !o->failed;
+ *buf= o->bufs[o->tail];
+ pthread_mutex_unlock(&(o->lock));
+ return(ret);
+}
+
+
+/* Hand over the slot obtained by Xorriso_restore_writer_slot() */
+static int Xorriso_restore_writer_put(struct Xorriso_restore_writeR *o,
+                                      int start, int count, int flag)
+{
+ pthread_mutex_lock(&(o->lock));
+ o->starts[o->tail]= start;
+ o->counts[o->tail]= count;
+ o->tail= (o->tail + 1) % Xorriso_restore_slotS;
+ o->filled++;
+ o->handed+= count;
+ pthread_cond_broadcast(&(o->cond));
+ pthread_mutex_unlock(&(o->lock));
+ return(1);
+}
+
+
+/* Wait until all handed over chunks are written, dispose the writer and
+   account for bytes which could not be written.
+   @return 1= all bytes written , 0= write failure was reported
+*/
+static int Xorriso_restore_writer_end(struct XorrisO *xorriso,
+                                      struct Xorriso_restore_writeR **o,
+                                      off_t *todo, char *path, int flag)
+{
+ int i, ret= 1;
+ struct Xorriso_restore_writeR *m;
+
+ m= *o;
+ if(m == NULL)
+   return(1);
+ pthread_mutex_lock(&(m->lock));
+ m->eof= 1;
+ pthread_cond_broadcast(&(m->cond));
+ pthread_mutex_unlock(&(m->lock));
+ pthread_join(m->thread, NULL);
+
+ if(m->written < m->handed) {
+   *todo+= m->handed - m->written;
+   xorriso->pacifier_byte_count-= m->handed - m->written;
+   sprintf(xorriso->info_text,
+           "Cannot write all bytes to disk filesystem path ");
+   Text_shellsafe(path,  xorriso->info_text, 1);
+   Xorriso_msgs_submit(xorriso, 0, xorriso->info_text, m->w_errno,
+                       "FAILURE", 0);
+   ret= 0;
+ }
+ pthread_cond_destroy(&(m->cond));
+ pthread_mutex_destroy(&(m->lock));
+ for(i= 0; i < Xorriso_restore_slotS; i++)
+   free(m->bufs[i]);
+ free((char *) m);
+ *o= NULL;
+ return(ret);
+}
+
+/* ------------------------------------------------------------------------ */
+
+
 /* @param flag bit0= Minimal transfer: access permissions only
                bit1= *_offset and bytes are valid for writing to regular file
                bit2= This is not a parameter. Do not report if ignored
@@ -433,9 +631,9 @@ int Xorriso_tree_restore_node(struct XorrisO *xorriso, IsoNode *node,
                               int flag)
 {
  int ret= 0, write_fd= -1, wanted, wret, open_flags, l_errno= 0;
- int target_deleted= 0, buf_size= 32 * 1024;
+ int target_deleted= 0, buf_size= 0;
  char *what= "[unknown filetype]";
- char *buf= NULL, type_text[5], *temp_path= NULL, *buf_pt;
+ char *buf= NULL, type_text[5], *temp_path= NULL, *buf_pt, *read_pt= NULL;
  char *link_target, *open_path_pt= NULL;
  off_t todo= 0, size, seek_ret, last_p_count= 0, already_done, read_count= 0;
  void *data_stream= NULL;
@@ -448,8 +646,8 @@ int Xorriso_tree_restore_node(struct XorrisO *xorriso, IsoNode *node,
  uint32_t lba;
  char *catcontent = NULL;
  off_t catsize;
+ struct Xorriso_restore_writeR *writer= NULL;
 
- Xorriso_alloc_meM(buf, char, buf_size);
  Xorriso_alloc_meM(temp_path, char, SfileadrL);
 
  if(LIBISO_ISDIR(node)) {
@@ -538,6 +736,27 @@ int Xorriso_tree_restore_node(struct XorrisO *xorriso, IsoNode *node,
        goto cannot_restore;
      }
    }
+
+   /* Copy in large chunks. With large files let a thread write the chunks
+      to disk while the next ones get read from the image.
+   */
+   if(!ISO_NODE_IS_BOOTCAT(node)) {
+     if(size + img_offset > 2 * (off_t) Xorriso_restore_chunK) {
+       ret= Xorriso_restore_writer_new(&writer, write_fd, 0);
+       if(ret < 0)
+         goto ex;
+     }
+     if(writer == NULL) {
+       buf_size= Xorriso_restore_chunK;
+       if(size + img_offset < (off_t) buf_size)
+         buf_size= ((size + img_offset + 2047) / 2048) * 2048;
+       if(buf_size <= 0)
+         buf_size= 2048;
+       Xorriso_alloc_meM(buf, char, buf_size);
+     } else {
+       buf_size= Xorriso_restore_chunK;
+     }
+   }
    while(todo>0) {
      wanted= buf_size;
      if(wanted>todo)
@@ -546,10 +765,23 @@ int Xorriso_tree_restore_node(struct XorrisO *xorriso, IsoNode *node,
        ret= todo;
        buf_pt= catcontent;
      } else {
-       ret= Xorriso_iso_file_read(xorriso, data_stream, buf, wanted, 0);
-       buf_pt= buf;
+       read_pt= buf;
+       if(writer != NULL) {
+         ret= Xorriso_restore_writer_slot(writer, &read_pt, 0);
+         if(ret <= 0)
+   break;
+       }
+       ret= Xorriso_iso_file_read(xorriso, data_stream, read_pt, wanted, 0);
+       buf_pt= read_pt;
      }
      if(ret<=0) {
+       if(writer != NULL) {
+         ret= Xorriso_restore_writer_end(xorriso, &writer, &todo,
+                                         open_path_pt, 0);
+         if(ret <= 0)
+   break;
+         ret= -1;
+       }
        if(xorriso->extract_error_mode == 0 &&
           Xorriso_is_plain_image_file(xorriso, node, "", 0)) {
          close(write_fd);
@@ -588,7 +820,12 @@ int Xorriso_tree_restore_node(struct XorrisO *xorriso, IsoNode *node,
        ret= read_count - img_offset;
      }
 
-     wret= write(write_fd, buf_pt, ret);
+     if(writer != NULL) {
+       Xorriso_restore_writer_put(writer, (int) (buf_pt - read_pt), ret, 0);
+       wret= ret;
+     } else {
+       wret= write(write_fd, buf_pt, ret);
+     }
      if(wret>=0) {
        todo-= wret;
        xorriso->pacifier_byte_count+= wret;
@@ -608,6 +845,7 @@ int Xorriso_tree_restore_node(struct XorrisO *xorriso, IsoNode *node,
    break;
      }
    }  
+   Xorriso_restore_writer_end(xorriso, &writer, &todo, open_path_pt, 0);
    if(write_fd > 0)
      close(write_fd);
    write_fd= -1;
@@ -719,6 +957,7 @@ restore_properties:;
  if(todo < 0)
    ret= 0;
 ex:;
+ Xorriso_restore_writer_end(xorriso, &writer, &todo, open_path_pt, 0);
  if(write_fd >= 0) {
    close(write_fd);
    if(ret <= 0 && xorriso->extract_error_mode == 2 && open_path_pt != NULL)
@@ -1408,6 +1647,25 @@ ex:
 }
 
 
+/* Allow or end read-ahead of image data from the input drive.
+   @param flag bit0= allow read-ahead, else end it
+   @return <=0 = no input drive or no read-ahead possible , 1 = done
+*/
+int Xorriso_set_read_ahead(struct XorrisO *xorriso, int flag)
+{
+ int ret;
+ struct burn_drive_info *dinfo;
+ struct burn_drive *drive;
+
+ ret= Xorriso_get_drive_handles(xorriso, &dinfo, &drive, "", 16);
+ if(ret <= 0)
+   return(ret);
+ ret= isoburn_set_read_ahead(drive, flag & 1);
+ Xorriso_process_msg_queues(xorriso,0);
+ return(ret);
+}
+
+
 /*
    @param flag
            >>> bit0= mkdir: graft in as empty directory, not as copy from iso
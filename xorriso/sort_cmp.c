@@ -155,14 +155,14 @@ int Xorriso__get_di(IsoNode *node, dev_t *dev, ino_t *ino, int flag)
  Xorriso_get_di_counteR++;
 #endif /* NIX */
 
- msg= TSOB_FELD(char, ISO_MSGS_MESSAGE_LEN);
- if(msg == NULL)
-   {ret= -1; goto ex;}
  *dev= 0;
  *ino= 0;
  ret= iso_node_lookup_attr(node, name, &value_length, &value, 0);
  if(ret <= 0) {
    /* Drop any pending messages because there is no xorriso to take them */
+   msg= TSOB_FELD(char, ISO_MSGS_MESSAGE_LEN);
+   if(msg == NULL)
+     {ret= -1; goto ex;}
    iso_obtain_msgs("NEVER", &error_code, &imgid, msg, severity);
    goto ex;
  }
@@ -228,15 +228,128 @@ int Xorriso__di_cmp(const void *p1, const void *p2)
 } 
 
 
-int Xorriso__sort_di(void *node_array[], int count, int flag)
+/* Same order as Xorriso__di_cmp() but on keys which were obtained once
+   by Xorriso__get_di().
+   @param flag bit0= compare only dev and ino, like Xorriso__di_ino_cmp()
+*/
+static int Xorriso__di_key_cmp(struct Xorriso_di_keY *k1,
+                               struct Xorriso_di_keY *k2, int flag)
+{
+ if(k1->dev != k2->dev)
+   return(k1->dev < k2->dev ? -1 : 1);
+ if(k1->ino != k2->ino)
+   return(k1->ino < k2->ino ? -1 : 1);
+ if(k1->node != k2->node &&
+    (!(flag & 1) || (k1->dev == 0 && k1->ino == 0)))
+   return(k1->node < k2->node ? -1 : 1);
+ return(0);
+}
+
+
+static int Xorriso__di_key_qsort_cmp(const void *p1, const void *p2)
 {
+ return(Xorriso__di_key_cmp((struct Xorriso_di_keY *) p1,
+                            (struct Xorriso_di_keY *) p2, 0));
+}
+
+
+/* Sort node_array by isofs.di and record the dev,ino of each node in *keys.
+   Reading the attribute only once per node spares the most time of sorting.
+   @param keys  Will return an array of count keys parallel to node_array.
+                Submit NULL if not desired.
+*/
+int Xorriso__sort_di(void *node_array[], int count,
+                     struct Xorriso_di_keY **keys, int flag)
+{
+ int i, ret;
+ struct Xorriso_di_keY *k;
+
+ if(keys != NULL)
+   *keys= NULL;
  if(count <= 0)
    return(0);
- qsort(node_array, count, sizeof(IsoNode *), Xorriso__di_cmp);
+ k= calloc(count, sizeof(struct Xorriso_di_keY));
+ if(k == NULL) {
+   qsort(node_array, count, sizeof(IsoNode *), Xorriso__di_cmp);
+   return(1);
+ }
+ for(i= 0; i < count; i++) {
+   k[i].node= node_array[i];
+   ret= Xorriso__get_di((IsoNode *) node_array[i], &(k[i].dev), &(k[i].ino),
+                        0);
+   if(ret <= 0)
+     k[i].dev= k[i].ino= 0;
+ }
+ qsort(k, count, sizeof(struct Xorriso_di_keY), Xorriso__di_key_qsort_cmp);
+ for(i= 0; i < count; i++)
+   node_array[i]= k[i].node;
+ if(keys != NULL)
+   *keys= k;
+ else
+   free(k);
+ return(1);
+}
+
+
+/* Find the lowest index in di_keys which is not smaller than the key of node.
+   @param flag bit0= compare only dev and ino
+   @return 0= no di_keys available, 1= *idx is valid (may be di_count)
+*/
+static int Xorriso__di_key_lower_bound(struct XorrisO *xorriso,
+                                       struct Xorriso_di_keY *key,
+                                       int *idx, int flag)
+{
+ int l, r, m;
+
+ if(xorriso->di_keys == NULL)
+   return(0);
+ l= 0;
+ r= xorriso->di_count;
+ while(l < r) {
+   m= l + (r - l) / 2;
+   if(Xorriso__di_key_cmp(xorriso->di_keys + m, key, flag & 1) < 0)
+     l= m + 1;
+   else
+     r= m;
+ }
+ *idx= l;
  return(1);
 }
 
 
+/* Search node in di_array.
+   @return <0 error, 0 not found, 1 found, *idx is valid
+*/
+int Xorriso_search_in_di_array(struct XorrisO *xorriso, IsoNode *node,
+                               int *idx, int flag)
+{
+ int ret, i;
+ struct Xorriso_di_keY key;
+
+ if(xorriso->di_array == NULL || xorriso->di_count <= 0)
+   return(0);
+ if(xorriso->di_keys == NULL)
+   return(Xorriso__search_node(xorriso->di_array, xorriso->di_count,
+                               Xorriso__di_cmp, node, idx, 0));
+ key.node= node;
+ ret= Xorriso__get_di(node, &(key.dev), &(key.ino), 0);
+ if(ret < 0)
+   return(ret);
+ if(ret == 0)
+   key.dev= key.ino= 0;
+ Xorriso__di_key_lower_bound(xorriso, &key, &i, 0);
+ for(; i < xorriso->di_count; i++) {
+   if(Xorriso__di_key_cmp(xorriso->di_keys + i, &key, 0) != 0)
+ break;
+   if(xorriso->di_array[i] != NULL) {
+     *idx= i;
+     return(1);
+   }
+ }
+ return(0);
+}
+
+
 int Xorriso_invalidate_di_item(struct XorrisO *xorriso, IsoNode *node,
                                int flag)
 {
@@ -244,8 +357,7 @@ int Xorriso_invalidate_di_item(struct XorrisO *xorriso, IsoNode *node,
 
  if(xorriso->di_array == NULL)
    return(1);
- ret= Xorriso__search_node(xorriso->di_array, xorriso->di_count,
-                           Xorriso__di_cmp, node, &idx, 0);
+ ret= Xorriso_search_in_di_array(xorriso, node, &idx, 0);
  if(ret <= 0)
    return(ret == 0);
  if(xorriso->di_array[idx] != NULL)
@@ -264,11 +376,36 @@ int Xorriso_search_di_range(struct XorrisO *xorriso, IsoNode *node,
 {
  int ret, i, found;
  int (*cmp)(const void *p1, const void *p2)= Xorriso__di_ino_cmp;
+ struct Xorriso_di_keY key;
 
  if(flag & 2)
    cmp= Xorriso__di_cmp;
 
  *high= *low= *idx= -1;                            
+ if(xorriso->di_keys != NULL) {
+   key.node= node;
+   ret= Xorriso__get_di(node, &(key.dev), &(key.ino), 0);
+   if(ret < 0)
+     return(0);
+   if(ret == 0)
+     key.dev= key.ino= 0;
+   Xorriso__di_key_lower_bound(xorriso, &key, &i, !(flag & 2));
+   for(; i < xorriso->di_count; i++) {
+     if(Xorriso__di_key_cmp(xorriso->di_keys + i, &key, !(flag & 2)) != 0)
+   break;
+     if(xorriso->di_array[i] == NULL)
+   continue;
+     if(*low < 0)
+       *low= i;
+     *high= i;
+     if(xorriso->di_array[i] == node && *idx < 0)
+       *idx= i;
+   }
+   if(*low < 0)
+     return(0);
+   return(*idx >= 0 || (flag & 1));
+ }
+
  ret= Xorriso__search_node(xorriso->di_array, xorriso->di_count,
                            cmp, node, &found, 0);
  if(ret <= 0)
@@ -381,6 +518,9 @@ int Xorriso_remake_hln_array(struct XorrisO *xorriso, int flag)
  IsoNode **old_nodes;
  char **old_targets;
 
+ /* The tree traversal will find all noted nodes anyway */
+ Xorriso_destroy_hln_noted(xorriso, 0);
+
  /* Count hln_targets of which the node has been deleted meanwhile */
  for(i= 0; i < xorriso->hln_count; i++) {
    if(xorriso->hln_targets[i] == NULL)
@@ -389,7 +529,7 @@ int Xorriso_remake_hln_array(struct XorrisO *xorriso, int flag)
  continue;
    addon_nodes++;
  }
- ret= Xorriso_all_node_array(xorriso, addon_nodes, 0);
+ ret= Xorriso_all_node_array(xorriso, 0);
  if(ret <= 0)
    goto ex;
  if(addon_nodes > 0) {
@@ -399,10 +539,13 @@ int Xorriso_remake_hln_array(struct XorrisO *xorriso, int flag)
    continue;
      if(Xorriso_node_is_valid(xorriso, xorriso->hln_array[i], 0))
    continue;
-     if(xorriso->node_counter < xorriso->node_array_size) {
-       xorriso->node_array[xorriso->node_counter++]= xorriso->hln_array[i];
-       iso_node_ref(xorriso->node_array[xorriso->node_counter - 1]);
+     if(xorriso->node_counter >= xorriso->node_array_size) {
+       ret= Xorriso_grow_node_array(xorriso, 0);
+       if(ret <= 0)
+         goto ex;
      }
+     xorriso->node_array[xorriso->node_counter++]= xorriso->hln_array[i];
+     iso_node_ref(xorriso->node_array[xorriso->node_counter - 1]);
    }
  }
 
@@ -461,6 +604,207 @@ ex:;
 }
 
 
+static int Xorriso__pointer_cmp(const void *p1, const void *p2)
+{
+ void *n1, *n2;
+
+ n1= *((void **) p1);
+ n2= *((void **) p2);
+ if(n1 == n2)
+   return(0);
+ return(n1 < n2 ? -1 : 1);
+}
+
+
+struct Xorriso_hln_iteM {
+ void *node;
+ char *target;
+};
+
+
+static int Xorriso__hln_item_cmp(const void *p1, const void *p2)
+{
+ return(Xorriso__findi_sorted_ino_cmp(
+                                   &(((struct Xorriso_hln_iteM *) p1)->node),
+                                   &(((struct Xorriso_hln_iteM *) p2)->node)));
+}
+
+
+/* Register a node which was added to the ISO tree, or which may have got a
+   different sort key by changes of its attributes or its content.
+   The next Xorriso_make_hln_array() will merge it into the existing
+   hln_array rather than traversing and sorting the whole tree.
+   @param flag bit0= if node is a directory: register its subtree too
+*/
+int Xorriso_hln_note_node(struct XorrisO *xorriso, void *in_node, int flag)
+{
+ int ret, new_size;
+ void **new_noted;
+ IsoDirIter *iter= NULL;
+ IsoNode *node, *child;
+
+ node= (IsoNode *) in_node;
+ if(xorriso->hln_array == NULL || xorriso->hln_change_pending == 1)
+   return(1);
+ if(xorriso->hln_noted_count >= xorriso->hln_noted_size) {
+   new_size= 2 * xorriso->hln_noted_size;
+   if(new_size < 256)
+     new_size= 256;
+   new_noted= realloc(xorriso->hln_noted, new_size * sizeof(void *));
+   if(new_noted == NULL) {
+     /* Give up incremental maintenance. Remake at next occasion. */
+     Xorriso_destroy_hln_noted(xorriso, 0);
+     xorriso->hln_change_pending= 1;
+     return(1);
+   }
+   xorriso->hln_noted= new_noted;
+   xorriso->hln_noted_size= new_size;
+ }
+ xorriso->hln_noted[xorriso->hln_noted_count++]= node;
+ iso_node_ref(node);
+ xorriso->hln_change_pending= 2;
+
+ if((flag & 1) && LIBISO_ISDIR(node)) {
+   ret= iso_dir_get_children((IsoDir *) node, &iter);
+   if(ret < 0) {
+     xorriso->hln_change_pending= 1;
+     return(1);
+   }
+   while(iso_dir_iter_next(iter, &child) == 1) {
+     Xorriso_hln_note_node(xorriso, child, 1);
+     if(xorriso->hln_change_pending == 1)
+   break;
+   }
+   iso_dir_iter_free(iter);
+ }
+ return(1);
+}
+
+
+/* Bring hln_array up to date by merging the nodes which were registered by
+   Xorriso_hln_note_node(). Nodes which are not in the tree any more get
+   dropped unless they have a hardlink target path.
+   This costs a linear pass over hln_array plus sorting of the registered
+   nodes, whereas Xorriso_remake_hln_array() traverses and sorts the tree.
+*/
+int Xorriso_merge_hln_array(struct XorrisO *xorriso, int flag)
+{
+ int i, j, k, n_noted, kept, new_count;
+ void **noted, *node, **found, **new_array= NULL, **new_targets= NULL;
+ char *target;
+ struct Xorriso_hln_iteM *items= NULL;
+
+ noted= xorriso->hln_noted;
+ n_noted= xorriso->hln_noted_count;
+
+ /* Unique list of registered nodes, sorted by address */
+ if(n_noted > 0) {
+   qsort(noted, n_noted, sizeof(void *), Xorriso__pointer_cmp);
+   for(i= j= 0; i < n_noted; i++) {
+     if(j > 0 && noted[j - 1] == noted[i]) {
+       iso_node_unref((IsoNode *) noted[i]);
+   continue;
+     }
+     noted[j++]= noted[i];
+   }
+   n_noted= xorriso->hln_noted_count= j;
+ }
+
+ /* Allocate everything before any change is made */
+ new_count= xorriso->hln_count + n_noted;
+ if(n_noted > 0)
+   items= calloc(n_noted, sizeof(struct Xorriso_hln_iteM));
+ if(new_count > 0) {
+   new_array= calloc(new_count, sizeof(void *));
+   new_targets= calloc(new_count, sizeof(void *));
+ }
+ if((n_noted > 0 && items == NULL) ||
+    (new_count > 0 && (new_array == NULL || new_targets == NULL))) {
+   if(items != NULL)
+     free(items);
+   if(new_array != NULL)
+     free(new_array);
+   if(new_targets != NULL)
+     free(new_targets);
+   return(Xorriso_remake_hln_array(xorriso, 0));
+ }
+ for(i= 0; i < n_noted; i++) {
+   items[i].node= noted[i];
+   items[i].target= NULL;
+ }
+
+ /* Take registered nodes out of the old array, drop invalid nodes */
+ kept= 0;
+ for(i= 0; i < xorriso->hln_count; i++) {
+   node= xorriso->hln_array[i];
+   target= NULL;
+   if(xorriso->hln_targets != NULL)
+     target= xorriso->hln_targets[i];
+   if(n_noted > 0) {
+     found= bsearch(&node, noted, n_noted, sizeof(void *),
+                    Xorriso__pointer_cmp);
+     if(found != NULL) {
+       /* Keep the reference of the noted instance */
+       items[found - noted].target= target;
+       iso_node_unref((IsoNode *) node);
+   continue;
+     }
+   }
+   if(target == NULL && !Xorriso_node_is_valid(xorriso, node, 0)) {
+     iso_node_unref((IsoNode *) node);
+   continue;
+   }
+   xorriso->hln_array[kept]= node;
+   if(xorriso->hln_targets != NULL)
+     xorriso->hln_targets[kept]= target;
+   kept++;
+ }
+ for(i= j= 0; i < n_noted; i++) {
+   if(items[i].target == NULL &&
+      !Xorriso_node_is_valid(xorriso, items[i].node, 0)) {
+     iso_node_unref((IsoNode *) items[i].node);
+ continue;
+   }
+   items[j++]= items[i];
+ }
+ n_noted= j;
+ if(n_noted > 1)
+   qsort(items, n_noted, sizeof(struct Xorriso_hln_iteM),
+         Xorriso__hln_item_cmp);
+
+ /* Merge both sorted sequences */
+ i= j= k= 0;
+ while(i < kept || j < n_noted) {
+   if(j >= n_noted ||
+      (i < kept && Xorriso__findi_sorted_ino_cmp(&(xorriso->hln_array[i]),
+                                                 &(items[j].node)) <= 0)) {
+     new_array[k]= xorriso->hln_array[i];
+     if(xorriso->hln_targets != NULL)
+       new_targets[k]= xorriso->hln_targets[i];
+     i++;
+   } else {
+     new_array[k]= items[j].node;
+     new_targets[k]= items[j].target;
+     j++;
+   }
+   k++;
+ }
+
+ if(xorriso->hln_array != NULL)
+   free(xorriso->hln_array);
+ if(xorriso->hln_targets != NULL)
+   free(xorriso->hln_targets);
+ xorriso->hln_array= new_array;
+ xorriso->hln_targets= new_targets;
+ xorriso->hln_count= k;
+ xorriso->hln_noted_count= 0;
+ if(items != NULL)
+   free(items);
+ xorriso->hln_change_pending= 0;
+ return(1);
+}
+
+
 /* @param flag bit0= overwrite existing hln_array (else return 2)
 */
 int Xorriso_make_hln_array(struct XorrisO *xorriso, int flag)
@@ -471,12 +815,15 @@ int Xorriso_make_hln_array(struct XorrisO *xorriso, int flag)
    /* If no fresh image manipulations occured: keep old array */
    if(!xorriso->hln_change_pending)
      return(2);
+   /* If all changes were registered: merge them into the old array */
+   if(xorriso->hln_change_pending == 2)
+     return(Xorriso_merge_hln_array(xorriso, 0));
    ret= Xorriso_remake_hln_array(xorriso, 0);
    return(ret);
  }
  Xorriso_destroy_hln_array(xorriso, 0);
 
- ret= Xorriso_all_node_array(xorriso, 0, 0);
+ ret= Xorriso_all_node_array(xorriso, 0);
  if(ret <= 0)
    goto ex;
  Xorriso_sort_node_array(xorriso, 0);
@@ -521,10 +868,10 @@ int Xorriso_make_di_array(struct XorrisO *xorriso, int flag)
    return(2);
  Xorriso_finish_hl_update(xorriso, 0);
 
- ret= Xorriso_all_node_array(xorriso, 0, 0);
+ ret= Xorriso_all_node_array(xorriso, 0);
  if(ret <= 0)
    goto ex;
- bytes= xorriso->node_array_size / 8 + 1;
+ bytes= xorriso->node_counter / 8 + 1;
  xorriso->di_do_widen= calloc(bytes, 1);
  if(xorriso->di_do_widen == NULL) {
    Xorriso_no_malloc_memory(xorriso, NULL, 0);
@@ -538,7 +885,8 @@ int Xorriso_make_di_array(struct XorrisO *xorriso, int flag)
  xorriso->node_array_size= 0;
  xorriso->node_array= NULL;
 
- Xorriso__sort_di((void *) xorriso->di_array, xorriso->di_count, 0);
+ Xorriso__sort_di((void *) xorriso->di_array, xorriso->di_count,
+                  &(xorriso->di_keys), 0);
 
  ret= 1;
 ex:;
@@ -594,8 +942,7 @@ int Xorriso_hardlink_update(struct XorrisO *xorriso, int *compare_result,
    do_overwrite= 1;
 
  Xorriso__get_di(node, &old_dev, &old_ino, 0);
- ret= Xorriso__search_node(xorriso->di_array, xorriso->di_count,
-                           Xorriso__di_cmp, node, &idx, 0);
+ ret= Xorriso_search_in_di_array(xorriso, node, &idx, 0);
  if(ret < 0)
    {ret= 0; goto ex;}
  if(ret > 0)
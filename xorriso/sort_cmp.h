@@ -33,7 +33,18 @@ int Xorriso__di_ino_cmp(const void *p1, const void *p2);
 
 int Xorriso__di_cmp(const void *p1, const void *p2);
 
-int Xorriso__sort_di(void *node_array[], int count, int flag);
+/* Sort key of di_array, fetched once per node by Xorriso__sort_di() */
+struct Xorriso_di_keY {
+ dev_t dev;
+ ino_t ino;
+ IsoNode *node;
+};
+
+int Xorriso__sort_di(void *node_array[], int count,
+                     struct Xorriso_di_keY **keys, int flag);
+
+int Xorriso_search_in_di_array(struct XorrisO *xorriso, IsoNode *node,
+                               int *idx, int flag);
 
 int Xorriso_invalidate_di_item(struct XorrisO *xorriso, IsoNode *node,
                                int flag);
@@ -52,6 +63,8 @@ int Xorriso_sorted_node_array(struct XorrisO *xorriso,
 
 int Xorriso_remake_hln_array(struct XorrisO *xorriso, int flag);
 
+int Xorriso_merge_hln_array(struct XorrisO *xorriso, int flag);
+
 int Xorriso_make_di_array(struct XorrisO *xorriso, int flag);
 
 int Xorriso_search_hardlinks(struct XorrisO *xorriso, IsoNode *node,
@@ -2619,6 +2619,11 @@ int Xorriso_status(struct XorrisO *xorriso, char *filter, FILE *fp, int flag)
  if(!(is_default && no_defaults))
    Xorriso_status_result(xorriso,filter,fp,flag&2);
 
+ is_default= (xorriso->lazy_dirs == 0);
+ sprintf(line, "-lazy_dirs %s\n", xorriso->lazy_dirs ? "on" : "off");
+ if(!(is_default && no_defaults))
+   Xorriso_status_result(xorriso,filter,fp,flag&2);
+
  is_default= (xorriso->allow_restore==0 && xorriso->do_concat_split==1 &&
               xorriso->do_auto_chmod==0 && xorriso->drives_exclusive == 1);
  mode_pt= "off"; 
@@ -2951,6 +2956,16 @@ int Xorriso_status(struct XorrisO *xorriso, char *filter, FILE *fp, int flag)
  Xorriso_status_extf(xorriso, filter, fp, flag & 2);
  Xorriso_status_zisofs(xorriso, filter, fp, flag & 3);
 
+ is_default= (xorriso->filter_cache_mem == 0 &&
+              xorriso->filter_cache_disk == 0);
+ if(is_default)
+   sprintf(line,"-filter_cache off\n");
+ else
+   sprintf(line,"-filter_cache %.f:%.f\n",
+           xorriso->filter_cache_mem, xorriso->filter_cache_disk);
+ if(!(is_default && no_defaults))
+   Xorriso_status_result(xorriso,filter,fp,flag&2);
+
  is_default= !xorriso->allow_graft_points;
  sprintf(line,"-pathspecs %s\n", xorriso->allow_graft_points ? "on" : "off");
  if(!(is_default && no_defaults))
@@ -2976,6 +2991,14 @@ int Xorriso_status(struct XorrisO *xorriso, char *filter, FILE *fp, int flag)
  if(!(is_default && no_defaults))
    Xorriso_status_result(xorriso,filter,fp,flag&2);
 
+ is_default= (xorriso->disk_scan_threads == 0);
+ if(xorriso->disk_scan_threads == 0)
+   sprintf(line,"-disk_scan_threads off\n");
+ else
+   sprintf(line,"-disk_scan_threads %d\n", xorriso->disk_scan_threads);
+ if(!(is_default && no_defaults))
+   Xorriso_status_result(xorriso,filter,fp,flag&2);
+
  is_default= (xorriso->do_overwrite==2);
  sprintf(line,"-overwrite %s\n",(xorriso->do_overwrite == 1 ? "on" :
                              (xorriso->do_overwrite == 2 ? "nondir" : "off")));
@@ -3056,6 +3079,20 @@ int Xorriso_status(struct XorrisO *xorriso, char *filter, FILE *fp, int flag)
  if(!(is_default && no_defaults))
    Xorriso_status_result(xorriso,filter,fp,flag&2);
 
+ is_default= (xorriso->file_readers == 0);
+ if(xorriso->file_readers == 0)
+   sprintf(line,"-file_readers off\n");
+ else
+   sprintf(line,"-file_readers %d:%d\n",
+           xorriso->file_readers, xorriso->file_prefetch);
+ if(!(is_default && no_defaults))
+   Xorriso_status_result(xorriso,filter,fp,flag&2);
+
+ is_default= (xorriso->dedup_content == 0);
+ sprintf(line,"-dedup_content %s\n", xorriso->dedup_content ? "on" : "off");
+ if(!(is_default && no_defaults))
+   Xorriso_status_result(xorriso,filter,fp,flag&2);
+
  is_default= (xorriso->padding==300*1024);
  sprintf(line,"-padding %dk\n", xorriso->padding/1024);
  if(!(is_default && no_defaults))
@@ -3240,10 +3277,12 @@ int Xorriso_status(struct XorrisO *xorriso, char *filter, FILE *fp, int flag)
  if(!(is_default && no_defaults))
    Xorriso_status_result(xorriso,filter,fp,flag&2);
 
- is_default= ((xorriso->do_md5 & 31) == 0);
+ is_default= ((xorriso->do_md5 & (31 | 64)) == 0);
  sprintf(line, "-md5 ");
  if(xorriso->do_md5 & 1) {
-   if((xorriso->do_md5 & 8) == 8) {
+   if(xorriso->do_md5 & 64) {
+     strcat(line, "stat_check");
+   } else if((xorriso->do_md5 & 8) == 8) {
      strcat(line, "all");
    } else {
      strcat(line, "on");
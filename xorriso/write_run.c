@@ -875,6 +875,7 @@ int Xorriso_write_session(struct XorrisO *xorriso, int flag)
       ((!!(xorriso->do_md5 & 2)) * isoburn_igopt_session_md5) |
       ((!!(xorriso->do_md5 & 4)) * isoburn_igopt_file_md5) |
       ((!!(xorriso->do_md5 & 8)) * isoburn_igopt_file_stability) |
+      ((!!(xorriso->do_md5 & 64)) * isoburn_igopt_file_stat_stability) |
       ((!!xorriso->do_old_empty) * isoburn_igopt_old_empty) |
       ((flag & 1) * isoburn_igopt_will_cancel);
  if(xorriso->no_emul_toc & 1)
@@ -897,6 +898,9 @@ int Xorriso_write_session(struct XorrisO *xorriso, int flag)
                              (gid_t) xorriso->global_gid);
  isoburn_igopt_set_out_charset(sopts, out_cs);
  isoburn_igopt_set_fifo_size(sopts, xorriso->fs * 2048);
+ isoburn_igopt_set_file_readers(sopts, xorriso->file_readers,
+                                xorriso->file_prefetch);
+ isoburn_igopt_set_dedup_content(sopts, xorriso->dedup_content);
  Ftimetxt(time(NULL), xorriso->scdbackup_tag_time, 8);
  isoburn_igopt_set_scdbackup_tag(sopts, xorriso->scdbackup_tag_name,
                                  xorriso->scdbackup_tag_time,
@@ -1408,6 +1408,10 @@ int Xorriso_option_dev(struct XorrisO *xorriso, char *adr, int flag);
 int Xorriso_option_data_cache_size(struct XorrisO *xorriso, char *num_tiles,
                                    char *tile_blocks, int flag);
 
+/* Command -dedup_content */
+/* @since 1.3.2 */
+int Xorriso_option_dedup_content(struct XorrisO *xorriso, char *mode, int flag);
+
 /* Command -devices */
 /* @param flag bit0= perform -device_links rather than -devices
    @return <=0 error , 1 success, 2 revoked by -reassure
@@ -1423,6 +1427,11 @@ int Xorriso_option_disk_dev_ino(struct XorrisO *xorriso, char *mode, int flag);
 /* Command -disk_pattern "on"|"ls"|"off" */
 int Xorriso_option_disk_pattern(struct XorrisO *xorriso, char *mode, int flag);
 
+/* Command -disk_scan_threads "off"|number */
+/* @since 1.3.2 */
+int Xorriso_option_disk_scan_threads(struct XorrisO *xorriso, char *mode,
+                                     int flag);
+
 /* Command -displacement [-]offset */
 /* @since 0.6.6 */
 int Xorriso_option_displacement(struct XorrisO *xorriso, char *value,
@@ -1478,11 +1487,18 @@ int Xorriso_option_extract(struct XorrisO *xorriso, char *disk_path,
 int Xorriso_option_extract_cut(struct XorrisO *xorriso, char *iso_rr_path,
                           char *start, char *count, char *disk_path, int flag);
 
+/* Command -file_readers */
+int Xorriso_option_file_readers(struct XorrisO *xorriso, char *mode, int flag);
+
 /* Command -file_size_limit */
 int Xorriso_option_file_size_limit(struct XorrisO *xorriso,
                                    int argc, char **argv, int *idx, int flag);
 
 
+/* Command -filter_cache */
+int Xorriso_option_filter_cache(struct XorrisO *xorriso, char *mode,
+                                int flag);
+
 /* Command -find alias -findi, and -findx */
 /* @param flag bit0= -findx rather than -findi
                bit1= do not reset pacifier, no final pacifier message
@@ -1538,6 +1554,10 @@ int Xorriso_option_jigdo(struct XorrisO *xorriso, char *aspect, char *arg,
 /* Command -joliet "on"|"off" */
 int Xorriso_option_joliet(struct XorrisO *xorriso, char *mode, int flag);
 
+/* Command -lazy_dirs "on"|"off" */
+/* @since 1.3.2 */
+int Xorriso_option_lazy_dirs(struct XorrisO *xorriso, char *mode, int flag);
+
 /* Command -launch_frontend */
 /* @since 1.2.6 */
 int Xorriso_option_launch_frontend(struct XorrisO *xorriso,
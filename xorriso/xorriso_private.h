@@ -165,6 +165,8 @@ struct XorrisO { /* the global context of xorriso */
                  bit3= make file content stability check by double reading
                  bit4= use recorded MD5 as proxy of ISO file
                  bit5= with bit0: do not check tags of superblock,tree,session
+                 bit6= make file content stability check by comparing
+                       file attributes before and after copying
                */
 
  int no_emul_toc; /* bit0= On overwriteables: 
@@ -191,6 +193,8 @@ struct XorrisO { /* the global context of xorriso */
  int do_follow_links;
  int follow_link_limit;
  int do_follow_mount;
+ int disk_scan_threads; /* threads which scan disk trees ahead : 0 to 64 */
+ struct Xorriso_scan_aheaD *scan_ahead; /* the currently running scan */
  int do_global_uid;
  uid_t global_uid;
  int do_global_gid;
@@ -211,6 +215,10 @@ struct XorrisO { /* the global context of xorriso */
  int zisofs_block_size;
  int zisofs_block_size_default;
  int zisofs_by_magic;
+ int zisofs_threads;  /* compression threads per data file : 1 to 64 */
+
+ double filter_cache_mem;  /* Budget for keeping filter output of the size */
+ double filter_cache_disk; /* determination run. 0 = no keeping */
 
  int do_overwrite; /* 0=off, 1=on, 2=nondir */
  int do_reassure;  /* 0=off, 1=on, 2=tree */
@@ -290,6 +298,8 @@ struct XorrisO { /* the global context of xorriso */
  int cache_tile_blocks;
  int cache_default;       /* bit0= cache_num_tiles, bit1= cache_tile_blocks */
 
+ int lazy_dirs;           /* -lazy_dirs: read ISO directories on first use */
+
  int do_calm_drive;      /* bit0= calm down drive after aquiring it */
 
  char indev[SfileadrL];
@@ -338,6 +348,10 @@ struct XorrisO { /* the global context of xorriso */
  int do_close;
  int speed;     /* in libburn units : 1000 bytes/second , 0 = Max, -1 = Min */
  int fs;        /* fifo size in 2048 byte chunks : at most 1 GB */
+ int file_readers;  /* threads for read-ahead of data files : 0 to 64 */
+ int file_prefetch; /* files in read-ahead : 0 to 1024 */
+ int dedup_content; /* 1= let data files with identical content share extents
+                    */
  int padding;   /* number of bytes to add after ISO 9660 image */
  int do_padding_by_libisofs; /* 0= by libburn , 1= by libisofs */
 
@@ -481,7 +495,7 @@ struct XorrisO { /* the global context of xorriso */
                                    3= jigdo_path , 4= md5_path , 5= min_size
                                    6= checksum_iso , 7= checksum_template
                                    8= compression , 9= exclude , 10= demand_md5
-                                  11= mapping
+                                  11= mapping , 12= md5_cache_path
                           */
 
  /* LBA of boot image after image loading */
@@ -700,7 +714,13 @@ struct XorrisO { /* the global context of xorriso */
  int hln_count;
  void **hln_array;
  void **hln_targets;
- int hln_change_pending; /* whether a change was made since hln creation */
+ int hln_change_pending; /* whether a change was made since hln creation:
+                            0= no change, 1= unknown changes,
+                            2= all changes are registered in hln_noted */
+ /* Nodes which were added or changed since hln creation */
+ int hln_noted_count;
+ int hln_noted_size;
+ void **hln_noted;
 
  /* >>> this should count all temp_mem and thus change its name */
  off_t node_targets_availmem;
@@ -711,6 +731,7 @@ struct XorrisO { /* the global context of xorriso */
     List of involved disk-iso path pairs. */
  int di_count;
  void **di_array;
+ struct Xorriso_di_keY *di_keys; /* dev,ino of di_array, same order */
  char *di_do_widen;
  struct Xorriso_lsT *di_disk_paths;
  struct Xorriso_lsT *di_iso_paths;
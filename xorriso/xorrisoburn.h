@@ -292,6 +292,10 @@ int Xorriso_restore(struct XorrisO *xorriso,
                     char *img_path, char *disk_path,
                     off_t offset, off_t cut_size, int flag);
 
+/* @param flag bit0= allow read-ahead, else end it
+*/
+int Xorriso_set_read_ahead(struct XorrisO *xorriso, int flag);
+
 
 /* @param flag bit0= in_node is valid, do not resolve img_path
 */
@@ -329,10 +333,14 @@ int Xorriso_set_local_charset(struct XorrisO *xorriso, char *name, int flag);
 
 int Xorriso_destroy_node_array(struct XorrisO *xorriso, int flag);
 
+int Xorriso_destroy_hln_noted(struct XorrisO *xorriso, int flag);
+
 int Xorriso_destroy_hln_array(struct XorrisO *xorriso, int flag);
 
 int Xorriso_destroy_di_array(struct XorrisO *xorriso, int flag);
 
+int Xorriso_grow_node_array(struct XorrisO *xorriso, int flag);
+
 int Xorriso_new_node_array(struct XorrisO *xorriso, off_t mem_limit,
                            int addon_nodes, int flag);
 
@@ -467,6 +475,8 @@ int Xorriso_show_stream(struct XorrisO *xorriso, void *in_node,
 
 int Xorriso_set_zisofs_params(struct XorrisO *xorriso, int flag);
 
+int Xorriso_set_filter_cache(struct XorrisO *xorriso, int flag);
+
 int Xorriso_status_zisofs(struct XorrisO *xorriso, char *filter, FILE *fp,
                           int flag);
 
@@ -514,9 +524,18 @@ int Xorriso_is_plain_image_file(struct XorrisO *xorriso, void *in_node,
 
 int Xorriso_pvd_info(struct XorrisO *xorriso, int flag);
 
-/* @param flag bit0= do not set hln_change_pending */
+/* @param flag bit0= do not set hln_change_pending
+               bit1= all changed or added nodes were registered by
+                     Xorriso_hln_note_node(), so that hln_array can be
+                     updated incrementally
+*/
 int Xorriso_set_change_pending(struct XorrisO *xorriso, int flag);
 
+/* @param node  Opaque handle to IsoNode which was added or changed
+   @param flag  bit0= if node is a directory: register its subtree too
+*/
+int Xorriso_hln_note_node(struct XorrisO *xorriso, void *in_node, int flag);
+
 /* @param flag bit0= enable SCSI command logging to stderr */
 int Xorriso_scsi_log(struct XorrisO *xorriso, int flag);
 